@@ -0,0 +1,179 @@
+#ifndef AUDIO_MIXER_H
+#define AUDIO_MIXER_H
+
+#include "raylib.h"
+#include "SpscRing.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+class MusicStream;
+
+// Software mixer running on the audio callback thread.
+// A fixed pool of voices plays either recorded samples (e.g. key clicks)
+// or synthesized Mini Micro-style waveforms with an ADSR envelope.  The main
+// thread controls voices only by posting commands through a lock-free
+// queue; the callback never allocates or locks.  Render() can also be
+// called directly to mix offline into a buffer.
+class AudioMixer {
+public:
+    static const int kSampleRate = 44100;
+    static const int kChannels = 2;         // output is interleaved stereo float
+    static const int kMaxVoices = 64;
+    static const int kMaxSamples = 64;
+    static const int kBlockFrames = 256;    // mixing granularity
+    static const int kMaxStreams = 4;
+
+    enum Waveform {
+        kSine,
+        kSquare,
+        kTriangle,
+        kSawtooth,
+        kNoise
+    };
+
+    // Envelope times in seconds; sustain is a level (0-1)
+    struct Envelope {
+        float attack;
+        float decay;
+        float sustain;
+        float release;
+
+        Envelope() : attack(0.005f), decay(0.0f), sustain(1.0f), release(0.05f) {}
+        Envelope(float a, float d, float s, float r) : attack(a), decay(d), sustain(s), release(r) {}
+    };
+
+    // Identifies one playing sound, for later Stop/Set calls
+    typedef uint32_t VoiceHandle;
+
+    AudioMixer();
+    ~AudioMixer();
+
+    // Open an audio stream on the (already initialized) audio device and
+    // start mixing into it.  Only one mixer can own the device at a time.
+    bool Start();
+    void Stop();
+
+    // Load a sample (any format Raylib reads) given its resource path.
+    // Call on the main thread, before playing it; returns -1 on failure.
+    int LoadSample(const char* relativePath);
+
+    // Play a loaded sample; speed 1 is normal pitch
+    VoiceHandle PlaySample(int sample, float volume = 1.0f, float pan = 0.0f, float speed = 1.0f);
+
+    // Play a synthesized tone for the given duration (not counting release)
+    VoiceHandle PlayTone(Waveform waveform, float frequency, float duration,
+                         float volume = 1.0f, float pan = 0.0f, Envelope envelope = Envelope());
+
+    // Adjust or stop a playing voice (no effect if it has already finished)
+    void SetVolume(VoiceHandle voice, float volume);
+    void SetPan(VoiceHandle voice, float pan);
+    void SetFrequency(VoiceHandle voice, float frequency);
+    void StopVoice(VoiceHandle voice);      // goes into envelope release
+    void StopAll();
+
+    void SetMasterVolume(float volume);
+
+    // Mix a streaming music track in with the voices.  DetachStream waits
+    // until the audio thread has let go of it, so the stream may then be
+    // closed or destroyed.
+    void AttachStream(MusicStream* stream);
+    void DetachStream(MusicStream* stream);
+
+    // Mix the next `frames` frames of interleaved stereo into out.
+    // Called from the audio callback; may also be used for offline rendering.
+    void Render(float* out, int frames);
+
+    int GetActiveVoiceCount() const { return activeVoices.load(std::memory_order_relaxed); }
+
+private:
+    enum CommandType {
+        kCmdPlaySample,
+        kCmdPlayTone,
+        kCmdSetVolume,
+        kCmdSetPan,
+        kCmdSetFrequency,
+        kCmdStop,
+        kCmdStopAll,
+        kCmdMasterVolume,
+        kCmdAttachStream,
+        kCmdDetachStream
+    };
+
+    struct Command {
+        CommandType type;
+        VoiceHandle handle;
+        int sample;
+        Waveform waveform;
+        float value;        // volume, pan, frequency or speed, by type
+        float volume;
+        float pan;
+        float duration;
+        Envelope envelope;
+        MusicStream* stream;
+    };
+
+    struct Sample {
+        float* frames;      // interleaved stereo
+        int frameCount;
+    };
+
+    enum EnvelopeStage { kAttack, kDecay, kSustain, kRelease, kDone };
+
+    struct Voice {
+        VoiceHandle handle;     // 0 when free
+        bool isTone;
+        float volume;
+        float pan;
+        float gainL, gainR;     // from volume and pan
+
+        // Sample playback
+        const Sample* sample;
+        double position;        // in frames
+        float speed;
+
+        // Synthesis
+        Waveform waveform;
+        float phase;            // 0-1
+        float phaseStep;        // frequency / sample rate
+        uint32_t noiseState;
+        float noiseValue;
+        float timeLeft;         // before release starts
+        Envelope envelope;
+        EnvelopeStage stage;
+        float level;            // current envelope level
+        float releaseStep;      // level decrease per frame, once releasing
+    };
+
+    static void AudioCallback(void* buffer, unsigned int frames);
+
+    bool Post(const Command& command);
+    void ApplyCommands();
+    void StartVoice(const Command& command);
+    Voice* FindVoice(VoiceHandle handle);
+    static void UpdateGains(Voice& voice);
+    static float StepEnvelope(Voice& voice);
+    int RenderSampleVoice(Voice& voice, float* stereo, int frames);
+    void RenderToneVoice(Voice& voice, float* mono, int frames);
+
+    SpscRing<Command, 256> commands;
+    uint32_t postedCount;                   // main thread only
+    std::atomic<uint32_t> appliedCount;     // commands the audio thread has applied
+    Sample samples[kMaxSamples];
+    int sampleCount;
+    Voice voices[kMaxVoices];
+    MusicStream* streams[kMaxStreams];
+    VoiceHandle nextHandle;
+    float masterVolume;
+    std::atomic<int> activeVoices;
+
+    // Scratch buffers for one block (preallocated; used only by Render)
+    float monoBlock[kBlockFrames];
+    float stereoBlock[kBlockFrames * kChannels];
+
+    AudioStream stream;
+    bool started;
+    static AudioMixer* activeMixer;
+};
+
+#endif // AUDIO_MIXER_H
@@ -0,0 +1,12 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+// Timing runs for the engine's hot paths, selected with `--bench <name>`
+// ("all" runs every one, "list" names them).  They run headless, after the
+// window and audio device are up, and print their results to stdout.
+//
+// Returns the process exit code: nonzero if the name is unknown or a
+// benchmark's own check of its results failed.
+int RunBenchmark(const char* name);
+
+#endif // BENCHMARKS_H
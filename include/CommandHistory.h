@@ -0,0 +1,66 @@
+#ifndef COMMAND_HISTORY_H
+#define COMMAND_HISTORY_H
+
+#include "LineReader.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Console command history, kept across sessions in an append-only log
+// file: one command per line, oldest first.  Opening maps the log (see
+// LineReader), so earlier sessions' commands are only read when recalled;
+// new commands are appended as they are added.  When the history has
+// grown well past the entry limit, on opening or while adding, the log is
+// rewritten with just the newest entries.
+//
+// Search finds the newest entry containing a string.  It uses an index
+// from each three-character sequence (trigram) to the entries containing
+// it, built on the first search, so only entries containing all of the
+// query's trigrams are ever compared.
+class CommandHistory {
+public:
+    static const size_t kDefaultMaxEntries = 100000;
+
+    CommandHistory();
+    ~CommandHistory();
+
+    // Load the log at path (if it exists) and append new entries to it
+    bool Open(const char* path);
+    void Close();
+
+    void SetMaxEntries(size_t count) { maxEntries = count > 0 ? count : 1; }
+
+    size_t GetCount() const { return loggedCount + added.size(); }
+    std::string Get(size_t index);
+    void Add(const std::string& entry);
+
+    // Index of the newest entry at or before `from` containing text, or -1
+    int Search(const std::string& text, int from);
+
+private:
+    CommandHistory(const CommandHistory&) = delete;
+    CommandHistory& operator=(const CommandHistory&) = delete;
+
+    bool View(size_t index, const char** outText, size_t* outLength);
+    bool Contains(size_t index, const std::string& text);
+    bool Compact();
+    void Trim();
+    void BuildIndex();
+    void IndexEntry(uint32_t index);
+
+    std::string path;
+    LineReader log;
+    size_t loggedCount;                 // entries read from the log
+    std::vector<std::string> added;     // entries added since opening
+    FILE* appendFile;
+    size_t maxEntries;
+
+    // Trigram (3 bytes packed) -> entries containing it, ascending
+    std::unordered_map<uint32_t, std::vector<uint32_t>> trigrams;
+    bool indexBuilt;
+};
+
+#endif // COMMAND_HISTORY_H
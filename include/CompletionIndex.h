@@ -0,0 +1,52 @@
+#ifndef COMPLETION_INDEX_H
+#define COMPLETION_INDEX_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Identifiers known to autocomplete (globals, intrinsics, file names...),
+// kept in a sorted array so that all words with a given prefix form one
+// contiguous range, found by binary search.  Words are added and removed
+// one at a time as symbols are defined, or in bulk.
+//
+// Typing usually extends the previous query by a character, and the new
+// range always lies within the old one, so a query that extends the last
+// one searches only the last one's range.
+class CompletionIndex {
+public:
+    CompletionIndex();
+
+    void Add(const std::string& word);
+    void AddAll(const std::vector<std::string>& newWords);
+    void Remove(const std::string& word);
+    void Clear();
+
+    size_t GetCount() const { return words.size(); }
+    const std::string& GetWord(size_t index) const { return words[index]; }
+    bool Contains(const std::string& word) const;
+
+    // The range of words [begin, end) starting with prefix
+    void FindRange(const std::string& prefix, size_t* outBegin, size_t* outEnd);
+
+    // What to append to prefix to complete it to the alphabetically first
+    // longer word, or "" if there is none
+    std::string Complete(const std::string& prefix);
+
+    // The identifier at the end of some input: the part to complete
+    static std::string LastToken(const std::string& text);
+
+    int GetNarrowedQueryCount() const { return narrowedQueries; }
+
+private:
+    std::vector<std::string> words;
+
+    // The previous query, valid until the words change
+    std::string lastPrefix;
+    size_t lastBegin;
+    size_t lastEnd;
+    bool lastValid;
+    int narrowedQueries;
+};
+
+#endif // COMPLETION_INDEX_H
@@ -2,11 +2,17 @@
 #define CONSOLE_H
 
 #include "TextDisplay.h"
+#include "CommandHistory.h"
+#include "InputEvent.h"
+#include "SpscRing.h"
 #include <string>
 #include <vector>
-#include <queue>
-#include <map>
 #include <functional>
+#include <atomic>
+#include <mutex>
+
+class CompletionIndex;
+class ThreadPool;
 
 // Console manages text input/output and command history
 class Console {
@@ -24,11 +30,17 @@ public:
     static const int kControlE = 5;
     static const int kControlK = 11;
     static const int kControlU = 21;
+    static const int kHistorySearch = 30;     // Ctrl-R (18 is taken by kRightArrow)
+
+    static const size_t kKeyBufferSize = 256;
+    static const int kMaxFrameEvents = 64;
+    static const int kKeyTableSize = 512;     // covers every raylib KeyboardKey
 
     // Callback types
     typedef std::function<void(const std::string&)> InputCallback;
     typedef std::function<std::string(const std::string&)> AutocompleteCallback;
     typedef std::function<bool()> ControlCCallback;
+    typedef std::function<void(char)> KeyCallback;
 
     Console(TextDisplay* display);
     ~Console();
@@ -36,9 +48,22 @@ public:
     // Initialize keyboard mapping (call once at startup)
     void InitKeyboardMapping();
 
-    // Update - call every frame
+    // Update - call every frame.  Polls the keyboard (the only place that
+    // should) and passes the keys to the input line or the key buffer.
     void Update(float deltaTime);
 
+    // This frame's key presses, each physical key once (for key clicks etc.)
+    const InputEvent* GetFrameEvents(int& outCount) const { outCount = frameEventCount; return frameEvents; }
+
+    // Call when a frame has been shown, to time key presses until the
+    // frame showing their effect.  Events are stamped when polled, at the
+    // start of a frame, so time spent waiting for that poll isn't counted.
+    void NoteFramePresented(double time);
+    double GetLastEchoLatencyMs() const { return lastEchoMs; }
+    double GetAverageEchoLatencyMs() const { return echoSamples ? totalEchoMs / echoSamples : 0; }
+    double GetMaxEchoLatencyMs() const { return maxEchoMs; }
+    int GetEchoSampleCount() const { return echoSamples; }
+
     // Input mode control
     void StartInput();
     void CommitInput();
@@ -48,18 +73,32 @@ public:
     // Handle a key press
     void HandleKey(char keyChar);
 
-    // Get buffered keys (for when not in input mode)
-    bool HasBufferedKey() const { return !keyBuffer.empty(); }
-    char GetBufferedKey();
+    // Keys pressed when not in input mode, with their characters (any
+    // Unicode), modifiers, and times.  Lock-free, so one other thread (the
+    // script's) may be the one taking them.  When full, new keys are dropped.
+    bool HasBufferedKey() const { return !keyBuffer.IsEmpty(); }
+    bool GetBufferedKey(InputEvent& outEvent) { return keyBuffer.Pop(outEvent); }
+    int GetDroppedKeyCount() const { return droppedKeys; }
 
     // History management
     void AddToHistory(const std::string& input);
+    bool OpenHistory(const char* path) { return history.Open(path); }   // load and keep saving to path
 
     // Callbacks
     void SetOnInputDone(InputCallback callback) { onInputDone = callback; }
     void SetOnInputChanged(InputCallback callback) { onInputChanged = callback; }
     void SetAutocompleteCallback(AutocompleteCallback callback) { autocompleteCallback = callback; }
     void SetControlCHandler(ControlCCallback callback) { controlCHandler = callback; }
+    void SetOnKey(KeyCallback callback) { onKey = callback; }   // every key reaching HandleKey
+
+    // Suggestions come from the index first (completing the last word of
+    // the input), then from the callback.  The index is not owned.
+    void SetCompletionIndex(CompletionIndex* index) { completionIndex = index; }
+
+    // Call the autocomplete callback on a worker thread, showing its answer
+    // in a later Update, so a slow callback never delays typing.  It must
+    // then be safe to call off the main thread.
+    void SetAutocompleteAsync(bool async);
 
     // Notify console that display scrolled
     void NoteScrolled();
@@ -70,6 +109,10 @@ public:
     // Type input programmatically
     void TypeInput(const std::string& text);
 
+    // Same, for keys pressed at time (as GetTime), e.g. replayed from a
+    // log; they count toward the key-to-glyph latency like polled keys
+    void TypeInput(const std::string& text, double time);
+
 private:
     struct RowCol {
         int row;
@@ -78,17 +121,34 @@ private:
         RowCol(int r, int c) : row(r), col(c) {}
     };
 
+    void PollEvents();
+    int SpecialKeyCode(int key, uint32_t modifiers) const;
+    void HandleKeyEvent(char keyChar, const InputEvent& event);
     void ReplaceInput(const std::string& newInput);
     void SetCursorForInput(bool showSuggestion = true);
+    void ShowSuggestion();
+    void RequestSuggestion();
+    void ShowReadySuggestion();
     void ClearAutocomplete();
     int PrevInputStop(int index, bool byWord);
     int NextInputStop(int index, bool byWord);
     bool IsTokenChar(char c) const;
 
+    // Incremental reverse history search (Ctrl-R)
+    void StartHistorySearch();
+    bool HandleSearchKey(int keyInt);
+    void SearchHistory(int from);
+    void ShowHistorySearch();
+    void EndHistorySearch(bool acceptMatch);
+
     TextDisplay* display;
 
-    // Keyboard mapping (virtual char -> physical KeyboardKey)
-    std::map<char, int> charToKeyCode;
+    // Keyboard layout: the (lowercase) character on each physical key, or 0
+    unsigned char keyChars[kKeyTableSize];
+
+    // Keys polled this frame
+    InputEvent frameEvents[kMaxFrameEvents];
+    int frameEventCount;
 
     // Input state
     bool inInputMode;
@@ -98,17 +158,41 @@ private:
     std::string curSuggestion;
 
     // History
-    std::vector<std::string> history;
+    CommandHistory history;
     int historyIndex;
 
+    // History search state
+    bool searching;
+    std::string searchQuery;
+    int searchMatch;                // -1 until something matches
+    bool searchFailed;
+    std::string searchSavedInput;   // input before searching, restored by Escape
+
+    // Autocomplete sources
+    CompletionIndex* completionIndex;
+    ThreadPool* suggestionPool;                     // async mode only
+    std::atomic<unsigned int> suggestionRequest;    // bumped when the input or cursor changes
+    std::mutex suggestionMutex;
+    unsigned int readyRequest;                      // request answered by readySuggestion, or 0
+    std::string readySuggestion;
+
     // Key buffer
-    std::queue<char> keyBuffer;
+    SpscRing<InputEvent, kKeyBufferSize> keyBuffer;
+    int droppedKeys;
+
+    // Key-to-glyph latency
+    double echoPendingSince;        // time of the oldest key not yet shown, or -1
+    double lastEchoMs;
+    double maxEchoMs;
+    double totalEchoMs;
+    int echoSamples;
 
     // Callbacks
     InputCallback onInputDone;
     InputCallback onInputChanged;
     AutocompleteCallback autocompleteCallback;
     ControlCCallback controlCHandler;
+    KeyCallback onKey;
 };
 
 #endif // CONSOLE_H
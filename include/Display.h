@@ -3,9 +3,19 @@
 
 #include "raylib.h"
 
+class RenderQueue;
+
 // Base class for all display layers
 class Display {
 public:
+    // Where the machine screen lies in the window (and in the presenter's
+    // canvas), in pixels, y down
+    static const int kScreenLeft = 32;
+    static const int kScreenTop = 32;
+    static const int kScreenWidth = 960;
+    static const int kScreenHeight = 640;
+    static const int kScreenBottom = kScreenTop + kScreenHeight;
+
     Display();
     virtual ~Display();
 
@@ -15,15 +25,48 @@ public:
     // Render this display layer
     virtual void Render() = 0;
 
+    // Record this layer's draws into the frame's queue instead of drawing
+    // them now, so they can batch with the other layers.  Returns false if
+    // the layer draws immediately, in which case Machine calls Render().
+    virtual bool Record(RenderQueue& queue) { return false; }
+
     // Clear/reset the display to its default state
     virtual void Clear() = 0;
 
+    // True if this layer covers the whole screen with opaque pixels, so the
+    // layers beneath it need not be drawn
+    virtual bool IsOpaque() const { return false; }
+
     // Get/set visibility
     bool IsVisible() const { return visible; }
     void SetVisible(bool visible) { this->visible = visible; }
 
+    // Layer transform: content is scaled about the screen's bottom-left
+    // corner, then shifted left and down by the scroll (in screen pixels).
+    // Machine::Render applies it as the modelview matrix, so the GPU moves
+    // the vertices and displays never re-lay themselves out to scroll.
+    float GetScale() const { return scale; }
+    void SetScale(float scale) { this->scale = scale > 0 ? scale : 1.0f; }
+    float GetScrollX() const { return scrollX; }
+    float GetScrollY() const { return scrollY; }
+    void SetScroll(float x, float y) { scrollX = x; scrollY = y; }
+    bool HasTransform() const { return scale != 1.0f || scrollX != 0 || scrollY != 0; }
+
+    // The given modelview matrix with this layer's transform applied first
+    Matrix ApplyTransform(const Matrix& modelview) const;
+
+    // Part of this layer's own (untransformed, bottom-up) coordinates that
+    // lands on screen; displays use it to cull
+    Rectangle GetVisibleArea() const;
+
 protected:
+    // Render() for layers that implement Record(): records into a scratch
+    // queue and flushes it right away
+    void RenderRecorded();
+
     bool visible;
+    float scale;
+    float scrollX, scrollY;
 };
 
 #endif // DISPLAY_H
@@ -0,0 +1,116 @@
+#ifndef FRAME_CAPTURE_H
+#define FRAME_CAPTURE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Screenshots and video recording without stalling the frame.  Pixels are
+// read back through a ring of pixel buffer objects: a frame's glReadPixels
+// only queues a copy on the GPU, and the buffer is mapped a few frames
+// later, once its fence says the copy is done.  Encoding (PNG screenshots,
+// QOI-frame .qov video as played by VideoDisplay) runs on a worker thread.
+//
+// Nothing here waits for the GPU or the encoder.  A frame is dropped if its
+// readback slot is still busy or too many frames wait for the encoder; a
+// video repeats its previous frame in its place, so timing is kept.  The
+// time CaptureFrame takes is measured, to check capture stays cheap.
+class FrameCapture {
+public:
+    static const int kReadbackSlots = 3;    // frames of latency
+    static const int kMaxQueuedFrames = 4;  // waiting for the encoder
+
+    FrameCapture();
+    ~FrameCapture();
+
+    // Area of the framebuffer to capture, in GL (bottom-up) pixels
+    void SetRegion(int x, int y, int width, int height);
+
+    // Save the next captured frame as a PNG
+    void RequestScreenshot(const char* path);
+
+    // Record every frame into a .qov video until stopped
+    bool StartRecording(const char* path, int fps);
+    void StopRecording();
+    bool IsRecording() const { return videoState == kRecording; }
+
+    // Call once per frame, after drawing into the framebuffer (a GL
+    // framebuffer id, e.g. a render texture's)
+    void CaptureFrame(unsigned int framebuffer);
+
+    // Finish all queued work and free the GL objects; call while the
+    // graphics context still exists
+    void Unload();
+
+    int GetCapturedFrameCount() const { return capturedFrames; }
+    int GetDroppedFrameCount() const { return droppedFrames; }
+
+    // CaptureFrame's cost on the main thread
+    double GetLastOverheadMs() const { return lastOverheadMs; }
+    double GetMaxOverheadMs() const { return maxOverheadMs; }
+    double GetAverageOverheadMs() const { return overheadFrames ? totalOverheadMs / overheadFrames : 0; }
+
+private:
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    enum VideoState { kIdle, kRecording, kStopping };
+
+    struct Slot {
+        unsigned int buffer;        // pixel pack buffer
+        void* fence;                // GLsync, null when the slot is free
+        bool forVideo;
+        std::string screenshotPath;
+    };
+
+    struct Job {
+        std::vector<unsigned char> pixels;  // bottom-up, as read back
+        int width, height;
+        std::string screenshotPath;
+        FILE* video;                        // video to append to and/or finish
+        int videoFrames;                    // times to append the pixels
+        bool finishVideo;
+    };
+
+    bool EnsureBuffers();
+    bool TryCollect(Slot& slot);
+    void Submit(Job& job);
+    void EncoderLoop();
+
+    int x, y, width, height;
+    Slot slots[kReadbackSlots];
+    bool buffersLoaded;
+    int nextSlot;
+    std::string pendingScreenshot;
+
+    VideoState videoState;
+    FILE* videoFile;
+    int droppedVideoFrames;             // to repeat at the next captured frame
+    int capturedFrames;
+    int droppedFrames;
+
+    double lastOverheadMs;
+    double maxOverheadMs;
+    double totalOverheadMs;
+    int overheadFrames;
+
+    // Encoder thread; buffers cycle between freeBuffers and jobs
+    std::thread encoder;
+    std::mutex mutex;
+    std::condition_variable jobAvailable;
+    std::deque<Job> jobs;
+    std::vector<std::vector<unsigned char>> freeBuffers;
+    bool quitting;
+
+    // Encoder thread scratch
+    int videoFrameCount;
+    std::vector<unsigned char> flipped;
+    std::vector<unsigned char> encoded;
+};
+
+#endif // FRAME_CAPTURE_H
@@ -0,0 +1,54 @@
+#ifndef GRADIENT_DISPLAY_H
+#define GRADIENT_DISPLAY_H
+
+#include "Display.h"
+
+// Display that fills the screen with colors interpolated between two
+// points.  The stops are shader uniforms and the gradient is evaluated per
+// fragment in one full-screen pass, so changing them every frame costs only
+// a uniform update.
+//
+// Points are in screen pixels, bottom-up; stop positions run from 0 at the
+// start point to 1 at the end point.
+class GradientDisplay : public Display {
+public:
+    static const int kMaxStops = 16;
+
+    GradientDisplay();
+    virtual ~GradientDisplay();
+
+    void Render() override;
+    void Clear() override;      // default points and colors
+    bool IsOpaque() const override;
+
+    // Gradient axis (default: center-top to center-bottom)
+    void SetPoints(Vector2 start, Vector2 end) { startPoint = start; endPoint = end; }
+    Vector2 GetStartPoint() const { return startPoint; }
+    Vector2 GetEndPoint() const { return endPoint; }
+
+    // Color stops; positions may be null to space the colors evenly
+    void SetStops(const Color* colors, const float* positions, int count);
+    int GetStopCount() const { return stopCount; }
+    Color GetStopColor(int index) const;
+
+    // Load the shader (call once, before rendering any GradientDisplay)
+    static bool LoadShader(const char* vertexPath, const char* fragmentPath);
+    static void UnloadShader();
+
+private:
+    Vector2 startPoint, endPoint;
+    int stopCount;
+    Color colors[kMaxStops];
+    float positions[kMaxStops];
+
+    // Shared shader for all GradientDisplay instances
+    static Shader shader;
+    static int startPointLoc;
+    static int endPointLoc;
+    static int stopCountLoc;
+    static int stopColorsLoc;
+    static int stopPositionsLoc;
+    static bool shaderLoaded;
+};
+
+#endif // GRADIENT_DISPLAY_H
@@ -0,0 +1,30 @@
+#ifndef IMAGE_CACHE_H
+#define IMAGE_CACHE_H
+
+#include "raylib.h"
+
+// Persistent cache of decoded images, so PNGs need not be decoded on every
+// launch.  Entries are QOI-compressed RGBA files in the user's cache folder,
+// one per resource path.  An entry is used when the source file's size and
+// modification time still match; if those changed, the source is hashed,
+// and the entry is used only if the content hash matches too.  Anything
+// else decodes the source and rewrites the entry.  Safe to call from
+// worker threads.
+class ImageCache {
+public:
+    // Get the decoded (RGBA8) image for a resource path; caller unloads it
+    static Image Load(const char* relativePath);
+
+    // Delete the cache entry for a resource path, if there is one
+    static void Remove(const char* relativePath);
+
+    static void SetEnabled(bool enabled);
+    static bool IsEnabled();
+
+    // Statistics since launch
+    static int GetHitCount();
+    static int GetMissCount();
+    static double GetSecondsSaved();  // decode time avoided, minus cache load time
+};
+
+#endif // IMAGE_CACHE_H
@@ -0,0 +1,23 @@
+#ifndef INPUT_EVENT_H
+#define INPUT_EVENT_H
+
+#include <cstdint>
+
+// One key press, as polled at the start of a frame.  Plain data, so it can
+// be passed between threads through an SpscRing.
+struct InputEvent {
+    enum Modifier {
+        kShift = 1,
+        kControl = 2,
+        kAlt = 4,
+        kSuper = 8
+    };
+
+    int32_t codepoint;      // Unicode character typed, or a Console key code for
+                            // special keys (8 backspace, 19 up...); 0 if neither
+    int32_t key;            // physical raylib KeyboardKey, or 0 if not known
+    uint32_t modifiers;     // Modifier bits held at the time
+    double time;            // GetTime() when polled
+};
+
+#endif // INPUT_EVENT_H
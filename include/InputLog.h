@@ -0,0 +1,69 @@
+#ifndef INPUT_LOG_H
+#define INPUT_LOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Compact binary log of a session's input, for replaying the same workload
+// (and checking the frames it renders) later.  The log is a sequence of
+// frames; each holds the frame's delta time and the input events that
+// arrived during it: keys as they reached Console::HandleKey, plus mouse
+// and gamepad changes.
+//
+// File layout: "MMIL", a version byte, then events.  Each event is a type
+// byte followed by its values as LEB128 varints (signed ones zigzagged);
+// a kFrame event starts each frame, so frame numbers are implicit.
+class InputLog {
+public:
+    enum EventType {
+        kFrame = 0,             // a: delta time in microseconds
+        kKey = 1,               // a: key code (0-255)
+        kMouseMove = 2,         // a, b: position in canvas pixels
+        kMouseButton = 3,       // a: button, b: 1 pressed / 0 released
+        kGamepadButton = 4,     // a: button, b: 1 pressed / 0 released
+        kGamepadAxis = 5        // a: axis, b: position * 32767
+    };
+
+    struct Event {
+        int type;
+        int a, b;
+    };
+
+    InputLog();
+
+    // Recording: BeginFrame once per frame before any of its events
+    void StartRecording();
+    bool IsRecording() const { return recording; }
+    void BeginFrame(float deltaTime);
+    void RecordKey(char key);
+    void RecordEvent(int type, int a, int b);
+
+    // Poll Raylib's mouse and first gamepad, recording what changed
+    void CaptureDevices();
+
+    bool Save(const char* path) const;
+
+    // Replay: read the next frame's delta time and events; false at the end
+    bool Load(const char* path);
+    bool ReadFrame(float& outDeltaTime, std::vector<Event>& outEvents);
+
+    int GetFrameCount() const { return frameCount; }
+
+private:
+    void WriteVarint(uint32_t value);
+    void WriteSigned(int value) { WriteVarint(((uint32_t)value << 1) ^ (uint32_t)(value >> 31)); }
+    bool ReadVarint(uint32_t& out);
+    bool ReadSigned(int& out);
+
+    std::vector<unsigned char> data;
+    size_t readPos;
+    bool recording;
+    int frameCount;
+
+    // Device state as last recorded
+    int mouseX, mouseY;
+    float axes[6];
+};
+
+#endif // INPUT_LOG_H
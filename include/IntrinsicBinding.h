@@ -0,0 +1,143 @@
+#ifndef INTRINSIC_BINDING_H
+#define INTRINSIC_BINDING_H
+
+#include "raylib.h"
+#include "MiniscriptTypes.h"
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Compile-time generated bindings from plain C++ functions to MiniScript
+// intrinsics.  Each intrinsic is declared as one row of a constexpr table:
+//
+//     static constexpr const char* kSetCursorParams[] = { "row", "column" };
+//     static constexpr IntrinsicDef kTable[] = {
+//         BindIntrinsic<&TextSetCursor>("text.setCursor", kSetCursorParams),
+//     };
+//
+// The argument count is checked against the function signature at compile
+// time, and the generated thunk unpacks positional arguments with a
+// type-specialized ArgTraits conversion.  Calling an intrinsic is one
+// indirect call; there are no lookups by name and no temporary strings.
+
+typedef MiniScript::Value ScriptValue;
+
+// Conversion between MiniScript values and C++ argument/return types
+template<typename T> struct ArgTraits;
+
+template<> struct ArgTraits<double> {
+    static double From(const ScriptValue& v) { return v.DoubleValue(); }
+    static ScriptValue To(double d) { return ScriptValue(d); }
+};
+
+template<> struct ArgTraits<float> {
+    static float From(const ScriptValue& v) { return (float)v.DoubleValue(); }
+    static ScriptValue To(float f) { return ScriptValue((double)f); }
+};
+
+template<> struct ArgTraits<int> {
+    static int From(const ScriptValue& v) { return (int)v.DoubleValue(); }
+    static ScriptValue To(int i) { return ScriptValue((double)i); }
+};
+
+template<> struct ArgTraits<bool> {
+    static bool From(const ScriptValue& v) { return v.BoolValue(); }
+    static ScriptValue To(bool b) { return ScriptValue(b ? 1.0 : 0.0); }
+};
+
+template<> struct ArgTraits<MiniScript::String> {
+    static MiniScript::String From(const ScriptValue& v) { return v.ToString(); }
+    static ScriptValue To(const MiniScript::String& s) { return ScriptValue(s); }
+};
+
+template<> struct ArgTraits<ScriptValue> {
+    static const ScriptValue& From(const ScriptValue& v) { return v; }
+    static ScriptValue To(const ScriptValue& v) { return v; }
+};
+
+// Colors are "#RRGGBB" or "#RRGGBBAA" strings, as in Mini Micro
+Color ColorFromScript(const char* s);
+MiniScript::String ColorToScript(Color c);
+
+template<> struct ArgTraits<Color> {
+    static Color From(const ScriptValue& v) { return ColorFromScript(v.ToString().c_str()); }
+    static ScriptValue To(Color c) { return ScriptValue(ColorToScript(c)); }
+};
+
+// Results of bulk queries become MiniScript lists
+template<> struct ArgTraits<std::vector<int>> {
+    static ScriptValue To(const std::vector<int>& items) {
+        MiniScript::ValueList list;
+        for (int item : items) list.Add(ScriptValue((double)item));
+        return ScriptValue(list);
+    }
+};
+
+template<> struct ArgTraits<std::vector<std::pair<int, int>>> {
+    static ScriptValue To(const std::vector<std::pair<int, int>>& pairs) {
+        MiniScript::ValueList list;
+        for (const std::pair<int, int>& p : pairs) {
+            MiniScript::ValueList pair;
+            pair.Add(ScriptValue((double)p.first));
+            pair.Add(ScriptValue((double)p.second));
+            list.Add(ScriptValue(pair));
+        }
+        return ScriptValue(list);
+    }
+};
+
+// Positional-argument thunk: args[0..paramCount-1], already filled in with
+// defaults by the VM glue
+typedef ScriptValue (*IntrinsicThunk)(const ScriptValue* args);
+
+// One row of an intrinsic table
+struct IntrinsicDef {
+    const char* name;               // dotted name, e.g. "text.row"
+    const char* const* paramNames;  // static storage, paramCount entries
+    int paramCount;
+    IntrinsicThunk invoke;
+};
+
+template<auto Fn> struct IntrinsicThunkFor;
+
+template<typename R, typename... Args, R (*Fn)(Args...)>
+struct IntrinsicThunkFor<Fn> {
+    static constexpr int kArgCount = (int)sizeof...(Args);
+
+    static ScriptValue Invoke(const ScriptValue* args) {
+        return Call(args, std::index_sequence_for<Args...>());
+    }
+
+private:
+    template<size_t... I>
+    static ScriptValue Call(const ScriptValue* args, std::index_sequence<I...>) {
+        (void)args;     // unused when there are no parameters
+        if constexpr (std::is_void<R>::value) {
+            Fn(ArgTraits<typename std::decay<Args>::type>::From(args[I])...);
+            return ScriptValue();
+        } else {
+            return ArgTraits<typename std::decay<R>::type>::To(
+                Fn(ArgTraits<typename std::decay<Args>::type>::From(args[I])...));
+        }
+    }
+};
+
+// Build a table row for a function taking parameters
+template<auto Fn, size_t N>
+constexpr IntrinsicDef BindIntrinsic(const char* name, const char* const (&paramNames)[N]) {
+    static_assert((int)N == IntrinsicThunkFor<Fn>::kArgCount,
+                  "parameter name count must match the function signature");
+    return IntrinsicDef{ name, paramNames, (int)N, &IntrinsicThunkFor<Fn>::Invoke };
+}
+
+// Build a table row for a function with no parameters
+template<auto Fn>
+constexpr IntrinsicDef BindIntrinsic(const char* name) {
+    static_assert(IntrinsicThunkFor<Fn>::kArgCount == 0,
+                  "function takes parameters; supply their names");
+    return IntrinsicDef{ name, nullptr, 0, &IntrinsicThunkFor<Fn>::Invoke };
+}
+
+#endif // INTRINSIC_BINDING_H
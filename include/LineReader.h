@@ -0,0 +1,79 @@
+#ifndef LINE_READER_H
+#define LINE_READER_H
+
+#include "MappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Random access to the lines of a (possibly huge) text file, without
+// splitting it into strings up front.  Opening maps the file and scans it
+// once for newlines (64 bytes per step with SSE2, 16 with NEON) into an
+// index of line start offsets; a line is then just a pointer and length into the
+// mapping, read on demand.  Files larger than the map budget (which is
+// small on 32-bit builds) are scanned and read through a chunk buffer
+// instead, so they cost no address space.
+//
+// Lines end at '\n'; a '\r' before it is dropped, and a final newline does
+// not start an extra empty line (as with Mini Micro's file.readLines).
+class LineReader {
+public:
+    static const size_t kChunkSize = 1 << 20;
+
+    LineReader();
+    ~LineReader();
+
+    bool Open(const char* path);
+
+    // Index lines of data already in memory (e.g. a file on a MiniDisk);
+    // the data is not copied and must outlive the reader
+    bool OpenMemory(const unsigned char* data, size_t size);
+
+    void Close();
+    bool IsOpen() const { return isOpen; }
+    bool IsStreaming() const { return stream != nullptr; }
+
+    size_t GetLineCount() const { return lineStarts.size(); }
+    uint64_t GetSize() const { return size; }
+
+    // Line i, without its terminator.  The text stays valid until Close,
+    // or for a streamed file, until the next line is read.
+    bool GetLine(size_t line, const char** outText, size_t* outLength);
+    bool GetLine(size_t line, std::string& out);
+
+    // Sequential reading from the first line
+    void Rewind() { nextLine = 0; }
+    bool NextLine(const char** outText, size_t* outLength) { return GetLine(nextLine++, outText, outLength); }
+
+    // Files larger than this many bytes are streamed rather than mapped
+    static void SetMapBudget(uint64_t bytes) { mapBudget = bytes; }
+    static uint64_t GetMapBudget() { return mapBudget; }
+
+private:
+    LineReader(const LineReader&) = delete;
+    LineReader& operator=(const LineReader&) = delete;
+
+    void IndexLines(const unsigned char* bytes, size_t count, uint64_t offset);
+    void IndexData();
+    bool IndexStream();
+    bool LoadChunk(uint64_t start, size_t minLength);
+
+    static uint64_t mapBudget;
+
+    MappedFile file;
+    const unsigned char* data;      // whole file, when not streaming
+    uint64_t size;
+    bool isOpen;
+    std::vector<uint64_t> lineStarts;
+    size_t nextLine;
+
+    // Streaming: a window of the file
+    FILE* stream;
+    std::vector<unsigned char> chunk;
+    uint64_t chunkStart;
+    size_t chunkLength;
+};
+
+#endif // LINE_READER_H
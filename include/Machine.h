@@ -3,6 +3,9 @@
 
 #include <vector>
 #include "Display.h"
+#include "RenderQueue.h"
+
+class SoftwareRenderer;
 
 // The Machine manages the 8 display layers and input
 class Machine {
@@ -13,7 +16,7 @@ public:
     ~Machine();
 
     // Update the machine state (input, etc.)
-    void Update();
+    void Update(float deltaTime);
 
     // Render all visible displays in order
     void Render();
@@ -24,8 +27,19 @@ public:
     // Set a display layer (Machine takes ownership)
     void SetDisplay(int index, Display* display);
 
+    // Rasterize layers on the CPU instead of with GL draw calls, for
+    // machines without a usable GPU (see SoftwareRenderer)
+    void SetSoftwareRendering(bool enabled);
+    bool IsSoftwareRendering() const { return softwareRenderer != nullptr; }
+
+    // Draws recorded by the layers in the last frame, with its batch and
+    // state change counters
+    const RenderQueue& GetRenderQueue() const { return renderQueue; }
+
 private:
     std::vector<Display*> displays;
+    SoftwareRenderer* softwareRenderer;
+    RenderQueue renderQueue;
 };
 
 #endif // MACHINE_H
@@ -0,0 +1,18 @@
+#ifndef MACHINE_INTRINSICS_H
+#define MACHINE_INTRINSICS_H
+
+#include "IntrinsicBinding.h"
+
+class Machine;
+class TextDisplay;
+
+// Set the objects that the machine intrinsics operate on
+void SetIntrinsicTargets(Machine* machine, TextDisplay* text);
+
+// Get the table of intrinsics wrapping the Machine and its displays
+const IntrinsicDef* GetMachineIntrinsics(int& outCount);
+
+// Find a table entry by name (for use at registration time, not per call)
+const IntrinsicDef* FindIntrinsic(const IntrinsicDef* table, int count, const char* name);
+
+#endif // MACHINE_INTRINSICS_H
@@ -0,0 +1,37 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+
+// A read-only file mapped into memory.  Pages are loaded on demand by the
+// OS, so opening even a large file is cheap.
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+
+    bool Open(const char* path);
+    void Close();
+
+    bool IsOpen() const { return data != nullptr; }
+    const unsigned char* GetData() const { return data; }
+    size_t GetSize() const { return size; }
+
+    // Rename newPath over path in one step (rename on POSIX, MoveFileEx on
+    // Windows, where rename won't replace a file).  On failure the file at
+    // path is left as it was.  Close any mapping of path first.
+    static bool Replace(const char* path, const char* newPath);
+
+private:
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char* data;
+    size_t size;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#endif
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,167 @@
+#ifndef MINI_DISK_H
+#define MINI_DISK_H
+
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// A Mini Micro minidisk: a zip file used as a disk.  The zip is memory-
+// mapped and its central directory parsed once, at mount, into a hash
+// index of paths and a list of children per directory, so looking up a
+// file or listing a directory never scans the whole disk.  Stored (not
+// compressed) files are served straight from the mapping; deflated ones
+// are inflated on first read and kept in a size-bounded cache, dropping
+// the least recently read when full.
+//
+// Writes go to an in-memory journal that lookups consult first, and are
+// written back as a new zip (replacing the old one) by Flush(): on Eject,
+// or from Update once the disk has been idle for a moment.  The idle flush
+// builds the new zip on a worker thread from a copy of the journal, and
+// only the swap happens on the main thread; writes made meanwhile stay in
+// the journal for the next flush.  The old zip stays mounted, and the
+// journal kept, until the new one has replaced it, so a failed flush
+// loses nothing.
+//
+// Paths are relative to the disk root, separated by '/'; "" is the root.
+class MiniDisk {
+public:
+    static const size_t kDefaultCacheBytes = 16 * 1024 * 1024;
+    static constexpr float kIdleFlushSeconds = 2.0f;
+
+    struct FileInfo {
+        std::string name;       // last path component
+        size_t size;
+        bool isDirectory;
+        uint32_t dosTime;       // zip (MS-DOS) date << 16 | time
+    };
+
+    MiniDisk();
+    ~MiniDisk();
+
+    bool Mount(const char* zipPath, bool writable);     // false if the current disk won't eject
+
+    // Flush pending writes and unmount; if they can't be written, the disk
+    // stays mounted with its changes and this returns false
+    bool Eject();
+    bool IsMounted() const { return file.IsOpen(); }
+    bool IsWritable() const { return writable; }
+
+    bool Exists(const std::string& path) const;
+    bool GetInfo(const std::string& path, FileInfo& outInfo) const;
+
+    // Append a directory's entries to out; false if it is not a directory
+    bool ListDirectory(const std::string& path, std::vector<FileInfo>& out) const;
+
+    // Get a file's contents.  The pointer stays valid until the next
+    // ReadFile, write, Flush, Update, or Eject.
+    bool ReadFile(const std::string& path, const unsigned char** outData, size_t* outSize);
+
+    // Journaled changes (the parent directory must exist)
+    bool WriteFile(const std::string& path, const void* data, size_t size);
+    bool MakeDirectory(const std::string& path);
+    bool Delete(const std::string& path);      // a file or an empty directory
+
+    bool HasPendingWrites() const { return !journal.empty(); }
+    bool Flush();
+
+    // Call once per frame; starts a background flush after kIdleFlushSeconds
+    // without writes, and swaps in its result once built
+    void Update(float deltaTime);
+
+    void SetCacheLimit(size_t bytes) { cacheLimit = bytes; }
+    int GetCacheHitCount() const { return cacheHits; }
+    int GetCacheMissCount() const { return cacheMisses; }
+    size_t GetCacheBytes() const { return cacheBytes; }
+
+private:
+    MiniDisk(const MiniDisk&) = delete;
+    MiniDisk& operator=(const MiniDisk&) = delete;
+
+    struct Entry {
+        std::string path;           // without a trailing '/'
+        uint32_t crc;
+        uint32_t compressedSize;
+        uint32_t size;
+        uint32_t localOffset;       // of the local header
+        uint32_t dosTime;
+        uint16_t method;            // 0 stored, 8 deflated
+        bool isDirectory;
+        bool implicit;              // directory only implied by its files' paths
+    };
+
+    struct Pending {
+        bool deleted;
+        bool isDirectory;
+        std::vector<unsigned char> data;
+        uint32_t dosTime;
+        unsigned int sequence;      // writeSequence when last changed
+    };
+
+    struct CacheItem {
+        unsigned char* data;        // from DecompressData (MemFree to release)
+        size_t size;
+        unsigned int lastUsed;
+    };
+
+    typedef std::unordered_map<std::string, Pending> Journal;
+
+    bool ParseCentralDirectory();
+    bool Reopen();
+    void Close();
+    int AddEntry(const Entry& entry);
+    int FindEntry(const std::string& path) const;
+    const unsigned char* EntryData(const Entry& entry) const;
+    bool IsDirectoryPath(const std::string& path) const;
+    void EvictCache(size_t incoming);
+    void ClearCache();
+    unsigned int NoteWrite() {
+        idleTime = 0;
+        return ++writeSequence;
+    }
+
+    // Write a zip of the current entries plus changes to path.  Only reads
+    // the index and the mapping, so it can run on the flush worker.
+    bool WriteZip(const Journal& changes, const std::string& path) const;
+
+    // Swap a written zip in for the disk file and index it; the journal
+    // entries up to sequence are dropped only if that succeeds
+    bool SwapIn(const std::string& tempPath, unsigned int sequence);
+
+    void StartBackgroundFlush();
+    bool FinishBackgroundFlush();
+
+    MappedFile file;
+    std::string diskPath;
+    bool writable;
+
+    std::vector<Entry> entries;
+    std::unordered_map<std::string, int> index;                 // path -> entry
+    std::unordered_map<std::string, std::vector<int>> children; // directory path -> entries
+
+    Journal journal;
+    float idleTime;
+    unsigned int writeSequence;
+
+    // Background flush: the worker reads flushChanges and the index, and
+    // sets flushDone; nothing else is touched until the main thread sees it
+    ThreadPool* flushPool;                                      // created on first use
+    Journal flushChanges;
+    unsigned int flushSequence;
+    bool flushing;
+    bool flushWritten;
+    std::atomic<bool> flushDone;
+
+    std::unordered_map<int, CacheItem> cache;                   // by entry
+    size_t cacheBytes;
+    size_t cacheLimit;
+    unsigned int readCounter;
+    int cacheHits;
+    int cacheMisses;
+};
+
+#endif // MINI_DISK_H
@@ -0,0 +1,114 @@
+#ifndef MUSIC_STREAM_H
+#define MUSIC_STREAM_H
+
+#include "SpscRing.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+// Streaming playback of a long music file.  A background thread decodes the
+// file a chunk at a time into a fixed-size ring buffer, and the AudioMixer
+// pulls from that ring in its callback.  Memory use is bounded by the ring
+// size no matter how long the track is, and opening a file reads only its
+// header.  Tracks in the resource archive are decoded straight from the
+// mapping.  Supports WAV files (PCM 8/16/24/32-bit or 32-bit float, any
+// sample rate, mono or stereo).
+class MusicStream {
+public:
+    static const int kRingFrames = 32768;   // ~0.75 s of buffered audio
+    static const int kChunkFrames = 4096;   // source frames decoded at a time
+
+    MusicStream();
+    ~MusicStream();
+
+    // Open a resource (from the archive, or the resources folder) and start
+    // decoding, paused until Play is called.  OpenFile takes a path on disk.
+    // Detach the stream from the mixer before closing or destroying it.
+    bool Open(const char* relativePath);
+    bool OpenFile(const char* path);
+    void Close();
+    bool IsOpen() const { return file != nullptr || memory != nullptr; }
+
+    void Play() { playing = true; }
+    void Pause() { playing = false; }
+    bool IsPlaying() const { return playing && !(finished && ring.IsEmpty()); }
+
+    // Jump to a time (in seconds); takes effect within one decode chunk
+    void Seek(double seconds);
+
+    // Looping: when enabled, playback jumps from the loop end back to the
+    // loop start.  An end of 0 means the end of the file.  Enabling it on a
+    // stream that already reached the end restarts it from the loop start.
+    void SetLoop(bool loop) { looping = loop; }
+    void SetLoopPoints(double startSeconds, double endSeconds);
+
+    void SetVolume(float volume) { this->volume = volume; }
+    float GetVolume() const { return volume; }
+
+    double GetDuration() const;
+    double GetPosition() const;
+
+    // Bytes held by the stream (ring and decode buffers), for any track length
+    size_t GetMemoryUsage() const;
+
+    // Audio thread: fill out with up to `frames` frames of interleaved
+    // stereo at the mixer rate; returns how many frames were written
+    int Read(float* out, int frames);
+
+private:
+    MusicStream(const MusicStream&) = delete;
+    MusicStream& operator=(const MusicStream&) = delete;
+
+    bool Start(const char* name);
+    bool ParseHeader();
+    size_t ReadBytes(void* dest, size_t size, size_t count);
+    bool SeekBytes(long offset);
+    long TellBytes() const;
+    void DecoderLoop();
+    int DecodeChunk(float* srcFrames, int maxFrames);
+    void SeekSource(int64_t frame);
+
+    // Source bytes: a loose file, or a file in the mapped resource archive
+    FILE* file;
+    const unsigned char* memory;
+    size_t memorySize;
+    size_t memoryPos;
+
+    std::thread decoder;
+    std::atomic<bool> quit;
+
+    // Source format
+    int format;             // 1 = PCM, 3 = float
+    int channels;
+    int sampleRate;
+    int bytesPerSample;
+    long dataOffset;
+    int64_t totalFrames;
+    int64_t sourceFrame;    // next frame to decode (decoder thread)
+
+    // Resampling state (decoder thread)
+    double resamplePos;
+    bool haveCarry;
+    std::vector<unsigned char> rawChunk;
+    std::vector<float> srcChunk;
+    std::vector<float> outChunk;
+
+    // Decoded audio, at the mixer rate
+    SpscRing<float, kRingFrames * 2> ring;
+
+    // Shared state
+    std::atomic<bool> playing;
+    std::atomic<bool> finished;         // decoder hit the end, ring may still drain
+    std::atomic<bool> looping;
+    std::atomic<int64_t> loopStart;     // in source frames
+    std::atomic<int64_t> loopEnd;       // in source frames; 0 = end of file
+    std::atomic<int64_t> seekRequest;   // source frame, or -1
+    std::atomic<bool> flushPending;     // decoder waits for the reader to drop stale audio
+    std::atomic<int64_t> playedFrames;  // output frames read since the last seek
+    std::atomic<int64_t> positionBase;  // source frame of the last seek
+    std::atomic<float> volume;
+};
+
+#endif // MUSIC_STREAM_H
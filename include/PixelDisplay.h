@@ -0,0 +1,91 @@
+#ifndef PIXEL_DISPLAY_H
+#define PIXEL_DISPLAY_H
+
+#include "Display.h"
+#include "ResourceManager.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Display of arbitrary pixel graphics (Mini Micro's `gfx`).
+// Drawing happens on a CPU-side RGBA framebuffer, so reading a pixel never
+// waits on the GPU.  Changed areas are tracked as a few dirty rectangles,
+// and only those are uploaded to the texture, once per frame when drawn.
+// Coordinates are bottom-up like the rest of Mini Micro: (0,0) is the
+// lower-left pixel.
+class PixelDisplay : public Display {
+public:
+    static const int kDefaultWidth = kScreenWidth;
+    static const int kDefaultHeight = kScreenHeight;
+    static const int kMaxDirtyRects = 8;
+
+    PixelDisplay();
+    virtual ~PixelDisplay();
+
+    void Render() override;
+    bool Record(RenderQueue& queue) override;
+    void Clear() override;              // to transparent
+    void Clear(Color color);
+
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+    void SetSize(int width, int height);    // also clears
+
+    // The framebuffer: RGBA8, top row first
+    const uint32_t* GetPixels() const { return pixels.data(); }
+
+    // Single pixels
+    Color GetPixel(int x, int y) const;
+    void SetPixel(int x, int y, Color color);
+
+    // Shapes; these replace the pixels they cover
+    void FillRect(int left, int bottom, int width, int height, Color color);
+    void DrawRect(int left, int bottom, int width, int height, Color color, int penSize = 1);
+    void Line(int x1, int y1, int x2, int y2, Color color, int penSize = 1);
+    void FillEllipse(int left, int bottom, int width, int height, Color color);
+    void DrawEllipse(int left, int bottom, int width, int height, Color color, int penSize = 1);
+    void FillPolygon(const Vector2* points, int count, Color color);     // even-odd rule
+
+    // Replace the connected area of same-colored pixels containing (x,y)
+    void FloodFill(int x, int y, Color color);
+
+    // Blend an RGBA8 image onto the display, lower-left corner at (left,bottom)
+    void DrawImage(const Image& image, int left, int bottom);
+
+    // Blend part of an image, e.g. a TextureAtlas region from its page image
+    void DrawImage(const Image& image, Rectangle source, int left, int bottom);
+
+    // Blend an image resource once ready.  Packed images are read from the
+    // atlas page's CPU copy; others have to be read back from their texture.
+    void DrawImage(const ResourceManager::TextureResource* resource, int left, int bottom);
+
+private:
+    struct DirtyRect {
+        int left, top, right, bottom;   // framebuffer rows (top-down); right/bottom exclusive
+    };
+
+    struct FillSeed {
+        int x, row;
+    };
+
+    uint32_t* Row(int y) { return &pixels[(size_t)(height - 1 - y) * width]; }
+    void FillRows(int left, int bottom, int right, int top, uint32_t value);
+    void FillSpan(int y, int left, int right, uint32_t value);
+    void MarkDirty(int left, int bottom, int right, int top);
+    void UploadDirty();
+
+    int width;
+    int height;
+    std::vector<uint32_t> pixels;       // RGBA8, top row first (texture order)
+
+    std::vector<DirtyRect> dirty;
+    std::vector<uint32_t> uploadBuffer;
+
+    // Scratch space, kept to avoid allocating per call
+    std::vector<float> crossings;
+    std::vector<FillSeed> seeds;
+
+    Texture2D texture;
+};
+
+#endif // PIXEL_DISPLAY_H
@@ -0,0 +1,40 @@
+#ifndef PIXEL_KERNELS_H
+#define PIXEL_KERNELS_H
+
+#include "raylib.h"
+#include <cstdint>
+#include <cstring>
+
+// Span kernels on RGBA8 pixels (one uint32_t each, in memory order R,G,B,A),
+// shared by the CPU-side displays and the software renderer.  Each uses
+// SSE2 or NEON where available, with a scalar fallback.
+namespace PixelKernels {
+    inline uint32_t PackColor(Color c) {
+        uint32_t value;
+        memcpy(&value, &c, sizeof(value));
+        return value;
+    }
+
+    inline Color UnpackColor(uint32_t value) {
+        Color c;
+        memcpy(&c, &value, sizeof(c));
+        return c;
+    }
+
+    // dst[0..count) = value
+    void FillPixels(uint32_t* dst, uint32_t value, int count);
+
+    // Source-over blend of src onto dst, with exact rounding of x/255
+    uint32_t BlendPixel(uint32_t d, uint32_t s);
+    void BlendPixels(uint32_t* dst, const uint32_t* src, int count);
+
+    // First index in [start, end) where row differs from value, or end
+    int FindMismatch(const uint32_t* row, int start, int end, uint32_t value);
+
+    // Blend a row of glyph pixels onto dst: each pixel is back mixed toward
+    // fore by its 0-255 mask value (as the screen font shader does), then
+    // blended source-over
+    void BlendGlyphSpan(uint32_t* dst, const unsigned char* mask, int count, uint32_t fore, uint32_t back);
+}
+
+#endif // PIXEL_KERNELS_H
@@ -0,0 +1,112 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+class TextDisplay;
+
+// Sampling profiler for running MiniScript programs.
+// The VM calls Tick() once per instruction.  Every N instructions (or every
+// N milliseconds, signalled by a timer thread) a sample is due, and the
+// current script call stack is captured through the stack walker callback.
+// Between samples, Tick() costs a decrement or a relaxed load and a branch.
+class Profiler {
+public:
+    // One frame of a script call stack
+    struct Frame {
+        int function;   // ID returned by InternFunction
+        int line;
+
+        Frame() : function(0), line(0) {}
+        Frame(int f, int l) : function(f), line(l) {}
+        bool operator==(const Frame& other) const {
+            return function == other.function && line == other.line;
+        }
+    };
+
+    // Fills outStack with the current call stack, outermost frame first
+    typedef std::function<void(std::vector<Frame>& outStack)> StackWalker;
+
+    Profiler();
+    ~Profiler();
+
+    // Start sampling every `interval` VM instructions
+    void StartByInstructions(int interval);
+
+    // Start sampling every `intervalMs` milliseconds (driven by a timer thread)
+    void StartByTime(int intervalMs);
+
+    void Stop();
+    bool IsRunning() const { return running; }
+
+    // Discard all collected samples (keeps interned function names)
+    void Reset();
+
+    void SetStackWalker(StackWalker walker) { stackWalker = walker; }
+
+    // Get a stable ID for a function name (call when the function is
+    // compiled or first seen, not while sampling)
+    int InternFunction(const std::string& name);
+    const std::string& GetFunctionName(int function) const;
+
+    // Call once per VM instruction
+    void Tick() {
+        if (!running) return;
+        if (byTime) {
+            if (sampleDue.load(std::memory_order_relaxed)) TakeSample();
+        } else if (--countdown <= 0) {
+            TakeSample();
+        }
+    }
+
+    // Capture a sample right now
+    void TakeSample();
+
+    int GetSampleCount() const { return totalSamples; }
+
+    // Write all samples in folded-stack format ("a:1;b:7;c:12 42" per line),
+    // suitable for flamegraph.pl, speedscope, etc.
+    bool WriteFoldedStacks(const char* path) const;
+
+    // Text summary of the hottest functions and lines
+    std::string GetSummary(int maxEntries = 10) const;
+    void PrintSummary(TextDisplay* display, int maxEntries = 10) const;
+
+private:
+    struct StackHash {
+        size_t operator()(const std::vector<Frame>& stack) const;
+    };
+
+    void StopTimer();
+    void TimerLoop(int intervalMs);
+
+    bool running;
+    bool byTime;
+    int interval;
+    int countdown;
+    std::atomic<bool> sampleDue;
+
+    std::thread timerThread;
+    std::mutex timerMutex;
+    std::condition_variable timerWake;
+    bool timerQuit;
+
+    StackWalker stackWalker;
+    std::vector<Frame> scratchStack;    // reused for every sample
+
+    std::vector<std::string> functionNames;
+    std::unordered_map<std::string, int> functionIds;
+
+    // Sample counts per distinct call stack
+    std::unordered_map<std::vector<Frame>, int, StackHash> stackCounts;
+    int totalSamples;
+};
+
+#endif // PROFILER_H
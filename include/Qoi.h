@@ -0,0 +1,21 @@
+#ifndef QOI_H
+#define QOI_H
+
+#include <vector>
+#include <cstddef>
+
+// Encoder/decoder for the QOI ("Quite OK Image") format: lossless RGBA
+// compression that decodes several times faster than PNG.
+// See https://qoiformat.org/qoi-specification.pdf
+namespace Qoi {
+    // Encode RGBA8 pixels; appends to out
+    void Encode(const unsigned char* pixels, int width, int height, std::vector<unsigned char>& out);
+
+    // Read just the dimensions from a QOI header
+    bool ReadHeader(const unsigned char* data, size_t size, int* outWidth, int* outHeight);
+
+    // Decode into outPixels, which must hold width*height*4 bytes
+    bool Decode(const unsigned char* data, size_t size, unsigned char* outPixels, int width, int height);
+}
+
+#endif // QOI_H
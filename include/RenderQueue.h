@@ -0,0 +1,85 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include "raylib.h"
+#include <cstdint>
+#include <vector>
+
+// Per-frame list of textured quads recorded by the display layers, drawn
+// in as few batches as layer order allows.  Each quad names a draw state
+// (shader, texture, blend mode); states are interned per frame, and each
+// quad gets a 64-bit sort key:
+//
+//   layer (8 bits) | state (24 bits, sortable layers only) | sequence (32 bits)
+//
+// so layers always draw in the order they were begun, a sortable layer's
+// quads are grouped by state, and everything else keeps recording order.
+// Flush() sorts the keys and walks them, changing GL state only where a run
+// of same-state quads ends; runs that meet across layers merge.
+class RenderQueue {
+public:
+    // What a quad is drawn with; shader id 0 means Raylib's default shader
+    struct DrawState {
+        Shader shader;
+        unsigned int texture;
+        int blendMode;
+    };
+
+    RenderQueue();
+
+    // Start a frame: forget states and reset the counters
+    void BeginFrame();
+
+    // Quads added from now on belong to a new layer, drawn above the
+    // previous ones.  A sortable layer's quads may be reordered by state.
+    void BeginLayer(bool sortable);
+
+    // Add a quad.  Corners are in window coordinates (y down), in the
+    // order top-left, bottom-left, bottom-right, top-right of the texture
+    // area u0,v0 - u1,v1.  `extra` reaches the shader as vertexNormal.xy.
+    void AddQuad(const DrawState& state, const Vector2 corners[4],
+                 float u0, float v0, float u1, float v1, Color color,
+                 Vector2 extra = Vector2{ 0, 0 });
+
+    // Axis-aligned convenience form; (x, y) is the top-left corner
+    void AddRect(const DrawState& state, float x, float y, float width, float height,
+                 float u0, float v0, float u1, float v1, Color color,
+                 Vector2 extra = Vector2{ 0, 0 });
+
+    // Draw everything recorded so far, then leave Raylib in its default
+    // state (default shader, alpha blending, no texture)
+    void Flush();
+
+    bool IsEmpty() const { return keys.empty(); }
+
+    // Counters for the current frame
+    int GetCommandCount() const { return commandCount; }
+    int GetBatchCount() const { return batchCount; }
+    int GetStateChangeCount() const { return stateChangeCount; }
+    int GetStateCount() const { return (int)states.size(); }
+
+private:
+    struct Quad {
+        Vector2 corners[4];
+        float u0, v0, u1, v1;
+        Color color;
+        Vector2 extra;
+        int state;
+    };
+
+    int InternState(const DrawState& state);
+    void ApplyState(const DrawState* current, const DrawState& next);
+
+    std::vector<DrawState> states;
+    int lastState;                      // index of the last state interned
+    std::vector<Quad> quads;            // indexed by the key's sequence bits
+    std::vector<uint64_t> keys;
+    bool layerSortable;
+    int layer;
+
+    int commandCount;
+    int batchCount;
+    int stateChangeCount;
+};
+
+#endif // RENDER_QUEUE_H
@@ -0,0 +1,77 @@
+#ifndef RESOURCE_ARCHIVE_H
+#define RESOURCE_ARCHIVE_H
+
+#include "MappedFile.h"
+#include <cstdint>
+#include <cstring>
+
+// Packed resource archive ("resources.pak"), built from the resources folder
+// by the PackResources tool at build time and memory-mapped at runtime.
+//
+// Layout (all integers little-endian):
+//   ArchiveHeader
+//   ArchiveEntry[entryCount], sorted by (pathHash, path)
+//   path strings (not null-terminated)
+//   file data, and optional pre-decoded RGBA pixels, each 16-byte aligned
+namespace ResourceArchiveFormat {
+    static const char kMagic[4] = { 'M', 'M', 'P', 'K' };
+    static const uint32_t kVersion = 1;
+    static const uint32_t kAlignment = 16;
+
+    struct ArchiveHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t reserved;
+    };
+
+    struct ArchiveEntry {
+        uint64_t pathHash;
+        uint64_t pathOffset;
+        uint64_t dataOffset;    // original file bytes
+        uint64_t dataSize;
+        uint64_t pixelsOffset;  // pre-decoded RGBA8 pixels, or 0 if none
+        uint32_t pathLength;
+        uint32_t width;         // of the pre-decoded pixels
+        uint32_t height;
+        uint32_t reserved;
+    };
+
+    // FNV-1a hash of a resource path
+    inline uint64_t HashPath(const char* path, size_t length) {
+        uint64_t hash = 14695981039346656037ULL;
+        for (size_t i = 0; i < length; i++) {
+            hash = (hash ^ (unsigned char)path[i]) * 1099511628211ULL;
+        }
+        return hash;
+    }
+}
+
+// Read-only view of a packed resource archive.  All returned pointers point
+// directly into the mapped file and stay valid until Close().
+class ResourceArchive {
+public:
+    ResourceArchive();
+
+    bool Open(const char* path);
+    void Close();
+    bool IsOpen() const { return entryCount > 0; }
+
+    // Get the bytes of a file, given its path relative to the resources folder
+    bool GetFile(const char* relativePath, const unsigned char** outData, size_t* outSize) const;
+
+    // Get pre-decoded RGBA8 pixels for an image, if the archive has them
+    bool GetPixels(const char* relativePath, const unsigned char** outPixels,
+                   int* outWidth, int* outHeight) const;
+
+    int GetEntryCount() const { return (int)entryCount; }
+
+private:
+    const ResourceArchiveFormat::ArchiveEntry* Find(const char* relativePath) const;
+
+    MappedFile file;
+    const ResourceArchiveFormat::ArchiveEntry* entries;
+    uint32_t entryCount;
+};
+
+#endif // RESOURCE_ARCHIVE_H
@@ -0,0 +1,116 @@
+#ifndef RESOURCE_MANAGER_H
+#define RESOURCE_MANAGER_H
+
+#include "raylib.h"
+#include "ThreadPool.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+
+// Shared, reference-counted loader for textures and sounds.
+// Resources are identified by their path relative to the resources folder
+// (as passed to GetResourceFile), so each file is loaded at most once.
+// File reading and PNG/WAV decoding happen on a background thread pool;
+// the GPU/audio-device part of loading happens on the main thread in
+// Update(), a few resources per frame.
+//
+// Images for the displays (sprites, tiles, gfx) are acquired with
+// AcquireImage, which packs small ones into the shared TextureAtlas, so a
+// display drawing many different images still draws them in few batches.
+// The displays take these resources directly and handle both cases.
+class ResourceManager {
+public:
+    enum State {
+        kPending,   // queued, decoding, or waiting for upload on the main thread
+        kReady,
+        kFailed
+    };
+
+    struct TextureResource {
+        std::string path;
+        State state;
+        int refCount;
+        Image image;        // decoded, until uploaded
+        bool imageMapped;   // image points into the resource archive
+        bool packable;      // acquired with AcquireImage: may go into the atlas
+        int atlasRegion;    // region in TextureAtlas::Shared(), or -1 if not packed
+        Texture2D texture;  // valid once kReady, if not packed
+
+        bool IsReady() const { return state == kReady; }
+    };
+
+    struct SoundResource {
+        std::string path;
+        State state;
+        int refCount;
+        Wave wave;          // decoded, until uploaded
+        Sound sound;        // valid once kReady
+
+        bool IsReady() const { return state == kReady; }
+    };
+
+    // The shared resource manager
+    static ResourceManager& Shared();
+
+    // Start loading (or add a reference to) a resource.  Never returns null;
+    // check IsReady() before using the texture or sound.
+    TextureResource* AcquireTexture(const char* path);
+    SoundResource* AcquireSound(const char* path);
+
+    // Like AcquireTexture, but an image of at most kMaxPackedSize pixels a
+    // side is packed into the shared TextureAtlas instead (if there is room)
+    TextureResource* AcquireImage(const char* path);
+
+    // Drop a reference; the resource is unloaded when none remain
+    void Release(TextureResource* resource);
+    void Release(SoundResource* resource);
+
+    // Block until the given resource is ready (or failed)
+    void Finish(TextureResource* resource);
+    void Finish(SoundResource* resource);
+
+    // Upload decoded resources; call once per frame on the main thread
+    void Update(int maxUploads = kUploadsPerFrame);
+
+    // Number of resources not yet ready
+    int PendingCount() const { return pendingCount; }
+
+    // Unload everything (call before closing the window/audio device)
+    void Shutdown();
+
+    static const int kUploadsPerFrame = 4;
+    static const int kMaxPackedSize = 256;
+
+private:
+    ResourceManager();
+    ~ResourceManager();
+    ResourceManager(const ResourceManager&) = delete;
+    ResourceManager& operator=(const ResourceManager&) = delete;
+
+    TextureResource* Acquire(std::unordered_map<std::string, TextureResource*>& map,
+                             const char* path, bool packable);
+    void DecodeTexture(TextureResource* resource);
+    void DecodeSound(SoundResource* resource);
+    void Upload(TextureResource* resource);
+    void Upload(SoundResource* resource);
+    void Unload(TextureResource* resource);
+    void Unload(SoundResource* resource);
+
+    ThreadPool* pool;   // created on first use
+
+    std::unordered_map<std::string, TextureResource*> textures;
+    std::unordered_map<std::string, TextureResource*> images;     // from AcquireImage
+    std::unordered_map<std::string, SoundResource*> sounds;
+
+    // Resources decoded by workers, awaiting upload (guarded by mutex)
+    std::mutex mutex;
+    std::condition_variable decoded;
+    std::vector<TextureResource*> decodedTextures;
+    std::vector<SoundResource*> decodedSounds;
+
+    int pendingCount;
+};
+
+#endif // RESOURCE_MANAGER_H
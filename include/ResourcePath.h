@@ -2,6 +2,9 @@
 #define RESOURCE_PATH_H
 
 #include <string>
+#include <cstddef>
+
+class ResourceArchive;
 
 // Get the base path where resources are located
 // This works across platforms and build configurations
@@ -10,4 +13,39 @@ std::string GetResourcePath();
 // Get full path to a resource file
 std::string GetResourceFile(const char* relativePath);
 
+// Get the per-user folder for cached data (created if needed), or an
+// empty string if there is none
+std::string GetCacheFolder();
+
+// Get the per-user folder for data kept across sessions, such as the
+// command history (created if needed), or an empty string if there is none
+std::string GetDataFolder();
+
+// Get the packed resource archive ("resources.pak" next to the resources
+// folder), opened on first use.  It may not be open, if there isn't one.
+const ResourceArchive& GetResourceArchive();
+
+// Contents of a resource file: served zero-copy from the resource archive
+// when it has the file, otherwise read from the resources folder
+class ResourceData {
+public:
+    ResourceData();
+    ~ResourceData();
+
+    bool Load(const char* relativePath);
+    void Clear();
+
+    bool IsValid() const { return data != nullptr; }
+    const unsigned char* GetData() const { return data; }
+    size_t GetSize() const { return size; }
+
+private:
+    ResourceData(const ResourceData&) = delete;
+    ResourceData& operator=(const ResourceData&) = delete;
+
+    const unsigned char* data;
+    size_t size;
+    bool owned;     // true if read from disk (and so must be freed)
+};
+
 #endif // RESOURCE_PATH_H
@@ -2,6 +2,10 @@
 #define SCREEN_FONT_H
 
 #include "raylib.h"
+#include "ResourceManager.h"
+#include <vector>
+
+class RenderQueue;
 
 // Handles the Mini Micro screen font - a 16x16 grid texture
 // with special Unicode character mappings
@@ -10,7 +14,9 @@ public:
     ScreenFont();
     ~ScreenFont();
 
-    // Load a font texture (should be 16x16 character grid)
+    // Start loading a font texture (should be 16x16 character grid), given
+    // its path relative to the resources folder; IsLoaded() becomes true
+    // once the ResourceManager has it ready
     bool Load(const char* texturePath);
 
     // Load the shader (call once, before using any ScreenFont)
@@ -20,25 +26,38 @@ public:
     // Get the position in the font grid for a Unicode character
     int GetFontPosition(int unicode) const;
 
-    // Draw a character at the specified position
-    void DrawChar(int unicode, float x, float y, Color foreColor, Color backColor);
+    // Record a character cell at the specified position (top-left, window
+    // coordinates).  With the shader, the foreground color goes in the
+    // vertex color and the background in the vertex normal, so cells of any
+    // colors batch together.
+    void RecordChar(RenderQueue& queue, int unicode, float x, float y, Color foreColor, Color backColor) const;
 
     // Get character dimensions
-    int GetCharWidth() const { return charWidth; }
-    int GetCharHeight() const { return charHeight; }
+    int GetCharWidth() const { return IsLoaded() ? fontResource->texture.width / 16 : 0; }
+    int GetCharHeight() const { return IsLoaded() ? fontResource->texture.height / 16 : 0; }
+
+    bool IsLoaded() const { return fontResource && fontResource->IsReady(); }
 
-    bool IsLoaded() const { return textureLoaded; }
+    // Coverage masks for all 256 glyphs (the font image's alpha channel),
+    // for drawing on the CPU.  Build on the main thread once the font is
+    // loaded; afterwards the masks may be read from any thread.
+    bool BuildGlyphMasks();
+    bool HasGlyphMasks() const { return !glyphMasks.empty(); }
+    const unsigned char* GetGlyphMask(int fontPos) const {
+        return &glyphMasks[(size_t)fontPos * maskWidth * maskHeight];
+    }
+    int GetMaskWidth() const { return maskWidth; }
+    int GetMaskHeight() const { return maskHeight; }
 
 private:
-    Texture2D fontTexture;
-    int charWidth;
-    int charHeight;
-    bool textureLoaded;
+    ResourceManager::TextureResource* fontResource;
+
+    std::vector<unsigned char> glyphMasks;  // 256 glyphs, maskWidth x maskHeight each, rows top-down
+    int maskWidth;
+    int maskHeight;
 
     // Shared shader for all ScreenFont instances
     static Shader shader;
-    static int foreColorLoc;
-    static int backColorLoc;
     static bool shaderLoaded;
 };
 
@@ -0,0 +1,76 @@
+#ifndef SCREEN_PRESENTER_H
+#define SCREEN_PRESENTER_H
+
+#include "raylib.h"
+
+// Renders the machine into a fixed-size canvas and presents it to the
+// window at any size.  Everything (layers, loading screen) draws into the
+// canvas at 1024x768, the classic window layout, so HiDPI and fullscreen
+// windows cost one scaled blit rather than a redraw at window resolution.
+//
+// The bezel and sticker are drawn once into an overlay texture.  Presenting
+// composites the canvas, optional CRT effects (scanlines, curvature), and the
+// overlay in a single shader pass, with sharp-bilinear scaling so pixels stay
+// crisp at non-integer scales.  Mouse input is remapped to canvas coordinates.
+class ScreenPresenter {
+public:
+    static const int kCanvasWidth = 1024;
+    static const int kCanvasHeight = 768;
+
+    ScreenPresenter();
+    ~ScreenPresenter();
+
+    // Load the present shader (optional; without it the canvas and overlay
+    // are drawn as two plain blits)
+    bool LoadShader(const char* fragmentPath);
+
+    // Draw into the canvas between these
+    void BeginCanvas();
+    void EndCanvas();
+
+    // Draw the bezel (or any frame art) into the overlay between these;
+    // done once, not every frame
+    void BeginOverlay();
+    void EndOverlay();
+    bool HasOverlay() const { return overlayReady; }
+
+    // The canvas (a render texture, so stored bottom-up)
+    Texture2D GetCanvasTexture() const { return canvas.texture; }
+    unsigned int GetCanvasFramebuffer() const { return canvas.id; }
+
+    // Draw the canvas to the window; call between BeginDrawing/EndDrawing
+    void Present(bool withOverlay, Color background);
+
+    // Scale only by whole multiples (when the window is big enough)
+    void SetIntegerScaling(bool integer) { integerScaling = integer; }
+    bool GetIntegerScaling() const { return integerScaling; }
+
+    // CRT effects, 0 (off) to 1
+    void SetScanlines(float amount) { scanlines = amount; }
+    void SetCurvature(float amount) { curvature = amount; }
+    float GetScanlines() const { return scanlines; }
+    float GetCurvature() const { return curvature; }
+
+private:
+    void EnsureTargets();
+
+    RenderTexture2D canvas;
+    RenderTexture2D overlay;
+    bool targetsLoaded;
+    bool overlayReady;
+    bool integerScaling;
+    float scanlines;
+    float curvature;
+
+    Shader shader;
+    bool shaderLoaded;
+    int overlayLoc;
+    int useOverlayLoc;
+    int canvasSizeLoc;
+    int outputScaleLoc;
+    int screenRectLoc;
+    int scanlinesLoc;
+    int curvatureLoc;
+};
+
+#endif // SCREEN_PRESENTER_H
@@ -0,0 +1,71 @@
+#ifndef SOFTWARE_RENDERER_H
+#define SOFTWARE_RENDERER_H
+
+#include "raylib.h"
+#include "Display.h"
+#include "ThreadPool.h"
+#include <cstdint>
+#include <vector>
+
+class Machine;
+
+// Alternative to drawing the machine's layers with GL calls, for machines
+// without a usable GPU (where software GL is slow on thousands of small
+// textured quads).  Solid color, text and pixel layers are rasterized
+// straight into a CPU framebuffer covering the machine screen; the result is
+// presented with one texture upload and one draw.
+//
+// The screen is split into horizontal bands, rendered in parallel on a
+// thread pool; each band composites every layer, so no locking is needed.
+// Glyphs are blitted from ScreenFont's coverage masks with SIMD kernels.
+// Other layer types, and layer scale/scroll, are not supported: a frame
+// showing any of them is left to the GL path.
+class SoftwareRenderer {
+public:
+    static const int kWidth = Display::kScreenWidth;
+    static const int kHeight = Display::kScreenHeight;
+    static const int kBandHeight = 32;      // screen rows per job
+
+    // threadCount as for ThreadPool
+    explicit SoftwareRenderer(int threadCount = 0);
+    ~SoftwareRenderer();
+
+    // Rasterize the machine's layers into the framebuffer; returns false
+    // (leaving the framebuffer as it was) if a visible layer isn't supported
+    bool Rasterize(Machine& machine);
+
+    // Upload the framebuffer and draw it at the screen position
+    void Present();
+
+    // RGBA8, top row first, kWidth x kHeight
+    const uint32_t* GetPixels() const { return pixels.data(); }
+
+    // Compare the framebuffer's RGB with the screen area of a 1024x768
+    // RGBA8 canvas image (e.g. read back from the GL path); returns the
+    // number of pixels differing by more than tolerance in any channel
+    int CountMismatches(const Image& canvas, int tolerance, int* outMaxDifference) const;
+
+    double GetLastRasterizeMs() const { return lastRasterizeMs; }
+    int GetThreadCount() const { return pool.GetThreadCount(); }
+
+private:
+    enum LayerKind { kSolidLayer, kTextLayer, kPixelLayer };
+
+    struct Layer {
+        LayerKind kind;
+        Display* display;
+    };
+
+    void RenderBand(int top, int bottom);
+    void RenderText(const Layer& layer, int top, int bottom);
+    void RenderPixels(const Layer& layer, int top, int bottom);
+
+    ThreadPool pool;
+    std::vector<uint32_t> pixels;
+    std::vector<Layer> layers;          // bottom to top, for the current frame
+    Texture2D texture;
+    double lastRasterizeMs;
+    bool warnedUnsupported;             // logged the first unsupported layer
+};
+
+#endif // SOFTWARE_RENDERER_H
@@ -11,6 +11,7 @@ public:
 
     void Render() override;
     void Clear() override;
+    bool IsOpaque() const override { return visible && color.a == 255; }
 
     // Get/set the background color
     Color GetColor() const { return color; }
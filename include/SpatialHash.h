@@ -0,0 +1,61 @@
+#ifndef SPATIAL_HASH_H
+#define SPATIAL_HASH_H
+
+#include <cstdint>
+#include <vector>
+
+// Spatial hash over axis-aligned boxes, for finding which items are near a
+// point or a box without testing every item.  Space is divided into square
+// cells; each cell hashes to one of a fixed number of buckets listing the
+// items whose box touches it.  Moving an item only touches buckets when it
+// crosses into different cells, and buckets keep their capacity, so steady
+// state updates do not allocate.
+//
+// Items spanning too many cells to list in each (a sprite scaled up to
+// thousands of pixels) are kept in a separate short list instead, which
+// every query scans.
+//
+// Items are identified by small non-negative ints (e.g. sprite ids).
+class SpatialHash {
+public:
+    explicit SpatialHash(float cellSize = 64.0f, int bucketCount = 4096);
+
+    void Clear();
+
+    // Add an item, or move it if already present
+    void Update(int id, float minX, float minY, float maxX, float maxY);
+    void Remove(int id);
+    bool Contains(int id) const { return id >= 0 && id < (int)items.size() && items[id].present; }
+
+    // Append (once each) the items whose box overlaps the given box or point
+    void Query(float minX, float minY, float maxX, float maxY, std::vector<int>& out);
+    void QueryPoint(float x, float y, std::vector<int>& out);
+
+    int GetCount() const { return count; }
+
+private:
+    struct Item {
+        float minX, minY, maxX, maxY;
+        int cellX0, cellY0, cellX1, cellY1;
+        bool present;
+        bool oversized;     // in the oversized list rather than in cells
+    };
+
+    int CellOf(float v) const;
+    int Bucket(int cellX, int cellY) const;
+    void AddToCells(int id, const Item& item);
+    void RemoveFromCells(int id, const Item& item);
+    void Unlink(int id, const Item& item);
+
+    float cellSize;
+    float inverseCellSize;
+    int bucketMask;
+    std::vector<std::vector<int>> buckets;
+    std::vector<Item> items;            // indexed by id
+    std::vector<int> oversized;         // items too large for cells
+    std::vector<uint32_t> stamps;       // last query each item was reported in
+    uint32_t stamp;
+    int count;
+};
+
+#endif // SPATIAL_HASH_H
@@ -0,0 +1,148 @@
+#ifndef SPRITE_DISPLAY_H
+#define SPRITE_DISPLAY_H
+
+#include "Display.h"
+#include "ResourceManager.h"
+#include "SpatialHash.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class TextureAtlas;
+
+// Display of many sprites: textured quads, each with its own position,
+// scale, rotation and tint.  Sprite data is stored as parallel arrays
+// (structure of arrays), transforms are recomputed in one pass over the
+// sprites that changed, and drawing records the quads into the frame's
+// RenderQueue, where runs of same-texture quads share one batch.
+//
+// Sprite positions are the sprite's center, in bottom-up screen pixels.
+class SpriteDisplay : public Display {
+public:
+    // A region of a texture that sprites can show
+    struct SpriteImage {
+        Texture2D texture;
+        Rectangle source;
+        const TextureAtlas* atlas;  // if set, texture/source track this atlas region
+        int region;
+        int generation;             // atlas generation texture/source reflect
+    };
+
+    SpriteDisplay();
+    virtual ~SpriteDisplay();
+
+    void Render() override;
+    bool Record(RenderQueue& queue) override;
+    void Clear() override;      // removes all sprites (images are kept)
+
+    // Images; the display does not own the textures
+    int AddImage(Texture2D texture);
+    int AddImage(Texture2D texture, Rectangle source);
+    int AddImage(const TextureAtlas* atlas, int region);
+    int AddImage(const ResourceManager::TextureResource* resource);    // once ready; atlas or not
+    void SetImage(int image, Texture2D texture, Rectangle source);
+    int GetImageCount() const { return (int)images.size(); }
+
+    // Sprites are identified by an id that stays valid until removed
+    int AddSprite(int image, float x, float y);
+    void RemoveSprite(int id);
+    bool IsSprite(int id) const { return id >= 0 && id < (int)slotOfId.size() && slotOfId[id] >= 0; }
+    int GetSpriteCount() const { return (int)ids.size() - removedCount; }
+
+    void SetPosition(int id, float x, float y);
+    void SetScale(int id, float scaleX, float scaleY);
+    void SetRotation(int id, float degrees);
+    void SetTint(int id, Color tint);
+    void SetSpriteImage(int id, int image);
+
+    float GetX(int id) const;
+    float GetY(int id) const;
+    float GetRotation(int id) const;
+
+    // Bulk update, e.g. from a script loop over many sprites
+    void SetPositions(const int* spriteIds, const float* xs, const float* ys, int count);
+
+    // Axis-aligned bounds of a sprite, after scale and rotation
+    Rectangle GetBounds(int id);
+
+    // Collision queries, using the sprites' rotated rectangles.  Candidates
+    // come from a spatial hash kept up to date as sprites change, so these
+    // cost about the number of nearby sprites rather than all of them.
+    // Results are appended to out.
+    bool Overlaps(int id, int otherId);
+    void FindOverlapping(int id, std::vector<int>& out);
+    void FindAt(float x, float y, std::vector<int>& out);
+    void FindCollidingPairs(std::vector<std::pair<int, int>>& out);
+
+    // Draw order.  By default sprites draw in the order they were added.
+    // A script's (possibly nested) sprite list is flattened depth-first
+    // with BeginOrder/AppendOrder/EndOrder; capacity is kept between
+    // frames, so rebuilding the order every frame does not allocate.
+    void BeginOrder();
+    void AppendOrder(int id);
+    void EndOrder();
+    void ResetOrder();
+
+    // Allow sprites to be reordered so each texture is drawn in one run.
+    // Only appropriate when overlapping sprites need no particular order.
+    void SetSortByTexture(bool sort) { sortByTexture = sort; }
+
+    int GetLastDrawnCount() const { return lastDrawnCount; }
+    int GetLastBatchCount() const { return lastBatchCount; }
+
+private:
+    // Recompute corners and bounds of changed sprites
+    void UpdateTransforms();
+
+    // Pick up atlas regions that moved (repacking) or got their texture
+    void RefreshAtlasImages();
+
+    // Drop the slots of removed sprites, keeping the others in order
+    void CompactSlots();
+
+    // Per-sprite arrays, all indexed by slot (draw order when no explicit order).
+    // A removed sprite leaves its slot behind with id -1 until CompactSlots,
+    // which runs once per frame, so removing is O(1).
+    std::vector<int> ids;
+    std::vector<float> x, y;
+    std::vector<float> scaleX, scaleY;
+    std::vector<float> rotation;        // degrees
+    std::vector<float> cosR, sinR;
+    std::vector<Color> tint;
+    std::vector<int> image;
+    std::vector<uint8_t> changed;
+
+    // Computed by UpdateTransforms: 4 corners per sprite, and world bounds
+    std::vector<Vector2> corners;
+    std::vector<float> minX, minY, maxX, maxY;
+    bool anyChanged;
+
+    std::vector<int> slotOfId;          // -1 for removed ids
+    std::vector<int> freeIds;
+    int removedCount;                   // slots with id -1
+
+    SpatialHash spatialHash;            // world bounds by sprite id
+    std::vector<int> candidates;        // scratch for queries
+
+    void MarkChanged(int slot) {
+        changed[slot] = 1;
+        anyChanged = true;
+    }
+    int SlotOf(int id) const { return IsSprite(id) ? slotOfId[id] : -1; }
+    bool QuadsOverlap(int slotA, int slotB) const;
+    bool QuadContains(int slot, float px, float py) const;
+
+    std::vector<SpriteImage> images;
+
+    std::vector<int> order;             // sprite ids
+    bool useOrder;
+    bool sortByTexture;
+
+    std::vector<int> drawSlots;         // scratch: slots to draw this frame
+    std::vector<unsigned int> textureIds;   // scratch: for counting batches when sorted
+
+    int lastDrawnCount;
+    int lastBatchCount;
+};
+
+#endif // SPRITE_DISPLAY_H
@@ -0,0 +1,81 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+// Fixed-capacity, lock-free ring buffer for exactly one producer thread and
+// one consumer thread.  Never allocates, so it is safe to use from the audio
+// callback.  Capacity must be a power of two.
+template<typename T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    SpscRing() : head(0), tail(0) {}
+
+    // Producer side: add one item; returns false if full
+    bool Push(const T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= Capacity) return false;
+        items[h & kMask] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Producer side: add up to count items; returns how many were added
+    size_t PushMany(const T* src, size_t count) {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t space = Capacity - (h - tail.load(std::memory_order_acquire));
+        if (count > space) count = space;
+        for (size_t i = 0; i < count; i++) items[(h + i) & kMask] = src[i];
+        head.store(h + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side: remove one item; returns false if empty
+    bool Pop(T& out) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        out = items[t & kMask];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side: remove up to count items; returns how many were removed
+    size_t PopMany(T* dest, size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value, "PopMany copies with memcpy");
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t available = head.load(std::memory_order_acquire) - t;
+        if (count > available) count = available;
+        size_t start = t & kMask;
+        size_t firstPart = Capacity - start < count ? Capacity - start : count;
+        memcpy(dest, &items[start], firstPart * sizeof(T));
+        memcpy(dest + firstPart, &items[0], (count - firstPart) * sizeof(T));
+        tail.store(t + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side: discard everything currently queued
+    void Clear() {
+        tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    // Approximate when called from the thread that isn't changing it
+    size_t Size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+    bool IsEmpty() const { return Size() == 0; }
+    static size_t GetCapacity() { return Capacity; }
+
+private:
+    static const size_t kMask = Capacity - 1;
+
+    T items[Capacity];
+    alignas(64) std::atomic<size_t> head;   // written by the producer
+    alignas(64) std::atomic<size_t> tail;   // written by the consumer
+};
+
+#endif // SPSC_RING_H
@@ -23,6 +23,7 @@ public:
     virtual ~TextDisplay();
 
     void Render() override;
+    bool Record(RenderQueue& queue) override;
     void Clear() override;
 
     // Grid dimensions (default 68x26)
@@ -34,6 +35,7 @@ public:
     void Set(int row, int col, char c);
     void Set(int row, int col, char c, Color textColor, Color backColor);
     Cell* Get(int row, int col);
+    const Cell* Get(int row, int col) const;
     void Fill(char c);
     void FillRow(int row, char c);
     void ClearRow(int row);
@@ -65,9 +67,13 @@ public:
     float GetRowSpacing() const { return rowSpacing; }
     void SetCellSpacing(float colSpacing, float rowSpacing);
 
-    // Font
+    // Top-left corner of a cell, in window coordinates
+    Vector2 GetCellPosition(int row, int col) const;
+
+    // Font (path relative to the resources folder; loads in the background)
     bool LoadFont(const char* fontTexturePath);
     ScreenFont* GetFont() { return &screenFont; }
+    const ScreenFont* GetFont() const { return &screenFont; }
 
     // Update for cursor blinking
     void Update(float deltaTime);
@@ -0,0 +1,96 @@
+#ifndef TEXTURE_ATLAS_H
+#define TEXTURE_ATLAS_H
+
+#include "raylib.h"
+#include <vector>
+
+// Packs many small images into a few large shared textures ("pages"), so
+// that displays drawing them can batch into few draw calls.  Each image
+// becomes a region: a page texture plus a source rectangle within it.
+// Pages are packed with a skyline packer and kept on the CPU as well, so
+// they can be repacked (defragmented) when removals leave them sparse.
+// Repacking moves regions; users notice by checking GetGeneration().
+//
+// Main thread only.
+class TextureAtlas {
+public:
+    static const int kPageSize = 2048;
+    static const int kMaxPages = 4;
+    static const int kPadding = 1;      // empty pixels around each region
+
+    struct Region {
+        Texture2D texture;
+        Rectangle source;
+        int page;
+    };
+
+    // The shared atlas, used by the displays
+    static TextureAtlas& Shared();
+
+    TextureAtlas();
+    ~TextureAtlas();
+
+    // Copy an image (any format) into the atlas.  Returns a region id, or
+    // -1 if the image is too large or the atlas is full, in which case the
+    // caller should give it a texture of its own.
+    int Add(const Image& image);
+    void Remove(int region);
+    bool IsRegion(int region) const;
+
+    // Texture and rectangle of a region; valid until the generation changes
+    Region GetRegion(int region) const;
+    const Image& GetPageImage(int page) const { return pages[page].image; }
+
+    // Bumped whenever regions move or page textures are (re)created
+    int GetGeneration() const { return generation; }
+
+    // Upload changed parts of the pages; call once per frame before drawing
+    void Update();
+
+    // Repack all live regions into as few pages as possible.  If they don't
+    // all fit, nothing moves and this returns false, so region ids held by
+    // their owners stay valid either way.
+    bool Repack();
+
+    int GetPageCount() const { return (int)pages.size(); }
+    int GetRegionCount() const { return liveCount; }
+    float GetOccupancy() const;     // live region area / total page area
+
+    void Clear();
+
+private:
+    TextureAtlas(const TextureAtlas&) = delete;
+    TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+    struct SkylineNode {
+        int x, y, width;
+    };
+
+    struct Page {
+        Image image;                    // RGBA8 copy of the page contents
+        Texture2D texture;
+        std::vector<SkylineNode> skyline;
+        int dirtyTop, dirtyBottom;      // rows needing upload; empty if top >= bottom
+    };
+
+    struct Entry {
+        bool live;
+        int page;
+        int x, y, width, height;
+    };
+
+    bool AddPage();
+    void FreePages();
+    bool Pack(Page& page, int width, int height, int& outX, int& outY);
+    void Blit(Page& page, const unsigned char* pixels, int stride, int x, int y, int width, int height);
+    bool Place(int entry, const unsigned char* pixels, int stride);
+
+    std::vector<Page> pages;
+    std::vector<Entry> entries;
+    std::vector<int> freeEntries;
+    int liveCount;
+    long liveArea;
+    int generation;
+};
+
+#endif // TEXTURE_ATLAS_H
@@ -0,0 +1,41 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// A fixed set of worker threads pulling jobs from a shared FIFO queue
+class ThreadPool {
+public:
+    typedef std::function<void()> Job;
+
+    // threadCount <= 0 means one less than the number of hardware threads
+    // (leaving a core for the main thread), but at least one
+    explicit ThreadPool(int threadCount = 0);
+    ~ThreadPool();
+
+    // Queue a job to run on some worker thread
+    void Submit(Job job);
+
+    // Block until the queue is empty and no job is running
+    void WaitIdle();
+
+    int GetThreadCount() const { return (int)workers.size(); }
+
+private:
+    void WorkerLoop();
+
+    std::vector<std::thread> workers;
+    std::deque<Job> jobs;
+    std::mutex mutex;
+    std::condition_variable jobAvailable;
+    std::condition_variable idle;
+    int busyCount;
+    bool quitting;
+};
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,124 @@
+#ifndef TILE_DISPLAY_H
+#define TILE_DISPLAY_H
+
+#include "Display.h"
+#include "ResourceManager.h"
+#include <cstdint>
+#include <vector>
+
+class TextureAtlas;
+
+// Display of a (possibly huge) grid of tiles drawn from a tile set image.
+// The map is divided into square chunks, and each chunk is drawn from a
+// cached GPU mesh, so a frame costs one draw call per visible chunk no
+// matter how large the map is.  A chunk's mesh is rebuilt only when one of
+// its tiles changes or an animated tile in it advances a frame.  Meshes are
+// built on demand for chunks that come into view; the least recently seen
+// ones are dropped when too many are cached.
+//
+// Cells are addressed (column, row) with row 0 at the bottom, as in Mini Micro.
+// Scrolling uses the Display transform; only the chunks it brings into
+// view are drawn.
+class TileDisplay : public Display {
+public:
+    static const int kChunkSize = 32;           // tiles per chunk side
+    static const int kMaxCachedChunks = 96;
+    static const int kMaxAnimationFrames = 16;
+
+    TileDisplay();
+    virtual ~TileDisplay();
+
+    void Update(float deltaTime) override;
+    void Render() override;
+    void Clear() override;      // all cells empty
+
+    // Map size in cells; also clears
+    void SetExtent(int columns, int rows);
+    int GetColumns() const { return columns; }
+    int GetRows() const { return rows; }
+
+    // Size of each cell on screen, in pixels
+    void SetCellSize(float width, float height);
+
+    // Tile set: tiles of tileWidth x tileHeight pixels, numbered left to
+    // right, top to bottom.  The display does not own the texture.
+    void SetTileSet(Texture2D texture, int tileWidth, int tileHeight);
+    void SetTileSet(const TextureAtlas* atlas, int region, int tileWidth, int tileHeight);
+    void SetTileSet(const ResourceManager::TextureResource* resource, int tileWidth, int tileHeight);
+
+    // Tile index of a cell; -1 is empty
+    int GetCell(int column, int row) const;
+    void SetCell(int column, int row, int tile);
+    void SetCellTint(int column, int row, Color tint);
+
+    // Fill a rectangle of cells with one tile
+    void FillCells(int column, int row, int width, int height, int tile);
+
+    // Animate a tile: cells showing `tile` cycle through `frames`
+    void SetTileAnimation(int tile, const int* frames, int frameCount, float frameTime);
+    void ClearTileAnimations();
+
+    int GetLastDrawnChunkCount() const { return lastDrawnChunks; }
+    int GetLastRebuiltChunkCount() const { return lastRebuiltChunks; }
+
+private:
+    struct Chunk {
+        Mesh mesh;                  // GPU buffers only; built from shared scratch arrays
+        bool loaded;
+        bool dirty;
+        int animatedCells;          // counted when built
+        unsigned int lastUsed;      // frame it was last drawn
+    };
+
+    struct Animation {
+        int tile;
+        int frames[kMaxAnimationFrames];
+        int frameCount;
+        float frameTime;
+        int currentFrame;
+    };
+
+    int ChunkIndex(int column, int row) const {
+        return (row / kChunkSize) * chunkColumns + column / kChunkSize;
+    }
+    void MarkChunkDirty(int column, int row);
+    void MarkAllChunksDirty();
+    int DisplayedTile(int tile) const;
+    void BuildChunk(int index);
+    void UnloadChunk(Chunk& chunk);
+    void EvictChunks();
+    void RefreshTileSet();
+
+    int columns, rows;
+    int chunkColumns, chunkRows;
+    float cellWidth, cellHeight;
+    std::vector<int> tiles;             // [row * columns + column]
+    std::vector<Color> tints;
+    std::vector<Chunk> chunks;
+    int loadedChunks;
+    unsigned int frameCounter;
+
+    Texture2D tileSet;
+    Rectangle tileSetSource;            // area of tileSet holding the tiles
+    const TextureAtlas* atlas;
+    int atlasRegion;
+    int atlasGeneration;
+    int tileWidth, tileHeight;
+    Material material;
+    bool materialLoaded;
+
+    std::vector<Animation> animations;
+    std::vector<int> animationOfTile;   // index into animations, or -1
+    float animationTime;
+
+    // Mesh data for one chunk, reused for every build
+    std::vector<float> scratchVertices;
+    std::vector<float> scratchTexcoords;
+    std::vector<unsigned char> scratchColors;
+    std::vector<unsigned short> scratchIndices;
+
+    int lastDrawnChunks;
+    int lastRebuiltChunks;
+};
+
+#endif // TILE_DISPLAY_H
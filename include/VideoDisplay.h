@@ -0,0 +1,59 @@
+#ifndef VIDEO_DISPLAY_H
+#define VIDEO_DISPLAY_H
+
+#include "Display.h"
+#include "VideoStream.h"
+
+class MusicStream;
+
+// Display that plays a QOI-frame video (see VideoStream), scaled to fit the
+// screen.  Frames are decoded on the stream's worker thread; Update only
+// picks which decoded frame is due, and Render uploads it, so neither ever
+// waits on decoding.  Uploads alternate between two textures, so a new
+// frame never overwrites the texture the GPU may still be drawing from.
+//
+// The video clock is its own elapsed play time, or the position of a
+// MusicStream it is synced to.  Frames that fall behind are dropped.
+class VideoDisplay : public Display {
+public:
+    VideoDisplay();
+    virtual ~VideoDisplay();
+
+    void Update(float deltaTime) override;
+    void Render() override;
+    void Clear() override;      // closes the video
+
+    bool Open(const char* path);
+    void Close();
+    bool IsOpen() const { return stream.IsOpen(); }
+
+    void Play() { playing = true; }
+    void Pause() { playing = false; }
+    bool IsPlaying() const { return playing && !ended; }
+    void SetLoop(bool loop) { stream.SetLoop(loop); }
+
+    // Follow an audio stream's position instead of the frame clock (null to stop)
+    void SyncTo(const MusicStream* audio) { this->audio = audio; }
+
+    double GetTime() const { return time; }
+    int GetDroppedFrameCount() const { return droppedFrames; }
+    const VideoStream& GetStream() const { return stream; }
+
+private:
+    void UnloadTextures();
+
+    VideoStream stream;
+    const MusicStream* audio;
+    bool playing;
+    bool ended;
+    double time;                // seconds since Open, across loops (audio position if synced)
+    int64_t dueSequence;        // latest frame whose time has come
+
+    Texture2D textures[2];
+    int front;                  // texture holding the frame on screen
+    bool texturesLoaded;
+    int64_t uploadedSequence;   // frame in textures[front], or -1
+    int droppedFrames;
+};
+
+#endif // VIDEO_DISPLAY_H
@@ -0,0 +1,97 @@
+#ifndef VIDEO_STREAM_H
+#define VIDEO_STREAM_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+// Streaming decoder for QOI-frame video files.  A background thread reads
+// and decodes frames into a small ring of preallocated RGBA8 buffers; the
+// main thread takes them from the ring without ever waiting on the file or
+// the decoder.  Needs no graphics context, so it can run headless.
+//
+// File format (all integers little-endian):
+//   header:  "QOIV", uint32 version (1), uint32 width, uint32 height,
+//            uint32 fps numerator, uint32 fps denominator, uint32 frame count
+//   frames:  uint32 byte size, then one QOI image of width x height
+class VideoStream {
+public:
+    static const int kRingSlots = 4;    // decoded frames buffered ahead
+
+    struct Frame {
+        std::vector<unsigned char> pixels;  // width * height * 4, rows top-down
+        int64_t sequence;                   // frames delivered since Open, counting loops
+        int index;                          // frame number within the file
+    };
+
+    VideoStream();
+    ~VideoStream();
+
+    bool Open(const char* path);
+    void Close();
+    bool IsOpen() const { return file != nullptr; }
+
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+    double GetFrameRate() const { return frameRate; }
+    int GetFrameCount() const { return frameCount; }
+    double GetDuration() const { return frameRate > 0 ? frameCount / frameRate : 0; }
+
+    // Start over from the first frame after the end
+    void SetLoop(bool loop) { looping = loop; }
+
+    // Consumer side: the oldest decoded frame (or the one `ahead` places
+    // after it), or null if not ready yet; valid until popped
+    const Frame* PeekFrame(int ahead = 0) const;
+    void PopFrame();
+
+    // True once the decoder hit the end (or a bad frame)
+    bool IsDecoderDone() const { return finished; }
+
+    // True once the decoder is done and every frame was taken
+    bool IsFinished() const;
+
+    // Decode statistics (for profiling and headless checks)
+    int64_t GetDecodedFrameCount() const { return decodedFrames; }
+    double GetAverageDecodeMs() const;
+
+    // 64-bit FNV-1a hash of a frame's pixels
+    static uint64_t HashFrame(const Frame& frame);
+
+private:
+    VideoStream(const VideoStream&) = delete;
+    VideoStream& operator=(const VideoStream&) = delete;
+
+    bool ParseHeader();
+    void Rewind();
+    bool DecodeNext(Frame& frame);
+    void DecoderLoop();
+
+    FILE* file;
+    std::thread decoder;
+    std::atomic<bool> quit;
+
+    int width, height;
+    double frameRate;
+    int frameCount;
+    long firstFrameOffset;
+
+    // Decoder thread state
+    int nextIndex;
+    int64_t nextSequence;
+    std::vector<unsigned char> compressed;
+
+    // Single-producer, single-consumer ring of frames
+    Frame slots[kRingSlots];
+    std::atomic<size_t> head;           // next slot to fill
+    std::atomic<size_t> tail;           // oldest filled slot
+
+    std::atomic<bool> looping;
+    std::atomic<bool> finished;
+    std::atomic<int64_t> decodedFrames;
+    std::atomic<int64_t> decodeMicros;
+};
+
+#endif // VIDEO_STREAM_H
@@ -0,0 +1,41 @@
+#ifndef VIRTUAL_FILE_SYSTEM_H
+#define VIRTUAL_FILE_SYSTEM_H
+
+#include "MiniDisk.h"
+#include <string>
+#include <vector>
+
+// Mini Micro's file system: minidisks mounted at top-level points such as
+// "/usr" and "/sys".  Resolving a path picks its disk by its first path
+// component, so every lookup is a short prefix check plus the disk's own
+// hash lookup.
+class VirtualFileSystem {
+public:
+    VirtualFileSystem();
+    ~VirtualFileSystem();
+
+    // Mount a minidisk at a point like "/usr"; replaces any disk there,
+    // unless that disk's pending writes can't be flushed
+    bool Mount(const char* mountPoint, const char* diskPath, bool writable);
+    bool Eject(const char* mountPoint);     // false if the disk stays mounted (see MiniDisk::Eject)
+    void EjectAll();
+
+    // The disk holding an absolute path, and the path within it; null if
+    // no disk is mounted there
+    MiniDisk* Resolve(const std::string& path, std::string& outDiskPath);
+
+    // Call once per frame (idle write-back)
+    void Update(float deltaTime);
+
+private:
+    VirtualFileSystem(const VirtualFileSystem&) = delete;
+    VirtualFileSystem& operator=(const VirtualFileSystem&) = delete;
+
+    struct MountPoint {
+        std::string name;       // without the leading '/'
+        MiniDisk* disk;
+    };
+    std::vector<MountPoint> mounts;
+};
+
+#endif // VIRTUAL_FILE_SYSTEM_H
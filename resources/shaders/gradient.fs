@@ -0,0 +1,33 @@
+#version 330
+
+// Input vertex attributes (from vertex shader)
+in vec2 fragTexCoord;       // screen position in pixels, bottom-up
+in vec4 fragColor;
+
+// Gradient axis and color stops
+uniform vec2 startPoint;
+uniform vec2 endPoint;
+uniform int stopCount;
+uniform vec4 stopColors[16];
+uniform float stopPositions[16];
+
+// Output fragment color
+out vec4 finalColor;
+
+void main()
+{
+    // Project onto the axis: 0 at the start point, 1 at the end point
+    vec2 axis = endPoint - startPoint;
+    float t = dot(fragTexCoord - startPoint, axis) / max(dot(axis, axis), 0.000001);
+    t = clamp(t, 0.0, 1.0);
+
+    // Interpolate within the last stop at or before t
+    vec4 color = stopColors[0];
+    for (int i = 1; i < 16; i++) {
+        if (i >= stopCount) break;
+        float p0 = stopPositions[i - 1];
+        float p1 = stopPositions[i];
+        if (t >= p0) color = mix(stopColors[i - 1], stopColors[i], clamp((t - p0) / max(p1 - p0, 0.000001), 0.0, 1.0));
+    }
+    finalColor = color;
+}
@@ -0,0 +1,65 @@
+#version 330
+
+// Input vertex attributes (from vertex shader)
+in vec2 fragTexCoord;
+in vec4 fragColor;
+
+// Canvas (texture0) and bezel overlay, both flipped render textures
+uniform sampler2D texture0;
+uniform sampler2D overlay;
+uniform int useOverlay;
+
+uniform vec2 canvasSize;        // canvas size in pixels
+uniform float outputScale;      // window pixels per canvas pixel
+uniform vec4 screenRect;        // machine screen in the canvas: left, top, width, height
+uniform float scanlines;        // 0 to 1
+uniform float curvature;        // 0 to 1
+
+// Output fragment color
+out vec4 finalColor;
+
+// Sample the canvas at a canvas pixel position (y down).  Sharp bilinear:
+// texels stay solid, and only the one-output-pixel seams between them are
+// blended, so non-integer scales neither blur nor shimmer.
+vec4 SampleCanvas(vec2 pos)
+{
+    float prescale = max(floor(outputScale), 1.0);
+    vec2 texel = floor(pos);
+    vec2 offset = fract(pos) - 0.5;
+    vec2 region = vec2(0.5 - 0.5 / prescale);
+    vec2 f = (offset - clamp(offset, -region, region)) * prescale + 0.5;
+    vec2 uv = (texel + f) / canvasSize;
+    return texture(texture0, vec2(uv.x, 1.0 - uv.y));
+}
+
+void main()
+{
+    vec2 pos = vec2(fragTexCoord.x, 1.0 - fragTexCoord.y) * canvasSize;
+    vec4 color;
+
+    vec2 halfSize = screenRect.zw * 0.5;
+    vec2 center = screenRect.xy + halfSize;
+    vec2 p = (pos - center) / halfSize;
+    if (abs(p.x) <= 1.0 && abs(p.y) <= 1.0) {
+        // Barrel distortion toward the edges of the glass
+        p *= 1.0 + curvature * 0.25 * (p.yx * p.yx);
+        if (abs(p.x) > 1.0 || abs(p.y) > 1.0) {
+            color = vec4(0.0, 0.0, 0.0, 1.0);
+        } else {
+            vec2 screenPos = center + p * halfSize;
+            color = SampleCanvas(screenPos);
+
+            // Darken between the screen's pixel rows
+            float row = fract(screenPos.y - screenRect.y);
+            color.rgb *= 1.0 - scanlines * 0.5 * (1.0 - sin(row * 3.14159265));
+        }
+    } else {
+        color = SampleCanvas(pos);
+    }
+
+    if (useOverlay != 0) {
+        vec4 frame = texture(overlay, fragTexCoord);
+        color.rgb = mix(color.rgb, frame.rgb, frame.a);
+    }
+    finalColor = vec4(color.rgb, 1.0);
+}
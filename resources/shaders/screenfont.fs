@@ -2,16 +2,13 @@
 
 // Input vertex attributes (from vertex shader)
 in vec2 fragTexCoord;
-in vec4 fragColor;
+in vec4 fragColor;         // foreground color
+in vec4 fragBackColor;
 
 // Input uniform values
 uniform sampler2D texture0;
 uniform vec4 colDiffuse;
 
-// Custom uniforms
-uniform vec4 foreColor;
-uniform vec4 backColor;
-
 // Output fragment color
 out vec4 finalColor;
 
@@ -24,5 +21,5 @@ void main()
 	float mask = texelColor.a;
 
     // Switch (or interpolate) between background and foreground based on mask
-    finalColor = mix(backColor, foreColor, mask);
+    finalColor = mix(fragBackColor, fragColor, mask);
 }
@@ -12,6 +12,7 @@ uniform mat4 mvp;
 // Output vertex attributes (to fragment shader)
 out vec2 fragTexCoord;
 out vec4 fragColor;
+out vec4 fragBackColor;
 
 void main()
 {
@@ -19,6 +20,11 @@ void main()
     fragTexCoord = vertexTexCoord;
     fragColor = vertexColor;
 
+    // Background color arrives packed in the normal as (r*256 + g, b*256 + a)
+    vec2 high = floor(vertexNormal.xy / 256.0);
+    vec2 low = vertexNormal.xy - high * 256.0;
+    fragBackColor = vec4(high.x, low.x, high.y, low.y) / 255.0;
+
     // Calculate final vertex position
     gl_Position = mvp * vec4(vertexPosition, 1.0);
 }
@@ -0,0 +1,515 @@
+#include "AudioMixer.h"
+#include "MusicStream.h"
+#include "ResourcePath.h"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MIXER_SSE 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MIXER_NEON 1
+#endif
+
+AudioMixer* AudioMixer::activeMixer = nullptr;
+
+//--------------------------------------------------------------------------------
+// Mixing kernels
+
+// out (interleaved stereo) += in (mono) * (gainL, gainR)
+static void MixMonoToStereo(float* out, const float* in, float gainL, float gainR, int frames) {
+    int i = 0;
+#if defined(MIXER_SSE)
+    __m128 gain = _mm_setr_ps(gainL, gainR, gainL, gainR);
+    for (; i + 4 <= frames; i += 4) {
+        __m128 m = _mm_loadu_ps(in + i);
+        __m128 lo = _mm_unpacklo_ps(m, m);      // m0 m0 m1 m1
+        __m128 hi = _mm_unpackhi_ps(m, m);      // m2 m2 m3 m3
+        float* o = out + i * 2;
+        _mm_storeu_ps(o, _mm_add_ps(_mm_loadu_ps(o), _mm_mul_ps(lo, gain)));
+        _mm_storeu_ps(o + 4, _mm_add_ps(_mm_loadu_ps(o + 4), _mm_mul_ps(hi, gain)));
+    }
+#elif defined(MIXER_NEON)
+    float gains[4] = { gainL, gainR, gainL, gainR };
+    float32x4_t gain = vld1q_f32(gains);
+    for (; i + 4 <= frames; i += 4) {
+        float32x4x2_t m = vzipq_f32(vld1q_f32(in + i), vld1q_f32(in + i));
+        float* o = out + i * 2;
+        vst1q_f32(o, vmlaq_f32(vld1q_f32(o), m.val[0], gain));
+        vst1q_f32(o + 4, vmlaq_f32(vld1q_f32(o + 4), m.val[1], gain));
+    }
+#endif
+    for (; i < frames; i++) {
+        out[i * 2] += in[i] * gainL;
+        out[i * 2 + 1] += in[i] * gainR;
+    }
+}
+
+// out (interleaved stereo) += in (interleaved stereo) * (gainL, gainR)
+static void MixStereo(float* out, const float* in, float gainL, float gainR, int frames) {
+    int i = 0;
+    int count = frames * 2;
+#if defined(MIXER_SSE)
+    __m128 gain = _mm_setr_ps(gainL, gainR, gainL, gainR);
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(out + i),
+                                          _mm_mul_ps(_mm_loadu_ps(in + i), gain)));
+    }
+#elif defined(MIXER_NEON)
+    float gains[4] = { gainL, gainR, gainL, gainR };
+    float32x4_t gain = vld1q_f32(gains);
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(out + i, vmlaq_f32(vld1q_f32(out + i), vld1q_f32(in + i), gain));
+    }
+#endif
+    for (; i < count; i += 2) {
+        out[i] += in[i] * gainL;
+        out[i + 1] += in[i + 1] * gainR;
+    }
+}
+
+// Hard-limit to [-1, 1]
+static void ClampSamples(float* data, int count) {
+    int i = 0;
+#if defined(MIXER_SSE)
+    __m128 lo = _mm_set1_ps(-1.0f);
+    __m128 hi = _mm_set1_ps(1.0f);
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(data + i, _mm_min_ps(_mm_max_ps(_mm_loadu_ps(data + i), lo), hi));
+    }
+#elif defined(MIXER_NEON)
+    float32x4_t lo = vdupq_n_f32(-1.0f);
+    float32x4_t hi = vdupq_n_f32(1.0f);
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(data + i, vminq_f32(vmaxq_f32(vld1q_f32(data + i), lo), hi));
+    }
+#endif
+    for (; i < count; i++) {
+        if (data[i] < -1.0f) data[i] = -1.0f;
+        else if (data[i] > 1.0f) data[i] = 1.0f;
+    }
+}
+
+//--------------------------------------------------------------------------------
+// Main-thread API
+
+AudioMixer::AudioMixer()
+    : postedCount(0), appliedCount(0), sampleCount(0), nextHandle(1), masterVolume(1.0f),
+      activeVoices(0), stream(AudioStream{}), started(false) {
+    memset(samples, 0, sizeof(samples));
+    for (int i = 0; i < kMaxStreams; i++) streams[i] = nullptr;
+    for (int i = 0; i < kMaxVoices; i++) voices[i] = Voice();
+}
+
+AudioMixer::~AudioMixer() {
+    Stop();
+    for (int i = 0; i < sampleCount; i++) UnloadWaveSamples(samples[i].frames);
+}
+
+bool AudioMixer::Start() {
+    if (started) return true;
+    if (activeMixer) return false;
+
+    // The buffer size is a global default for new streams, and Raylib has no
+    // getter; nothing else sets it, so put back Raylib's own default (0:
+    // chosen from the device rate) once our stream exists
+    SetAudioStreamBufferSizeDefault(512);   // ~12 ms at 44.1 kHz
+    stream = LoadAudioStream(kSampleRate, 32, kChannels);
+    SetAudioStreamBufferSizeDefault(0);
+    if (!stream.buffer) return false;
+    activeMixer = this;
+    SetAudioStreamCallback(stream, &AudioMixer::AudioCallback);
+    PlayAudioStream(stream);
+    started = true;
+    return true;
+}
+
+void AudioMixer::Stop() {
+    if (!started) return;
+    StopAudioStream(stream);
+    UnloadAudioStream(stream);
+    activeMixer = nullptr;
+    started = false;
+}
+
+void AudioMixer::AudioCallback(void* buffer, unsigned int frames) {
+    if (activeMixer) activeMixer->Render((float*)buffer, (int)frames);
+    else memset(buffer, 0, frames * kChannels * sizeof(float));
+}
+
+int AudioMixer::LoadSample(const char* relativePath) {
+    if (sampleCount >= kMaxSamples) return -1;
+
+    ResourceData data;
+    if (!data.Load(relativePath)) return -1;
+    Wave wave = LoadWaveFromMemory(GetFileExtension(relativePath), data.GetData(), (int)data.GetSize());
+    if (!wave.data) return -1;
+    WaveFormat(&wave, kSampleRate, 32, kChannels);
+
+    // Written before any command refers to it; the command queue publishes it
+    Sample& sample = samples[sampleCount];
+    sample.frames = LoadWaveSamples(wave);
+    sample.frameCount = (int)wave.frameCount;
+    UnloadWave(wave);
+    return sampleCount++;
+}
+
+bool AudioMixer::Post(const Command& command) {
+    if (commands.Push(command)) {
+        postedCount++;
+        return true;
+    }
+    TraceLog(LOG_WARNING, "AudioMixer: command queue full");
+    return false;
+}
+
+AudioMixer::VoiceHandle AudioMixer::PlaySample(int sample, float volume, float pan, float speed) {
+    if (sample < 0 || sample >= sampleCount) return 0;
+    Command command = Command();
+    command.type = kCmdPlaySample;
+    command.handle = nextHandle++;
+    if (nextHandle == 0) nextHandle = 1;
+    command.sample = sample;
+    command.value = speed;
+    command.volume = volume;
+    command.pan = pan;
+    command.envelope = Envelope(0.0f, 0.0f, 1.0f, 0.01f);
+    return Post(command) ? command.handle : 0;
+}
+
+AudioMixer::VoiceHandle AudioMixer::PlayTone(Waveform waveform, float frequency, float duration,
+                                             float volume, float pan, Envelope envelope) {
+    Command command = Command();
+    command.type = kCmdPlayTone;
+    command.handle = nextHandle++;
+    if (nextHandle == 0) nextHandle = 1;
+    command.waveform = waveform;
+    command.value = frequency;
+    command.volume = volume;
+    command.pan = pan;
+    command.duration = duration;
+    command.envelope = envelope;
+    return Post(command) ? command.handle : 0;
+}
+
+void AudioMixer::SetVolume(VoiceHandle voice, float volume) {
+    Command command = Command();
+    command.type = kCmdSetVolume;
+    command.handle = voice;
+    command.value = volume;
+    Post(command);
+}
+
+void AudioMixer::SetPan(VoiceHandle voice, float pan) {
+    Command command = Command();
+    command.type = kCmdSetPan;
+    command.handle = voice;
+    command.value = pan;
+    Post(command);
+}
+
+void AudioMixer::SetFrequency(VoiceHandle voice, float frequency) {
+    Command command = Command();
+    command.type = kCmdSetFrequency;
+    command.handle = voice;
+    command.value = frequency;
+    Post(command);
+}
+
+void AudioMixer::StopVoice(VoiceHandle voice) {
+    Command command = Command();
+    command.type = kCmdStop;
+    command.handle = voice;
+    Post(command);
+}
+
+void AudioMixer::StopAll() {
+    Command command = Command();
+    command.type = kCmdStopAll;
+    Post(command);
+}
+
+void AudioMixer::SetMasterVolume(float volume) {
+    Command command = Command();
+    command.type = kCmdMasterVolume;
+    command.value = volume;
+    Post(command);
+}
+
+void AudioMixer::AttachStream(MusicStream* stream) {
+    Command command = Command();
+    command.type = kCmdAttachStream;
+    command.stream = stream;
+    Post(command);
+}
+
+void AudioMixer::DetachStream(MusicStream* stream) {
+    Command command = Command();
+    command.type = kCmdDetachStream;
+    command.stream = stream;
+    while (!Post(command)) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    // When not started, the next Render applies it before touching any stream
+    if (!started) return;
+    while ((int32_t)(appliedCount.load(std::memory_order_acquire) - postedCount) < 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+//--------------------------------------------------------------------------------
+// Audio-thread side
+
+void AudioMixer::UpdateGains(Voice& voice) {
+    // Constant-power pan: -1 is full left, 1 is full right
+    float pan = voice.pan < -1.0f ? -1.0f : (voice.pan > 1.0f ? 1.0f : voice.pan);
+    float angle = (pan + 1.0f) * 0.25f * 3.14159265f;
+    voice.gainL = voice.volume * cosf(angle) * 1.41421356f;
+    voice.gainR = voice.volume * sinf(angle) * 1.41421356f;
+}
+
+AudioMixer::Voice* AudioMixer::FindVoice(VoiceHandle handle) {
+    if (handle == 0) return nullptr;
+    for (int i = 0; i < kMaxVoices; i++) {
+        if (voices[i].handle == handle) return &voices[i];
+    }
+    return nullptr;
+}
+
+void AudioMixer::StartVoice(const Command& command) {
+    // Take a free voice, or steal the one nearest to finishing
+    Voice* voice = nullptr;
+    for (int i = 0; i < kMaxVoices && !voice; i++) {
+        if (voices[i].handle == 0) voice = &voices[i];
+    }
+    if (!voice) {
+        voice = &voices[0];
+        for (int i = 1; i < kMaxVoices; i++) {
+            if (voices[i].stage > voice->stage
+                || (voices[i].stage == voice->stage && voices[i].level < voice->level)) {
+                voice = &voices[i];
+            }
+        }
+    }
+
+    *voice = Voice();
+    voice->handle = command.handle;
+    voice->volume = command.volume;
+    voice->pan = command.pan;
+    voice->envelope = command.envelope;
+    voice->stage = kAttack;
+    UpdateGains(*voice);
+
+    if (command.type == kCmdPlaySample) {
+        voice->isTone = false;
+        voice->sample = &samples[command.sample];
+        voice->speed = command.value > 0 ? command.value : 1.0f;
+        voice->timeLeft = 1e30f;    // until the sample ends
+    } else {
+        voice->isTone = true;
+        voice->waveform = command.waveform;
+        voice->phaseStep = command.value / kSampleRate;
+        voice->noiseState = command.handle * 2654435761u + 1;
+        voice->timeLeft = command.duration;
+    }
+}
+
+void AudioMixer::ApplyCommands() {
+    Command command;
+    uint32_t applied = 0;
+    while (commands.Pop(command)) {
+        applied++;
+        if (command.type == kCmdPlaySample || command.type == kCmdPlayTone) {
+            StartVoice(command);
+            continue;
+        }
+        if (command.type == kCmdAttachStream || command.type == kCmdDetachStream) {
+            for (int i = 0; i < kMaxStreams; i++) {
+                if (streams[i] == command.stream) streams[i] = nullptr;
+            }
+            for (int i = 0; i < kMaxStreams && command.type == kCmdAttachStream; i++) {
+                if (!streams[i]) {
+                    streams[i] = command.stream;
+                    break;
+                }
+            }
+            continue;
+        }
+        if (command.type == kCmdStopAll) {
+            for (int i = 0; i < kMaxVoices; i++) {
+                if (voices[i].handle && voices[i].stage < kRelease) voices[i].timeLeft = 0;
+            }
+            continue;
+        }
+        if (command.type == kCmdMasterVolume) {
+            masterVolume = command.value;
+            continue;
+        }
+
+        Voice* voice = FindVoice(command.handle);
+        if (!voice) continue;
+        switch (command.type) {
+        case kCmdSetVolume:
+            voice->volume = command.value;
+            UpdateGains(*voice);
+            break;
+        case kCmdSetPan:
+            voice->pan = command.value;
+            UpdateGains(*voice);
+            break;
+        case kCmdSetFrequency:
+            if (voice->isTone) voice->phaseStep = command.value / kSampleRate;
+            else voice->speed = command.value;
+            break;
+        case kCmdStop:
+            voice->timeLeft = 0;
+            break;
+        default:
+            break;
+        }
+    }
+    if (applied) appliedCount.fetch_add(applied, std::memory_order_release);
+}
+
+float AudioMixer::StepEnvelope(Voice& voice) {
+    const float dt = 1.0f / kSampleRate;
+    const Envelope& env = voice.envelope;
+    voice.timeLeft -= dt;
+    if (voice.timeLeft <= 0 && voice.stage < kRelease) {
+        voice.stage = kRelease;
+        voice.releaseStep = env.release > 0 ? voice.level * dt / env.release : 1.0f;
+    }
+
+    switch (voice.stage) {
+    case kAttack:
+        voice.level = env.attack > 0 ? voice.level + dt / env.attack : 1.0f;
+        if (voice.level >= 1.0f) {
+            voice.level = 1.0f;
+            voice.stage = kDecay;
+        }
+        break;
+    case kDecay:
+        voice.level = env.decay > 0 ? voice.level - dt * (1.0f - env.sustain) / env.decay : env.sustain;
+        if (voice.level <= env.sustain) {
+            voice.level = env.sustain;
+            voice.stage = kSustain;
+        }
+        break;
+    case kRelease:
+        voice.level -= voice.releaseStep;
+        if (voice.level <= 0) {
+            voice.level = 0;
+            voice.stage = kDone;
+        }
+        break;
+    default:
+        break;
+    }
+    return voice.level;
+}
+
+void AudioMixer::RenderToneVoice(Voice& voice, float* mono, int frames) {
+    for (int i = 0; i < frames; i++) {
+        float p = voice.phase;
+        float value;
+        switch (voice.waveform) {
+        case kSine:     value = sinf(p * 6.28318531f);  break;
+        case kSquare:   value = p < 0.5f ? 1.0f : -1.0f;  break;
+        case kTriangle: value = 1.0f - 4.0f * fabsf(p - 0.5f);  break;
+        case kSawtooth: value = 2.0f * p - 1.0f;  break;
+        default:        value = voice.noiseValue;  break;
+        }
+
+        p += voice.phaseStep;
+        if (p >= 1.0f) {
+            p -= floorf(p);
+            if (voice.waveform == kNoise) {
+                // xorshift32; new random level each cycle
+                uint32_t x = voice.noiseState;
+                x ^= x << 13;
+                x ^= x >> 17;
+                x ^= x << 5;
+                voice.noiseState = x;
+                voice.noiseValue = (float)(x >> 8) * (2.0f / 16777216.0f) - 1.0f;
+            }
+        }
+        voice.phase = p;
+
+        mono[i] = value * StepEnvelope(voice);
+        if (voice.stage == kDone) {
+            for (i++; i < frames; i++) mono[i] = 0;
+            break;
+        }
+    }
+}
+
+int AudioMixer::RenderSampleVoice(Voice& voice, float* stereo, int frames) {
+    const Sample* sample = voice.sample;
+    int i = 0;
+    for (; i < frames; i++) {
+        int index = (int)voice.position;
+        if (index + 1 >= sample->frameCount) {
+            voice.stage = kDone;
+            break;
+        }
+        // Linear interpolation between frames, for speeds other than 1
+        float t = (float)(voice.position - index);
+        const float* a = sample->frames + index * 2;
+        float level = StepEnvelope(voice);
+        stereo[i * 2] = (a[0] + (a[2] - a[0]) * t) * level;
+        stereo[i * 2 + 1] = (a[1] + (a[3] - a[1]) * t) * level;
+        voice.position += voice.speed;
+        if (voice.stage == kDone) {
+            i++;
+            break;
+        }
+    }
+    return i;
+}
+
+void AudioMixer::Render(float* out, int frames) {
+    ApplyCommands();
+    memset(out, 0, (size_t)frames * kChannels * sizeof(float));
+
+    int active = 0;
+    for (int v = 0; v < kMaxVoices; v++) {
+        Voice& voice = voices[v];
+        if (!voice.handle) continue;
+
+        float gainL = voice.gainL * masterVolume;
+        float gainR = voice.gainR * masterVolume;
+        for (int offset = 0; offset < frames && voice.stage != kDone; offset += kBlockFrames) {
+            int n = frames - offset < kBlockFrames ? frames - offset : kBlockFrames;
+            float* dest = out + offset * kChannels;
+            if (voice.isTone) {
+                RenderToneVoice(voice, monoBlock, n);
+                MixMonoToStereo(dest, monoBlock, gainL, gainR, n);
+            } else {
+                int rendered = RenderSampleVoice(voice, stereoBlock, n);
+                MixStereo(dest, stereoBlock, gainL, gainR, rendered);
+            }
+        }
+
+        if (voice.stage == kDone) voice.handle = 0;
+        else active++;
+    }
+
+    // Streams deliver stereo at the mixer rate; a short read is an underrun
+    // (or a paused stream), which just plays as silence
+    for (int s = 0; s < kMaxStreams; s++) {
+        MusicStream* music = streams[s];
+        if (!music) continue;
+        float gain = music->GetVolume() * masterVolume;
+        for (int offset = 0; offset < frames; offset += kBlockFrames) {
+            int n = frames - offset < kBlockFrames ? frames - offset : kBlockFrames;
+            int got = music->Read(stereoBlock, n);
+            MixStereo(out + offset * kChannels, stereoBlock, gain, gain, got);
+            if (got < n) break;
+        }
+    }
+
+    ClampSamples(out, frames * kChannels);
+    activeVoices.store(active, std::memory_order_relaxed);
+}
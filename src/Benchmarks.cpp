@@ -0,0 +1,890 @@
+#include "Benchmarks.h"
+#include "FrameCapture.h"
+#include "ImageCache.h"
+#include "IntrinsicBinding.h"
+#include "LineReader.h"
+#include "Machine.h"
+#include "MachineIntrinsics.h"
+#include "MusicStream.h"
+#include "PixelDisplay.h"
+#include "ResourcePath.h"
+#include "ScreenPresenter.h"
+#include "SpriteDisplay.h"
+#include "TextureAtlas.h"
+#include "TileDisplay.h"
+#include "raylib.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    double NowMs() {
+        return std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Keeps results alive so the timed loops aren't optimized away
+    volatile double sink;
+
+    // Deterministic pseudo-random numbers, so every run does the same work
+    uint32_t randomState = 1;
+    int RandomInt(int limit) {
+        randomState = randomState * 1664525u + 1013904223u;
+        return (int)((randomState >> 8) % (uint32_t)limit);
+    }
+
+    // Average time of one call to op, in microseconds
+    template <typename Op>
+    double MicrosPerCall(int calls, Op op) {
+        double start = NowMs();
+        for (int i = 0; i < calls; i++) op(i);
+        return (NowMs() - start) * 1000.0 / calls;
+    }
+
+    //--------------------------------------------------------------------------------
+    // dispatch: intrinsic call overhead
+
+    double BenchAdd(double a, double b) { return a + b; }
+    int BenchClamp(int value, int low, int high) { return value < low ? low : (value > high ? high : value); }
+    Color BenchTint(Color c) { return Color{ c.g, c.b, c.r, c.a }; }
+
+    constexpr const char* kBenchAddParams[] = { "a", "b" };
+    constexpr const char* kBenchClampParams[] = { "value", "low", "high" };
+    constexpr const char* kBenchTintParams[] = { "color" };
+
+    constexpr IntrinsicDef kBenchIntrinsics[] = {
+        BindIntrinsic<&BenchAdd>("bench.add", kBenchAddParams),
+        BindIntrinsic<&BenchClamp>("bench.clamp", kBenchClampParams),
+        BindIntrinsic<&BenchTint>("bench.tint", kBenchTintParams),
+    };
+    const int kBenchIntrinsicCount = (int)(sizeof(kBenchIntrinsics) / sizeof(kBenchIntrinsics[0]));
+
+    int BenchDispatch() {
+        // The same calls made directly, through the table's thunks, and
+        // through a by-name lookup per call (what the table avoids)
+        const int kCalls = 5000000;
+        ScriptValue addArgs[2] = { ScriptValue(1.5), ScriptValue(2.25) };
+        ScriptValue clampArgs[3] = { ScriptValue(150.0), ScriptValue(0.0), ScriptValue(100.0) };
+        const IntrinsicDef* add = FindIntrinsic(kBenchIntrinsics, kBenchIntrinsicCount, "bench.add");
+        const IntrinsicDef* clamp = FindIntrinsic(kBenchIntrinsics, kBenchIntrinsicCount, "bench.clamp");
+
+        double start = NowMs();
+        double total = 0;
+        for (int i = 0; i < kCalls; i++) {
+            total += BenchAdd(addArgs[0].DoubleValue(), addArgs[1].DoubleValue());
+            total += BenchClamp((int)clampArgs[0].DoubleValue(), (int)clampArgs[1].DoubleValue(),
+                                (int)clampArgs[2].DoubleValue());
+        }
+        double directMs = NowMs() - start;
+        sink = total;
+
+        start = NowMs();
+        total = 0;
+        for (int i = 0; i < kCalls; i++) {
+            total += add->invoke(addArgs).DoubleValue();
+            total += clamp->invoke(clampArgs).DoubleValue();
+        }
+        double thunkMs = NowMs() - start;
+        bool ok = total == sink;
+        sink = total;
+
+        start = NowMs();
+        total = 0;
+        for (int i = 0; i < kCalls; i++) {
+            total += FindIntrinsic(kBenchIntrinsics, kBenchIntrinsicCount, "bench.add")->invoke(addArgs).DoubleValue();
+            total += FindIntrinsic(kBenchIntrinsics, kBenchIntrinsicCount, "bench.clamp")->invoke(clampArgs).DoubleValue();
+        }
+        double lookupMs = NowMs() - start;
+        sink = total;
+
+        // A conversion through a string argument (colors are "#RRGGBB")
+        ScriptValue tintArgs[1] = { ScriptValue("#203040") };
+        const IntrinsicDef* tint = FindIntrinsic(kBenchIntrinsics, kBenchIntrinsicCount, "bench.tint");
+        start = NowMs();
+        for (int i = 0; i < kCalls / 10; i++) tint->invoke(tintArgs);
+        double tintMs = NowMs() - start;
+
+        double calls = 2.0 * kCalls;
+        printf("dispatch: %d calls each way\n", 2 * kCalls);
+        printf("  direct C++ call      %7.2f ns/call\n", directMs * 1e6 / calls);
+        printf("  table thunk          %7.2f ns/call (%.2f ns overhead)\n",
+               thunkMs * 1e6 / calls, (thunkMs - directMs) * 1e6 / calls);
+        printf("  lookup by name       %7.2f ns/call\n", lookupMs * 1e6 / calls);
+        printf("  color string arg     %7.2f ns/call\n", tintMs * 1e6 / (kCalls / 10));
+        return ok ? 0 : 1;
+    }
+
+    //--------------------------------------------------------------------------------
+    // image-cache: image loads with the cache cleared vs populated
+
+    const char* const kCacheImages[] = {
+        "images/ScreenFont.png",
+        "images/ScreenFontSmall.png",
+        "images/ScreenFontMedium.png",
+        "images/ScreenFontLarge.png",
+        "images/MiniMicro512.png",
+        "images/3DBezel.png",
+        "images/MiniMicroSticker.png",
+        "images/LoadingPleaseWait.png",
+    };
+    const int kCacheImageCount = (int)(sizeof(kCacheImages) / sizeof(kCacheImages[0]));
+
+    // Load every image once; returns the time taken, or -1 if one failed
+    double LoadCacheImages() {
+        double start = NowMs();
+        for (const char* path : kCacheImages) {
+            Image image = ImageCache::Load(path);
+            if (!image.data) return -1;
+            UnloadImage(image);
+        }
+        return NowMs() - start;
+    }
+
+    int BenchImageCache() {
+        if (!ImageCache::IsEnabled()) {
+            printf("image-cache: the cache is disabled\n");
+            return 1;
+        }
+
+        // Each round clears the entries (cold: decode and write them), then
+        // loads again (warm: read the entries back)
+        const int kRounds = 5;
+        double coldMs = 0, warmMs = 0;
+        int hitsBefore = ImageCache::GetHitCount();
+        int missesBefore = ImageCache::GetMissCount();
+        for (int round = 0; round < kRounds; round++) {
+            for (const char* path : kCacheImages) ImageCache::Remove(path);
+            double cold = LoadCacheImages();
+            double warm = LoadCacheImages();
+            if (cold < 0 || warm < 0) {
+                printf("image-cache: cannot load the resource images\n");
+                return 1;
+            }
+            coldMs += cold;
+            warmMs += warm;
+        }
+        int hits = ImageCache::GetHitCount() - hitsBefore;
+        int misses = ImageCache::GetMissCount() - missesBefore;
+
+        printf("image-cache: %d images, %d rounds\n", kCacheImageCount, kRounds);
+        printf("  cold (cache cleared)   %8.2f ms/round\n", coldMs / kRounds);
+        printf("  warm (cache populated) %8.2f ms/round\n", warmMs / kRounds);
+        printf("  time saved             %8.2f ms/round (%.1fx)\n",
+               (coldMs - warmMs) / kRounds, warmMs > 0 ? coldMs / warmMs : 0.0);
+        printf("  hits %d, misses %d\n", hits, misses);
+        return (hits == kRounds * kCacheImageCount && misses == kRounds * kCacheImageCount) ? 0 : 1;
+    }
+
+    //--------------------------------------------------------------------------------
+    // music: streamed track open time and memory, short vs long
+
+    // Write a 16-bit stereo 44.1 kHz WAV of a sine tone
+    bool WriteTestWav(const std::string& path, int seconds) {
+        const int kRate = 44100;
+        uint32_t dataSize = (uint32_t)seconds * kRate * 4;
+        unsigned char header[44];
+        memcpy(header, "RIFF", 4);
+        uint32_t riffSize = 36 + dataSize;
+        memcpy(header + 4, &riffSize, 4);
+        memcpy(header + 8, "WAVEfmt ", 8);
+        uint32_t fmtSize = 16, rate = kRate, byteRate = kRate * 4;
+        uint16_t format = 1, channels = 2, blockAlign = 4, bits = 16;
+        memcpy(header + 16, &fmtSize, 4);
+        memcpy(header + 20, &format, 2);
+        memcpy(header + 22, &channels, 2);
+        memcpy(header + 24, &rate, 4);
+        memcpy(header + 28, &byteRate, 4);
+        memcpy(header + 32, &blockAlign, 2);
+        memcpy(header + 34, &bits, 2);
+        memcpy(header + 36, "data", 4);
+        memcpy(header + 40, &dataSize, 4);
+
+        FILE* f = fopen(path.c_str(), "wb");
+        if (!f) return false;
+        bool ok = fwrite(header, 1, sizeof(header), f) == sizeof(header);
+        std::vector<int16_t> second((size_t)kRate * 2);
+        for (int i = 0; i < kRate; i++) {
+            second[i * 2] = second[i * 2 + 1] = (int16_t)(8000 * sin(i * 440.0 * 2 * PI / kRate));
+        }
+        for (int s = 0; s < seconds && ok; s++) ok = fwrite(second.data(), 4, kRate, f) == (size_t)kRate;
+        return (fclose(f) == 0) && ok;
+    }
+
+    struct MusicResult {
+        double openMs;          // OpenFile, which reads the header and starts the decoder
+        double firstAudioMs;    // from Play until the first frames can be read
+        size_t streamBytes;
+        double loadWholeMs;     // decoding the whole file into a Wave instead
+        size_t wholeBytes;
+    };
+
+    bool MeasureMusic(const std::string& path, MusicResult* result) {
+        MusicStream stream;
+        double start = NowMs();
+        if (!stream.OpenFile(path.c_str())) return false;
+        result->openMs = NowMs() - start;
+
+        stream.Play();
+        start = NowMs();
+        float frames[512 * 2];
+        int got = 0;
+        while (got == 0 && NowMs() - start < 1000) {
+            got = stream.Read(frames, 512);
+            if (got == 0) std::this_thread::yield();
+        }
+        result->firstAudioMs = NowMs() - start;
+        result->streamBytes = stream.GetMemoryUsage();
+        stream.Close();
+        if (got == 0) return false;
+
+        start = NowMs();
+        Wave wave = LoadWave(path.c_str());
+        result->loadWholeMs = NowMs() - start;
+        result->wholeBytes = (size_t)wave.frameCount * wave.channels * (wave.sampleSize / 8);
+        bool loaded = wave.data != nullptr;
+        UnloadWave(wave);
+        return loaded;
+    }
+
+    int BenchMusic() {
+        std::string folder = GetCacheFolder();
+        if (folder.empty()) {
+            printf("music: no cache folder to write test tracks to\n");
+            return 1;
+        }
+        const int kShortSeconds = 5;
+        const int kLongSeconds = 300;
+        std::string shortPath = folder + "/bench-short.wav";
+        std::string longPath = folder + "/bench-long.wav";
+        MusicResult shortTrack, longTrack;
+        bool ok = WriteTestWav(shortPath, kShortSeconds) && WriteTestWav(longPath, kLongSeconds)
+               && MeasureMusic(shortPath, &shortTrack) && MeasureMusic(longPath, &longTrack);
+        remove(shortPath.c_str());
+        remove(longPath.c_str());
+        if (!ok) {
+            printf("music: cannot write or stream the test tracks\n");
+            return 1;
+        }
+
+        printf("music: %d s vs %d s track (16-bit stereo WAV)\n", kShortSeconds, kLongSeconds);
+        const MusicResult* results[2] = { &shortTrack, &longTrack };
+        const char* names[2] = { "short", "long " };
+        for (int i = 0; i < 2; i++) {
+            printf("  %s open %6.2f ms, first audio %6.2f ms, %6.1f KB streaming;"
+                   " whole decode %8.2f ms, %8.1f KB\n",
+                   names[i], results[i]->openMs, results[i]->firstAudioMs, results[i]->streamBytes / 1024.0,
+                   results[i]->loadWholeMs, results[i]->wholeBytes / 1024.0);
+        }
+        // Streaming memory must not depend on the track's length
+        return shortTrack.streamBytes == longTrack.streamBytes ? 0 : 1;
+    }
+
+    //--------------------------------------------------------------------------------
+    // pixels: PixelDisplay drawing operations
+
+    bool SameColor(Color a, Color b) {
+        return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+    }
+
+    int BenchPixels() {
+        PixelDisplay gfx;
+        int width = gfx.GetWidth(), height = gfx.GetHeight();
+        const Color kColors[4] = { RED, GREEN, BLUE, Color{ 255, 255, 0, 255 } };
+        randomState = 1;
+
+        printf("pixels: %dx%d display\n", width, height);
+        double us = MicrosPerCall(20000, [&](int i) {
+            gfx.FillRect(RandomInt(width) - 100, RandomInt(height) - 100, 200, 200, kColors[i & 3]);
+        });
+        printf("  fill rect 200x200    %8.2f us (%.0f Mpixel/s)\n", us, 200 * 200 / us);
+        bool ok = true;
+        gfx.FillRect(10, 10, 20, 20, RED);
+        ok = ok && SameColor(gfx.GetPixel(15, 15), RED) && SameColor(gfx.GetPixel(29, 29), RED);
+
+        us = MicrosPerCall(100000, [&](int i) {
+            gfx.Line(RandomInt(width), RandomInt(height), RandomInt(width), RandomInt(height), kColors[i & 3]);
+        });
+        printf("  line, pen 1          %8.2f us\n", us);
+        us = MicrosPerCall(20000, [&](int i) {
+            gfx.Line(RandomInt(width), RandomInt(height), RandomInt(width), RandomInt(height), kColors[i & 3], 4);
+        });
+        printf("  line, pen 4          %8.2f us\n", us);
+
+        us = MicrosPerCall(20000, [&](int i) {
+            gfx.FillEllipse(RandomInt(width) - 100, RandomInt(height) - 75, 200, 150, kColors[i & 3]);
+        });
+        printf("  fill ellipse 200x150 %8.2f us\n", us);
+        us = MicrosPerCall(20000, [&](int i) {
+            gfx.DrawEllipse(RandomInt(width) - 100, RandomInt(height) - 75, 200, 150, kColors[i & 3], 2);
+        });
+        printf("  draw ellipse, pen 2  %8.2f us\n", us);
+
+        // A 12-point star, about 200 pixels across
+        Vector2 star[24];
+        us = MicrosPerCall(20000, [&](int i) {
+            float cx = (float)RandomInt(width), cy = (float)RandomInt(height);
+            for (int p = 0; p < 24; p++) {
+                float radius = (p & 1) ? 40.0f : 100.0f;
+                float angle = p * 2 * PI / 24;
+                star[p] = Vector2{ cx + radius * cosf(angle), cy + radius * sinf(angle) };
+            }
+            gfx.FillPolygon(star, 24, kColors[i & 3]);
+        });
+        printf("  fill polygon, star   %8.2f us\n", us);
+
+        // Flood fill over a screen scribbled with lines, so spans are broken up
+        gfx.Clear(BLACK);
+        for (int i = 0; i < 200; i++) {
+            gfx.Line(RandomInt(width), RandomInt(height), RandomInt(width), RandomInt(height), WHITE);
+        }
+        us = MicrosPerCall(100, [&](int i) {
+            gfx.FloodFill(0, 0, kColors[i & 3]);
+        });
+        printf("  flood fill, screen   %8.2f us\n", us);
+        gfx.Clear(BLACK);
+        gfx.FloodFill(width / 2, height / 2, BLUE);
+        ok = ok && SameColor(gfx.GetPixel(0, 0), BLUE) && SameColor(gfx.GetPixel(width - 1, height - 1), BLUE);
+
+        // Blit a half-transparent 64x64 image
+        Image sprite = GenImageColor(64, 64, Color{ 255, 128, 0, 128 });
+        us = MicrosPerCall(50000, [&](int) {
+            gfx.DrawImage(sprite, RandomInt(width) - 32, RandomInt(height) - 32);
+        });
+        printf("  blit 64x64, blended  %8.2f us (%.0f Mpixel/s)\n", us, 64 * 64 / us);
+        us = MicrosPerCall(50000, [&](int) {
+            gfx.DrawImage(sprite, Rectangle{ 16, 16, 32, 32 }, RandomInt(width) - 16, RandomInt(height) - 16);
+        });
+        printf("  blit 32x32 region    %8.2f us\n", us);
+        UnloadImage(sprite);
+        return ok ? 0 : 1;
+    }
+
+    //--------------------------------------------------------------------------------
+    // sprites: a frame of many moving sprites
+
+    struct FrameTimes {
+        std::vector<double> ms;
+
+        void Print(const char* label) {
+            std::sort(ms.begin(), ms.end());
+            double total = 0;
+            for (double t : ms) total += t;
+            printf("  %-28s mean %6.2f ms, median %6.2f, 95th %6.2f, worst %6.2f\n", label,
+                   total / ms.size(), ms[ms.size() / 2], ms[ms.size() * 95 / 100], ms.back());
+        }
+    };
+
+    // A new Machine fills every layer with an opaque black SolidColorDisplay,
+    // which would hide the layers under test
+    void EmptyLayers(Machine& machine) {
+        for (int i = 0; i < Machine::kDisplayCount; i++) machine.SetDisplay(i, nullptr);
+    }
+
+    // Draw one frame of the machine, returning its time (including the
+    // wait for the GPU to take it, as in the main loop)
+    double DrawMachineFrame(Machine& machine) {
+        double start = NowMs();
+        machine.Update(1.0f / 60);
+        BeginDrawing();
+        ClearBackground(BLACK);
+        machine.Render();
+        EndDrawing();
+        return NowMs() - start;
+    }
+
+    int BenchSprites() {
+        const int kSprites = 20000;
+        const int kFrames = 300;
+        const int kChurn = 1000;    // sprites removed and re-added per frame, in the churn run
+
+        Image pixels = GenImageColor(16, 16, WHITE);
+        Texture2D texture = LoadTextureFromImage(pixels);
+        UnloadImage(pixels);
+
+        Machine machine;
+        EmptyLayers(machine);
+        SpriteDisplay* sprites = new SpriteDisplay();
+        machine.SetDisplay(4, sprites);
+        int image = sprites->AddImage(texture);
+
+        randomState = 1;
+        std::vector<int> ids(kSprites);
+        std::vector<float> xs(kSprites), ys(kSprites), dxs(kSprites), dys(kSprites);
+        for (int i = 0; i < kSprites; i++) {
+            xs[i] = (float)RandomInt(Display::kScreenWidth);
+            ys[i] = (float)RandomInt(Display::kScreenHeight);
+            dxs[i] = (RandomInt(400) - 200) / 100.0f;
+            dys[i] = (RandomInt(400) - 200) / 100.0f;
+            ids[i] = sprites->AddSprite(image, xs[i], ys[i]);
+            sprites->SetTint(ids[i], Color{ (unsigned char)RandomInt(256), (unsigned char)RandomInt(256), 255, 255 });
+        }
+
+        // Move every sprite every frame, bouncing off the screen edges
+        auto move = [&]() {
+            for (int i = 0; i < kSprites; i++) {
+                xs[i] += dxs[i];
+                ys[i] += dys[i];
+                if (xs[i] < 0 || xs[i] > Display::kScreenWidth) dxs[i] = -dxs[i];
+                if (ys[i] < 0 || ys[i] > Display::kScreenHeight) dys[i] = -dys[i];
+            }
+            sprites->SetPositions(ids.data(), xs.data(), ys.data(), kSprites);
+        };
+
+        FrameTimes moving, churning;
+        for (int frame = 0; frame < kFrames; frame++) {
+            move();
+            moving.ms.push_back(DrawMachineFrame(machine));
+        }
+        bool ok = sprites->GetLastDrawnCount() == kSprites;
+
+        // The same, with some sprites removed and added back each frame
+        double churnMs = 0;
+        for (int frame = 0; frame < kFrames; frame++) {
+            double start = NowMs();
+            for (int i = 0; i < kChurn; i++) {
+                int index = RandomInt(kSprites);
+                sprites->RemoveSprite(ids[index]);
+                ids[index] = sprites->AddSprite(image, xs[index], ys[index]);
+            }
+            churnMs += NowMs() - start;
+            move();
+            churning.ms.push_back(DrawMachineFrame(machine));
+        }
+        ok = ok && sprites->GetSpriteCount() == kSprites && sprites->GetLastDrawnCount() == kSprites;
+
+        printf("sprites: %d moving 16x16 sprites, %d frames\n", kSprites, kFrames);
+        moving.Print("moving");
+        churning.Print("moving, churning");
+        printf("  remove + add %d sprites     %6.3f ms/frame\n", kChurn, churnMs / kFrames);
+        printf("  batches last frame          %d\n", sprites->GetLastBatchCount());
+
+        machine.SetDisplay(4, nullptr);
+        UnloadTexture(texture);
+        return ok ? 0 : 1;
+    }
+
+    //--------------------------------------------------------------------------------
+    // atlas: draw calls for many distinct sprite images
+
+    struct AtlasRun {
+        int batches;
+        double frameMs;
+    };
+
+    // Draw one sprite per image for a number of frames
+    AtlasRun DrawDistinctSprites(Machine& machine, int frames) {
+        double totalMs = 0;
+        for (int frame = 0; frame < frames; frame++) {
+            TextureAtlas::Shared().Update();
+            totalMs += DrawMachineFrame(machine);
+        }
+        return AtlasRun{ machine.GetRenderQueue().GetBatchCount(), totalMs / frames };
+    }
+
+    int BenchAtlas() {
+        const int kImages = 500;
+        const int kFrames = 200;
+
+        // Distinct 24x24 images, each with its own color and a marked corner
+        std::vector<Image> images(kImages);
+        for (int i = 0; i < kImages; i++) {
+            images[i] = GenImageColor(24, 24, Color{ (unsigned char)(i * 37), (unsigned char)(i * 11), (unsigned char)i, 255 });
+            ImageDrawPixel(&images[i], i % 24, 0, WHITE);
+        }
+
+        Machine machine;
+        EmptyLayers(machine);
+        SpriteDisplay* sprites = new SpriteDisplay();
+        machine.SetDisplay(4, sprites);
+        DrawMachineFrame(machine);
+        int baseBatches = machine.GetRenderQueue().GetBatchCount();
+
+        // One texture per image, as AcquireTexture would give them
+        std::vector<Texture2D> textures(kImages);
+        for (int i = 0; i < kImages; i++) {
+            textures[i] = LoadTextureFromImage(images[i]);
+            sprites->AddSprite(sprites->AddImage(textures[i]), 20.0f + (i % 25) * 37, 20.0f + (i / 25) * 30);
+        }
+        AtlasRun separate = DrawDistinctSprites(machine, kFrames);
+
+        // The same images packed into the shared atlas, as AcquireImage does
+        TextureAtlas& atlas = TextureAtlas::Shared();
+        std::vector<int> regions(kImages);
+        sprites->Clear();
+        for (int i = 0; i < kImages; i++) {
+            regions[i] = atlas.Add(images[i]);
+            sprites->AddSprite(sprites->AddImage(&atlas, regions[i]), 20.0f + (i % 25) * 37, 20.0f + (i / 25) * 30);
+        }
+        AtlasRun packed = DrawDistinctSprites(machine, kFrames);
+        int pages = atlas.GetPageCount();
+        bool allPacked = true;
+        for (int i = 0; i < kImages; i++) {
+            if (regions[i] < 0) allPacked = false;
+            atlas.Remove(regions[i]);
+            UnloadTexture(textures[i]);
+            UnloadImage(images[i]);
+        }
+
+        printf("atlas: %d sprites, each with its own image, %d frames\n", kImages, kFrames);
+        printf("  own textures    %4d draw batches, %6.2f ms/frame\n", separate.batches - baseBatches, separate.frameMs);
+        printf("  atlas regions   %4d draw batches, %6.2f ms/frame (%d atlas page%s)\n",
+               packed.batches - baseBatches, packed.frameMs, pages, pages == 1 ? "" : "s");
+        // Packed, the sprites need at most one batch per page
+        return (allPacked && packed.batches - baseBatches <= pages) ? 0 : 1;
+    }
+
+    //--------------------------------------------------------------------------------
+    // collisions: all colliding sprite pairs, spatial hash vs testing every pair
+
+    struct CollisionRun {
+        double hashMs;      // per query, including the hash updates for moved sprites
+        double pairsMs;
+        size_t pairCount;
+        bool same;
+    };
+
+    // giantWidth > 0 adds one more sprite (the highest id) that wide and 16
+    // high, ending at the screen's right edge, so most of the screen is far
+    // from its left end; wider than the hash lists in cells
+    CollisionRun MeasureCollisions(int count, int hashFrames, int pairFrames, float giantWidth) {
+        // Only the image size matters for collisions, so no GPU texture is needed
+        SpriteDisplay sprites;
+        Texture2D texture = Texture2D{};
+        texture.width = texture.height = 16;
+        int image = sprites.AddImage(texture);
+
+        randomState = 1;
+        std::vector<int> ids(count);
+        std::vector<float> xs(count), ys(count);
+        for (int i = 0; i < count; i++) {
+            xs[i] = (float)RandomInt(Display::kScreenWidth);
+            ys[i] = (float)RandomInt(Display::kScreenHeight);
+            ids[i] = sprites.AddSprite(image, xs[i], ys[i]);
+            sprites.SetRotation(ids[i], (float)RandomInt(360));
+        }
+        if (giantWidth > 0) {
+            xs.push_back(Display::kScreenWidth - giantWidth / 2);
+            ys.push_back(Display::kScreenHeight / 2.0f);
+            ids.push_back(sprites.AddSprite(image, xs.back(), ys.back()));
+            sprites.SetScale(ids.back(), giantWidth / texture.width, 1.0f);
+            count++;
+        }
+        auto move = [&]() {
+            for (int i = 0; i < count; i++) {
+                xs[i] += RandomInt(5) - 2;
+                ys[i] += RandomInt(5) - 2;
+            }
+            sprites.SetPositions(ids.data(), xs.data(), ys.data(), count);
+        };
+
+        std::vector<std::pair<int, int>> hashPairs, testedPairs;
+        double start = NowMs();
+        for (int frame = 0; frame < hashFrames; frame++) {
+            move();
+            hashPairs.clear();
+            sprites.FindCollidingPairs(hashPairs);
+        }
+        CollisionRun run;
+        run.hashMs = (NowMs() - start) / hashFrames;
+
+        // Every pair, on the sprites as the last hash query left them
+        start = NowMs();
+        for (int frame = 0; frame < pairFrames; frame++) {
+            testedPairs.clear();
+            for (int i = 0; i < count; i++) {
+                for (int j = i + 1; j < count; j++) {
+                    if (sprites.Overlaps(ids[i], ids[j])) testedPairs.push_back(std::make_pair(ids[i], ids[j]));
+                }
+            }
+        }
+        run.pairsMs = (NowMs() - start) / pairFrames;
+
+        std::sort(hashPairs.begin(), hashPairs.end());
+        std::sort(testedPairs.begin(), testedPairs.end());
+        run.pairCount = hashPairs.size();
+        run.same = hashPairs == testedPairs;
+        return run;
+    }
+
+    int BenchCollisions() {
+        const int kCounts[3] = { 1000, 10000, 1000 };
+        const int kPairFrames[3] = { 20, 2, 20 };
+        const float kGiantWidths[3] = { 0, 0, 6000 };
+        printf("collisions: 16x16 rotated sprites on a 960x640 screen, all colliding pairs\n");
+        bool ok = true;
+        for (int i = 0; i < 3; i++) {
+            CollisionRun run = MeasureCollisions(kCounts[i], 50, kPairFrames[i], kGiantWidths[i]);
+            char label[48];
+            int length = snprintf(label, sizeof(label), "%d sprites", kCounts[i]);
+            if (kGiantWidths[i] > 0) snprintf(label + length, sizeof(label) - length, " + one %.0f px", kGiantWidths[i]);
+            printf("  %-30s spatial hash %8.3f ms, every pair %9.3f ms (%.0fx), %zu pairs%s\n",
+                   label, run.hashMs, run.pairsMs, run.hashMs > 0 ? run.pairsMs / run.hashMs : 0.0,
+                   run.pairCount, run.same ? "" : " (MISMATCH)");
+            ok = ok && run.same;
+        }
+        return ok ? 0 : 1;
+    }
+
+    //--------------------------------------------------------------------------------
+    // tiles: scrolling a small and a huge tile map
+
+    struct ScrollRun {
+        FrameTimes frames;
+        double meanDrawnChunks;
+        int maxDrawnChunks;
+        int rebuiltChunks;      // over the whole run
+    };
+
+    ScrollRun ScrollTileMap(Texture2D tileSet, int columns, int rows, int frameCount) {
+        const float kCellSize = 16;
+        Machine machine;
+        EmptyLayers(machine);
+        TileDisplay* tiles = new TileDisplay();
+        machine.SetDisplay(6, tiles);
+        tiles->SetTileSet(tileSet, 16, 16);
+        tiles->SetCellSize(kCellSize, kCellSize);
+        tiles->SetExtent(columns, rows);
+        for (int row = 0; row < rows; row++) {
+            for (int column = 0; column < columns; column++) tiles->SetCell(column, row, (column * 7 + row * 3) % 256);
+        }
+
+        // Scroll diagonally across the map, wrapping at its far edges
+        ScrollRun run = ScrollRun();
+        float rangeX = columns * kCellSize - Display::kScreenWidth, rangeY = rows * kCellSize - Display::kScreenHeight;
+        long drawnTotal = 0;
+        for (int frame = 0; frame < frameCount; frame++) {
+            float scrollX = rangeX > 0 ? fmodf(frame * 7.0f, rangeX) : 0;
+            float scrollY = rangeY > 0 ? fmodf(frame * 5.0f, rangeY) : 0;
+            tiles->SetScroll(scrollX, scrollY);
+            run.frames.ms.push_back(DrawMachineFrame(machine));
+            drawnTotal += tiles->GetLastDrawnChunkCount();
+            run.maxDrawnChunks = std::max(run.maxDrawnChunks, tiles->GetLastDrawnChunkCount());
+            run.rebuiltChunks += tiles->GetLastRebuiltChunkCount();
+        }
+        run.meanDrawnChunks = (double)drawnTotal / frameCount;
+        return run;
+    }
+
+    int BenchTiles() {
+        const int kFrames = 600;
+        Image pixels = GenImageColor(256, 256, WHITE);
+        for (int i = 0; i < 256; i++) {
+            ImageDrawRectangle(&pixels, (i % 16) * 16, (i / 16) * 16, 15, 15,
+                               Color{ (unsigned char)(i * 5), (unsigned char)(255 - i), 128, 255 });
+        }
+        Texture2D tileSet = LoadTextureFromImage(pixels);
+        UnloadImage(pixels);
+
+        const int kSizes[2][2] = { { 64, 48 }, { 1000, 1000 } };
+        printf("tiles: %d frames scrolling diagonally, 16x16 cells in %dx%d-cell chunks\n",
+               kFrames, TileDisplay::kChunkSize, TileDisplay::kChunkSize);
+        ScrollRun runs[2];
+        for (int i = 0; i < 2; i++) {
+            runs[i] = ScrollTileMap(tileSet, kSizes[i][0], kSizes[i][1], kFrames);
+            char label[32];
+            snprintf(label, sizeof(label), "%dx%d map", kSizes[i][0], kSizes[i][1]);
+            runs[i].frames.Print(label);
+            printf("  %-28s chunks drawn %.1f/frame (max %d), rebuilt %d in all\n", "",
+                   runs[i].meanDrawnChunks, runs[i].maxDrawnChunks, runs[i].rebuiltChunks);
+        }
+        UnloadTexture(tileSet);
+
+        // A huge map should cost about a screenful of chunks, like a small one
+        int chunkPixels = (int)(TileDisplay::kChunkSize * 16);
+        int maxVisible = (Display::kScreenWidth / chunkPixels + 2) * (Display::kScreenHeight / chunkPixels + 2);
+        return runs[1].maxDrawnChunks <= maxVisible ? 0 : 1;
+    }
+
+    //--------------------------------------------------------------------------------
+    // lines: indexing and reading a large text file, mapped vs streamed
+
+    // Write lines of 0-119 letters, about megabytes MB in all
+    bool WriteTestText(const std::string& path, int megabytes) {
+        FILE* f = fopen(path.c_str(), "wb");
+        if (!f) return false;
+        std::vector<char> buffer;
+        bool ok = true;
+        size_t written = 0, target = (size_t)megabytes << 20;
+        randomState = 1;
+        while (ok && written < target) {
+            buffer.clear();
+            while (buffer.size() < 1 << 16) {
+                int length = RandomInt(120);
+                for (int i = 0; i < length; i++) buffer.push_back((char)('a' + (i + length) % 26));
+                buffer.push_back('\n');
+            }
+            ok = fwrite(buffer.data(), 1, buffer.size(), f) == buffer.size();
+            written += buffer.size();
+        }
+        return (fclose(f) == 0) && ok;
+    }
+
+    struct LinesResult {
+        double openMs;          // mapping or streaming through the file to index its lines
+        double readMs;          // NextLine over every line
+        size_t lineCount;
+        uint64_t checksum;      // over line lengths, to check both paths read the same lines
+        bool streamed;
+    };
+
+    bool ReadTestText(const std::string& path, LinesResult* result) {
+        LineReader reader;
+        double start = NowMs();
+        if (!reader.Open(path.c_str())) return false;
+        result->openMs = NowMs() - start;
+        result->streamed = reader.IsStreaming();
+        result->lineCount = reader.GetLineCount();
+
+        start = NowMs();
+        const char* text;
+        size_t length;
+        uint64_t checksum = 0;
+        while (reader.NextLine(&text, &length)) checksum = checksum * 31 + length + (length ? (unsigned char)text[0] : 0);
+        result->readMs = NowMs() - start;
+        result->checksum = checksum;
+        return true;
+    }
+
+    int BenchLines() {
+        std::string folder = GetCacheFolder();
+        if (folder.empty()) {
+            printf("lines: no cache folder to write the test file to\n");
+            return 1;
+        }
+        const int kMegabytes = 256;
+        std::string path = folder + "/bench-lines.txt";
+        LinesResult mapped, streamed;
+        uint64_t budget = LineReader::GetMapBudget();
+        bool ok = WriteTestText(path, kMegabytes) && ReadTestText(path, &mapped);
+        LineReader::SetMapBudget(0);    // every file is over budget: stream it
+        ok = ok && ReadTestText(path, &streamed);
+        LineReader::SetMapBudget(budget);
+        remove(path.c_str());
+        if (!ok) {
+            printf("lines: cannot write or read the test file\n");
+            return 1;
+        }
+
+        printf("lines: %d MB text file, %zu lines\n", kMegabytes, mapped.lineCount);
+        const LinesResult* results[2] = { &mapped, &streamed };
+        const char* names[2] = { "mapped  ", "streamed" };
+        for (int i = 0; i < 2; i++) {
+            printf("  %s index %8.1f ms (%7.1f MB/s), read all %8.1f ms (%7.1f MB/s)\n", names[i],
+                   results[i]->openMs, kMegabytes * 1000.0 / results[i]->openMs,
+                   results[i]->readMs, kMegabytes * 1000.0 / results[i]->readMs);
+        }
+        return !mapped.streamed && streamed.streamed && mapped.lineCount == streamed.lineCount
+            && mapped.checksum == streamed.checksum ? 0 : 1;
+    }
+
+    //--------------------------------------------------------------------------------
+    // capture: recording video through the readback ring, checked against a budget
+
+    // CaptureFrame's cost on the main thread must stay well under a 60 fps frame
+    const double kCaptureAverageBudgetMs = 1.0;
+    const double kCaptureMaxBudgetMs = 4.0;
+
+    int BenchCapture() {
+        std::string folder = GetCacheFolder();
+        if (folder.empty()) {
+            printf("capture: no cache folder to write the test video to\n");
+            return 1;
+        }
+        const int kFrames = 600;
+        std::string path = folder + "/bench-capture.qov";
+
+        Machine machine;
+        EmptyLayers(machine);
+        PixelDisplay* gfx = new PixelDisplay();
+        machine.SetDisplay(5, gfx);
+        const Color kColors[4] = { RED, GREEN, BLUE, Color{ 255, 255, 0, 255 } };
+        randomState = 1;
+
+        // Same region and framebuffer as the app: the screen area of the canvas
+        ScreenPresenter presenter;
+        FrameCapture capture;
+        capture.SetRegion(Display::kScreenLeft, ScreenPresenter::kCanvasHeight - Display::kScreenBottom,
+                          Display::kScreenWidth, Display::kScreenHeight);
+        if (!capture.StartRecording(path.c_str(), 60)) {
+            printf("capture: cannot write the test video\n");
+            return 1;
+        }
+        FrameTimes frames;
+        for (int frame = 0; frame < kFrames; frame++) {
+            // Changing content, so the encoder has real work to keep up with
+            gfx->FillRect(RandomInt(gfx->GetWidth()) - 100, RandomInt(gfx->GetHeight()) - 100, 200, 200, kColors[frame & 3]);
+            machine.Update(1.0f / 60);
+            presenter.BeginCanvas();
+            machine.Render();
+            presenter.EndCanvas();
+            capture.CaptureFrame(presenter.GetCanvasFramebuffer());
+            frames.ms.push_back(capture.GetLastOverheadMs());
+            BeginDrawing();
+            presenter.Present(false, BLACK);
+            EndDrawing();
+        }
+        capture.StopRecording();
+        capture.Unload();
+        remove(path.c_str());
+
+        int captured = capture.GetCapturedFrameCount(), dropped = capture.GetDroppedFrameCount();
+        double average = capture.GetAverageOverheadMs(), worst = capture.GetMaxOverheadMs();
+        printf("capture: %d frames of %dx%d to .qov, %d captured, %d dropped\n", kFrames,
+               Display::kScreenWidth, Display::kScreenHeight, captured, dropped);
+        frames.Print("CaptureFrame");
+        printf("  budget: %.2f ms average, %.2f ms max: %s\n", kCaptureAverageBudgetMs, kCaptureMaxBudgetMs,
+               average <= kCaptureAverageBudgetMs && worst <= kCaptureMaxBudgetMs ? "ok" : "EXCEEDED");
+        return captured > 0 && captured + dropped == kFrames && average <= kCaptureAverageBudgetMs
+            && worst <= kCaptureMaxBudgetMs ? 0 : 1;
+    }
+
+    //--------------------------------------------------------------------------------
+
+    struct Benchmark {
+        const char* name;
+        const char* description;
+        int (*run)();
+    };
+
+    const Benchmark kBenchmarks[] = {
+        { "dispatch", "intrinsic call overhead: direct vs table thunk vs name lookup", BenchDispatch },
+        { "image-cache", "image loads with the cache cleared vs populated", BenchImageCache },
+        { "music", "streamed track open time and memory, short vs long", BenchMusic },
+        { "pixels", "PixelDisplay fill rect, line, ellipse, polygon, flood fill, blit", BenchPixels },
+        { "sprites", "frame time for 20,000 moving sprites, with and without churn", BenchSprites },
+        { "atlas", "draw batches for 500 distinct sprite images, own textures vs atlas", BenchAtlas },
+        { "collisions", "colliding sprite pairs at 1k and 10k: spatial hash vs every pair", BenchCollisions },
+        { "tiles", "scrolling a 64x48 vs a 1000x1000 tile map: frame time, chunks drawn and rebuilt", BenchTiles },
+        { "lines", "indexing and reading a 256 MB text file: mapped vs streamed, in MB/s", BenchLines },
+        { "capture", "recording 600 frames to .qov: CaptureFrame cost vs its budget", BenchCapture },
+    };
+}
+
+int RunBenchmark(const char* name) {
+    if (strcmp(name, "list") == 0) {
+        for (const Benchmark& bench : kBenchmarks) printf("%-12s %s\n", bench.name, bench.description);
+        return 0;
+    }
+
+    bool all = strcmp(name, "all") == 0;
+    int result = 0;
+    bool found = false;
+    for (const Benchmark& bench : kBenchmarks) {
+        if (!all && strcmp(name, bench.name) != 0) continue;
+        found = true;
+        if (bench.run() != 0) {
+            printf("%s: FAILED\n", bench.name);
+            result = 1;
+        }
+    }
+    if (!found) {
+        printf("Unknown benchmark \"%s\" (try --bench list)\n", name);
+        return 2;
+    }
+    return result;
+}
@@ -0,0 +1,203 @@
+#include "CommandHistory.h"
+#include "raylib.h"
+#include <algorithm>
+
+namespace {
+    inline uint32_t Trigram(const char* text) {
+        return (uint32_t)(unsigned char)text[0] | (uint32_t)(unsigned char)text[1] << 8 |
+               (uint32_t)(unsigned char)text[2] << 16;
+    }
+}
+
+CommandHistory::CommandHistory()
+    : loggedCount(0), appendFile(nullptr), maxEntries(kDefaultMaxEntries), indexBuilt(false) {
+}
+
+CommandHistory::~CommandHistory() {
+    Close();
+}
+
+bool CommandHistory::Open(const char* path) {
+    Close();
+    this->path = path;
+    if (FileExists(path) && log.Open(path)) {
+        loggedCount = log.GetLineCount();
+        // Let the log run past the limit for a while, so it is not
+        // rewritten every session
+        if (loggedCount > maxEntries + maxEntries / 4) Compact();
+    }
+
+    // An unfinished last line (from a crash mid-write) must not swallow
+    // the next entry
+    bool needsNewline = false;
+    if (log.GetSize() > 0) {
+        FILE* f = fopen(path, "rb");
+        if (f) {
+            needsNewline = fseek(f, -1, SEEK_END) == 0 && fgetc(f) != '\n';
+            fclose(f);
+        }
+    }
+
+    appendFile = fopen(path, "ab");
+    if (!appendFile) {
+        TraceLog(LOG_WARNING, "CommandHistory: Cannot write %s; history will not be saved", path);
+        return false;
+    }
+    if (needsNewline) fputc('\n', appendFile);
+    return true;
+}
+
+void CommandHistory::Close() {
+    if (appendFile) fclose(appendFile);
+    appendFile = nullptr;
+    log.Close();
+    loggedCount = 0;
+    added.clear();
+    trigrams.clear();
+    indexBuilt = false;
+    path.clear();
+}
+
+bool CommandHistory::Compact() {
+    // Keep the newest maxEntries, written to a new file that replaces the
+    // log; multi-line entries can't be logged, so they are dropped here
+    std::string tempPath = path + ".tmp";
+    FILE* f = fopen(tempPath.c_str(), "wb");
+    if (!f) {
+        TraceLog(LOG_WARNING, "CommandHistory: Cannot write %s", tempPath.c_str());
+        return false;
+    }
+    bool ok = true;
+    for (size_t i = GetCount() - maxEntries; i < GetCount() && ok; i++) {
+        const char* text;
+        size_t length;
+        ok = View(i, &text, &length);
+        if (!ok || std::find_first_of(text, text + length, "\r\n", "\r\n" + 2) != text + length) continue;
+        ok = fwrite(text, 1, length, f) == length && fputc('\n', f) != EOF;
+    }
+    ok = (fclose(f) == 0) && ok;
+    if (!ok) {
+        TraceLog(LOG_WARNING, "CommandHistory: Writing %s failed", tempPath.c_str());
+        remove(tempPath.c_str());
+        return false;
+    }
+
+    // The old log stays as it is unless the new one replaces it
+    bool appending = appendFile != nullptr;
+    if (appending) fclose(appendFile);
+    appendFile = nullptr;
+    log.Close();
+    bool replaced = MappedFile::Replace(path.c_str(), tempPath.c_str());
+    if (!replaced) {
+        TraceLog(LOG_WARNING, "CommandHistory: Cannot replace %s", path.c_str());
+        remove(tempPath.c_str());
+    }
+    bool reopened = log.Open(path.c_str());
+    if (appending) appendFile = fopen(path.c_str(), "ab");
+    if (!replaced) {
+        loggedCount = reopened ? std::min(loggedCount, log.GetLineCount()) : 0;
+        return false;
+    }
+
+    // Everything is in the log now
+    loggedCount = reopened ? log.GetLineCount() : 0;
+    added.clear();
+    trigrams.clear();
+    indexBuilt = false;
+    return true;
+}
+
+void CommandHistory::Trim() {
+    // Down to maxEntries, so entries beyond the limit are dropped in bulk
+    if (appendFile && Compact()) return;
+    if (loggedCount > 0) return;      // can't drop logged entries without rewriting the log
+    added.erase(added.begin(), added.begin() + (added.size() - maxEntries));
+    trigrams.clear();
+    indexBuilt = false;
+}
+
+bool CommandHistory::View(size_t index, const char** outText, size_t* outLength) {
+    if (index < loggedCount) return log.GetLine(index, outText, outLength);
+    index -= loggedCount;
+    if (index >= added.size()) return false;
+    *outText = added[index].data();
+    *outLength = added[index].size();
+    return true;
+}
+
+std::string CommandHistory::Get(size_t index) {
+    const char* text;
+    size_t length;
+    if (!View(index, &text, &length)) return "";
+    return std::string(text, length);
+}
+
+void CommandHistory::Add(const std::string& entry) {
+    added.push_back(entry);
+    if (indexBuilt) IndexEntry((uint32_t)(GetCount() - 1));
+    bool trim = GetCount() > maxEntries + maxEntries / 4;
+
+    // Flushed right away, so a crash loses nothing; a multi-line entry
+    // can't be stored one per line, so it lasts only this session
+    if (appendFile && entry.find_first_of("\r\n") == std::string::npos) {
+        fwrite(entry.data(), 1, entry.size(), appendFile);
+        fputc('\n', appendFile);
+        fflush(appendFile);
+    }
+    if (trim) Trim();
+}
+
+bool CommandHistory::Contains(size_t index, const std::string& text) {
+    const char* entry;
+    size_t length;
+    if (!View(index, &entry, &length)) return false;
+    return std::search(entry, entry + length, text.begin(), text.end()) != entry + length || text.empty();
+}
+
+void CommandHistory::IndexEntry(uint32_t index) {
+    // Entries are indexed in order, so each list stays sorted; checking
+    // its last element is enough to skip repeats within an entry
+    const char* text;
+    size_t length;
+    if (!View(index, &text, &length)) return;
+    for (size_t i = 0; i + 3 <= length; i++) {
+        std::vector<uint32_t>& entries = trigrams[Trigram(text + i)];
+        if (entries.empty() || entries.back() != index) entries.push_back(index);
+    }
+}
+
+void CommandHistory::BuildIndex() {
+    trigrams.clear();
+    for (size_t i = 0; i < GetCount(); i++) IndexEntry((uint32_t)i);
+    indexBuilt = true;
+}
+
+int CommandHistory::Search(const std::string& text, int from) {
+    if (from < 0 || GetCount() == 0) return -1;
+    if ((size_t)from >= GetCount()) from = (int)GetCount() - 1;
+
+    if (text.length() < 3) {
+        // Too short for the index, but short strings are common enough to
+        // be found among the newest entries
+        for (int i = from; i >= 0; i--) {
+            if (Contains(i, text)) return i;
+        }
+        return -1;
+    }
+
+    // Only entries with all of the query's trigrams can match; walk the
+    // shortest of their lists, newest first
+    if (!indexBuilt) BuildIndex();
+    const std::vector<uint32_t>* rarest = nullptr;
+    for (size_t i = 0; i + 3 <= text.length(); i++) {
+        std::unordered_map<uint32_t, std::vector<uint32_t>>::const_iterator it = trigrams.find(Trigram(&text[i]));
+        if (it == trigrams.end()) return -1;
+        if (!rarest || it->second.size() < rarest->size()) rarest = &it->second;
+    }
+    std::vector<uint32_t>::const_iterator pos = std::upper_bound(rarest->begin(), rarest->end(), (uint32_t)from);
+    while (pos != rarest->begin()) {
+        --pos;
+        if (Contains(*pos, text)) return (int)*pos;
+    }
+    return -1;
+}
@@ -0,0 +1,90 @@
+#include "CompletionIndex.h"
+#include <algorithm>
+#include <cctype>
+
+namespace {
+    // Matches Console's notion of a word (so "text.pr" completes as a whole)
+    inline bool IsTokenChar(char c) {
+        return std::isalnum((unsigned char)c) || c == '_' || c == '.';
+    }
+
+    inline bool HasPrefix(const std::string& word, const std::string& prefix) {
+        return word.compare(0, prefix.length(), prefix) == 0;
+    }
+}
+
+CompletionIndex::CompletionIndex() : lastBegin(0), lastEnd(0), lastValid(false), narrowedQueries(0) {
+}
+
+void CompletionIndex::Add(const std::string& word) {
+    if (word.empty()) return;
+    std::vector<std::string>::iterator pos = std::lower_bound(words.begin(), words.end(), word);
+    if (pos != words.end() && *pos == word) return;
+    words.insert(pos, word);
+    lastValid = false;
+}
+
+void CompletionIndex::AddAll(const std::vector<std::string>& newWords) {
+    // One sort instead of an insertion per word
+    words.insert(words.end(), newWords.begin(), newWords.end());
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+    if (!words.empty() && words.front().empty()) words.erase(words.begin());
+    lastValid = false;
+}
+
+void CompletionIndex::Remove(const std::string& word) {
+    std::vector<std::string>::iterator pos = std::lower_bound(words.begin(), words.end(), word);
+    if (pos == words.end() || *pos != word) return;
+    words.erase(pos);
+    lastValid = false;
+}
+
+void CompletionIndex::Clear() {
+    words.clear();
+    lastValid = false;
+}
+
+bool CompletionIndex::Contains(const std::string& word) const {
+    return std::binary_search(words.begin(), words.end(), word);
+}
+
+void CompletionIndex::FindRange(const std::string& prefix, size_t* outBegin, size_t* outEnd) {
+    std::vector<std::string>::iterator low = words.begin();
+    std::vector<std::string>::iterator high = words.end();
+    if (lastValid && HasPrefix(prefix, lastPrefix)) {
+        low = words.begin() + lastBegin;
+        high = words.begin() + lastEnd;
+        narrowedQueries++;
+    }
+
+    // Everything in [low, high) shares the old prefix, so the words with
+    // the new one start at its lower bound and run while they match
+    std::vector<std::string>::iterator begin = std::lower_bound(low, high, prefix);
+    std::vector<std::string>::iterator end = std::partition_point(begin, high,
+        [&prefix](const std::string& word) { return HasPrefix(word, prefix); });
+
+    lastPrefix = prefix;
+    lastBegin = begin - words.begin();
+    lastEnd = end - words.begin();
+    lastValid = true;
+    *outBegin = lastBegin;
+    *outEnd = lastEnd;
+}
+
+std::string CompletionIndex::Complete(const std::string& prefix) {
+    if (prefix.empty()) return "";
+    size_t begin, end;
+    FindRange(prefix, &begin, &end);
+
+    // The prefix itself, if it is a word, sorts first
+    if (begin < end && words[begin].length() == prefix.length()) begin++;
+    if (begin == end) return "";
+    return words[begin].substr(prefix.length());
+}
+
+std::string CompletionIndex::LastToken(const std::string& text) {
+    size_t start = text.length();
+    while (start > 0 && IsTokenChar(text[start - 1])) start--;
+    return text.substr(start);
+}
@@ -1,87 +1,144 @@
 #include "Console.h"
+#include "CompletionIndex.h"
 #include "raylib.h"
+#include "ThreadPool.h"
 #include <algorithm>
 #include <cctype>
 #include <cstring>
 
 Console::Console(TextDisplay* display)
     : display(display),
+      frameEventCount(0),
       inInputMode(false),
       inputIndex(0),
-      historyIndex(0) {
+      historyIndex(0),
+      searching(false),
+      searchMatch(-1),
+      searchFailed(false),
+      completionIndex(nullptr),
+      suggestionPool(nullptr),
+      suggestionRequest(0),
+      readyRequest(0),
+      droppedKeys(0),
+      echoPendingSince(-1),
+      lastEchoMs(0),
+      maxEchoMs(0),
+      totalEchoMs(0),
+      echoSamples(0) {
+    memset(keyChars, 0, sizeof(keyChars));
 }
 
 Console::~Console() {
+    delete suggestionPool;
 }
 
 void Console::InitKeyboardMapping() {
-    // Build a map from virtual characters to physical key codes
-    // by checking what character each physical key produces
-    charToKeyCode.clear();
+    // Build a table of the character each physical key produces on this
+    // layout, for finding Ctrl+letter combinations by letter
+    memset(keyChars, 0, sizeof(keyChars));
 
     // Check all letter keys
     for (int keyCode = 39; keyCode <= 96; keyCode++) {
         const char* keyName = GetKeyName(keyCode);
         if (keyName && strlen(keyName) == 1) {
-            char ch = tolower(keyName[0]);
-            charToKeyCode[ch] = keyCode;
+            keyChars[keyCode] = (unsigned char)tolower(keyName[0]);
         }
     }
 }
 
 void Console::Update(float deltaTime) {
-    if (!inInputMode) return;
-
-    // Check for Ctrl key state first
-    bool ctrl = IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL);
-
-    // Handle Ctrl+key combinations before regular character input
-    // Use our keyboard mapping to find the right physical key for each virtual key
-    if (ctrl) {
-        auto checkCtrlKey = [&](char ch, int ctrlCode) {
-            auto it = charToKeyCode.find(ch);
-            if (it != charToKeyCode.end() && IsKeyPressed((KeyboardKey)it->second)) {
-                HandleKey((char)ctrlCode);
-                return true;
-            }
-            return false;
-        };
-
-        if (checkCtrlKey('a', kControlA)) return;
-        if (checkCtrlKey('c', kControlC)) return;
-        if (checkCtrlKey('e', kControlE)) return;
-        if (checkCtrlKey('k', kControlK)) return;
-        if (checkCtrlKey('u', kControlU)) return;
+    if (suggestionPool && inInputMode) ShowReadySuggestion();
+
+    PollEvents();
+    for (int i = 0; i < frameEventCount; i++) {
+        const InputEvent& event = frameEvents[i];
+        if (event.codepoint == 0) continue;     // e.g. Shift alone
+        if (inInputMode && (echoPendingSince < 0 || event.time < echoPendingSince)) echoPendingSince = event.time;
+
+        // The input line is single-byte; other characters are only buffered
+        HandleKeyEvent(event.codepoint < 128 ? (char)event.codepoint : 0, event);
     }
+}
 
-    // Handle keyboard input from Raylib (only printable characters)
-    int key = GetCharPressed();
-    while (key > 0) {
-        if (key >= 32) {
-            HandleKey((char)key);
-        }
-        key = GetCharPressed();
+void Console::PollEvents() {
+    // One pass over Raylib's queues of pressed keys and typed characters
+    double now = GetTime();
+    uint32_t modifiers = 0;
+    if (IsKeyDown(KEY_LEFT_SHIFT) || IsKeyDown(KEY_RIGHT_SHIFT)) modifiers |= InputEvent::kShift;
+    if (IsKeyDown(KEY_LEFT_CONTROL) || IsKeyDown(KEY_RIGHT_CONTROL)) modifiers |= InputEvent::kControl;
+    if (IsKeyDown(KEY_LEFT_ALT) || IsKeyDown(KEY_RIGHT_ALT)) modifiers |= InputEvent::kAlt;
+    if (IsKeyDown(KEY_LEFT_SUPER) || IsKeyDown(KEY_RIGHT_SUPER)) modifiers |= InputEvent::kSuper;
+
+    frameEventCount = 0;
+    for (int key = GetKeyPressed(); key > 0; key = GetKeyPressed()) {
+        if (frameEventCount == kMaxFrameEvents) continue;
+        InputEvent event = { SpecialKeyCode(key, modifiers), key, modifiers, now };
+        frameEvents[frameEventCount++] = event;
     }
 
-    // Handle special keys that don't come through GetCharPressed
-    if (IsKeyPressed(KEY_BACKSPACE)) HandleKey((char)kBackspace);
-    if (IsKeyPressed(KEY_DELETE)) HandleKey((char)kFwdDelete);
-    if (IsKeyPressed(KEY_ENTER)) HandleKey('\n');
-    if (IsKeyPressed(KEY_TAB)) HandleKey((char)kTab);
-    if (IsKeyPressed(KEY_ESCAPE)) HandleKey((char)27);
+    // Each character goes with the key that typed it: the one whose layout
+    // character it is, or else the first pressed key that types something.
+    // Characters with no key (key repeat, input methods) get events of their own.
+    int keyEvents = frameEventCount;
+    for (int codepoint = GetCharPressed(); codepoint > 0; codepoint = GetCharPressed()) {
+        if (codepoint < 32) continue;
+        int lower = codepoint < 128 ? tolower(codepoint) : -1;
+        int match = -1;
+        for (int i = 0; i < keyEvents && match < 0; i++) {
+            int key = frameEvents[i].key;
+            if (frameEvents[i].codepoint == 0 && key < kKeyTableSize && keyChars[key] == lower) match = i;
+        }
+        for (int i = 0; i < keyEvents && match < 0; i++) {
+            int key = frameEvents[i].key;
+            bool typing = (key >= KEY_SPACE && key <= KEY_GRAVE) || (key >= KEY_KP_0 && key <= KEY_KP_EQUAL);
+            if (frameEvents[i].codepoint == 0 && typing) match = i;
+        }
+        if (match >= 0) {
+            frameEvents[match].codepoint = codepoint;
+        } else if (frameEventCount < kMaxFrameEvents) {
+            InputEvent event = { codepoint, 0, modifiers, now };
+            frameEvents[frameEventCount++] = event;
+        }
+    }
+}
 
-    if (IsKeyPressed(KEY_LEFT)) {
-        if (ctrl) HandleKey((char)kControlA);
-        else HandleKey((char)kLeftArrow);
+int Console::SpecialKeyCode(int key, uint32_t modifiers) const {
+    bool ctrl = (modifiers & InputEvent::kControl) != 0;
+    switch (key) {
+        case KEY_BACKSPACE: return kBackspace;
+        case KEY_DELETE: return kFwdDelete;
+        case KEY_ENTER: return '\n';
+        case KEY_TAB: return kTab;
+        case KEY_ESCAPE: return 27;
+        case KEY_LEFT: return ctrl ? kControlA : kLeftArrow;
+        case KEY_RIGHT: return ctrl ? kControlE : kRightArrow;
+        case KEY_UP: return kUpArrow;
+        case KEY_DOWN: return kDownArrow;
+        case KEY_HOME: return kControlA;
+        case KEY_END: return kControlE;
+        default: break;
     }
-    if (IsKeyPressed(KEY_RIGHT)) {
-        if (ctrl) HandleKey((char)kControlE);
-        else HandleKey((char)kRightArrow);
+
+    // Ctrl+letter, by the letter on the key in this layout
+    if (!ctrl || key >= kKeyTableSize) return 0;
+    switch (keyChars[key]) {
+        case 'a': return kControlA;
+        case 'c': return kControlC;
+        case 'e': return kControlE;
+        case 'k': return kControlK;
+        case 'r': return kHistorySearch;
+        case 'u': return kControlU;
+        default: return 0;
     }
-    if (IsKeyPressed(KEY_UP)) HandleKey((char)kUpArrow);
-    if (IsKeyPressed(KEY_DOWN)) HandleKey((char)kDownArrow);
-    if (IsKeyPressed(KEY_HOME)) HandleKey((char)kControlA);
-    if (IsKeyPressed(KEY_END)) HandleKey((char)kControlE);
+}
+
+void Console::NoteFramePresented(double time) {
+    if (echoPendingSince < 0) return;
+    lastEchoMs = (time - echoPendingSince) * 1000.0;
+    if (lastEchoMs > maxEchoMs) maxEchoMs = lastEchoMs;
+    totalEchoMs += lastEchoMs;
+    echoSamples++;
+    echoPendingSince = -1;
 }
 
 void Console::StartInput() {
@@ -90,7 +147,8 @@ void Console::StartInput() {
     inputBuf = "";
     inputIndex = 0;
     inInputMode = true;
-    historyIndex = (int)history.size();
+    searching = false;
+    historyIndex = (int)history.GetCount();
     if (onInputChanged) onInputChanged(inputBuf);
 }
 
@@ -99,9 +157,9 @@ void Console::CommitInput() {
     SetCursorForInput(false);
 
     // Add to history if not empty and different from last
-    std::string lastCommand = history.empty() ? "" : history.back();
+    std::string lastCommand = history.GetCount() == 0 ? "" : history.Get(history.GetCount() - 1);
     if (!inputBuf.empty() && inputBuf != lastCommand) {
-        history.push_back(inputBuf);
+        history.Add(inputBuf);
     }
 
     display->HideCursor();
@@ -113,10 +171,17 @@ void Console::CommitInput() {
 
 void Console::AbortInput() {
     inInputMode = false;
+    searching = false;
     display->HideCursor();
 }
 
 void Console::HandleKey(char keyChar) {
+    InputEvent event = { (unsigned char)keyChar, 0, 0, GetTime() };
+    HandleKeyEvent(keyChar, event);
+}
+
+void Console::HandleKeyEvent(char keyChar, const InputEvent& event) {
+    if (onKey && keyChar) onKey(keyChar);
     int keyInt = (int)keyChar;
 
     // Control-C handling
@@ -126,14 +191,18 @@ void Console::HandleKey(char keyChar) {
 
     if (!inInputMode) {
         // Buffer keys when not in input mode
-        keyBuffer.push(keyChar);
+        if (!keyBuffer.Push(event)) droppedKeys++;
         return;
     }
+    if (keyInt == 0) return;    // a character the input line can't show
 
     bool byWord = IsKeyDown(KEY_LEFT_ALT) || IsKeyDown(KEY_RIGHT_ALT);
 
     if (keyInt != kTab) ClearAutocomplete();
 
+    // While searching, keys edit the search; the rest end it and then act
+    if (searching && HandleSearchKey(keyInt)) return;
+
     if (keyInt == 3 || keyInt == 10 || keyInt == 13) {
         // Enter/Return
         CommitInput();
@@ -174,13 +243,15 @@ void Console::HandleKey(char keyChar) {
     } else if (keyInt == kUpArrow) {
         if (historyIndex > 0) {
             historyIndex--;
-            ReplaceInput(history[historyIndex]);
+            ReplaceInput(history.Get(historyIndex));
         }
     } else if (keyInt == kDownArrow) {
-        if (historyIndex < (int)history.size()) {
+        if (historyIndex < (int)history.GetCount()) {
             historyIndex++;
-            ReplaceInput(historyIndex < (int)history.size() ? history[historyIndex] : "");
+            ReplaceInput(historyIndex < (int)history.GetCount() ? history.Get(historyIndex) : "");
         }
+    } else if (keyInt == kHistorySearch) {
+        StartHistorySearch();
     } else if (keyInt == kTab) {
         if (!curSuggestion.empty()) {
             inputBuf += curSuggestion;
@@ -198,15 +269,63 @@ void Console::HandleKey(char keyChar) {
     if (inInputMode) SetCursorForInput();
 }
 
-char Console::GetBufferedKey() {
-    if (keyBuffer.empty()) return 0;
-    char key = keyBuffer.front();
-    keyBuffer.pop();
-    return key;
+void Console::AddToHistory(const std::string& input) {
+    history.Add(input);
 }
 
-void Console::AddToHistory(const std::string& input) {
-    history.push_back(input);
+void Console::StartHistorySearch() {
+    searching = true;
+    searchQuery.clear();
+    searchMatch = -1;
+    searchFailed = false;
+    searchSavedInput = inputBuf;
+    ShowHistorySearch();
+}
+
+bool Console::HandleSearchKey(int keyInt) {
+    int newest = (int)history.GetCount() - 1;
+    if (keyInt == kHistorySearch) {
+        // Again: the next older match
+        SearchHistory(searchMatch >= 0 ? searchMatch - 1 : newest);
+    } else if (keyInt == kBackspace) {
+        if (!searchQuery.empty()) searchQuery.erase(searchQuery.length() - 1);
+        SearchHistory(newest);
+    } else if (keyInt == 27) {
+        EndHistorySearch(false);
+        return true;
+    } else if (keyInt >= 32 && keyInt != kFwdDelete) {
+        // The current match still counts, if it contains the longer query
+        searchQuery += (char)keyInt;
+        SearchHistory(searchMatch >= 0 ? searchMatch : newest);
+    } else {
+        EndHistorySearch(true);
+        return false;
+    }
+    ShowHistorySearch();
+    return true;
+}
+
+void Console::SearchHistory(int from) {
+    int found = history.Search(searchQuery, from);
+    searchFailed = found < 0;
+    if (found >= 0) searchMatch = found;
+}
+
+void Console::ShowHistorySearch() {
+    std::string match = searchMatch >= 0 ? history.Get(searchMatch) : "";
+    ReplaceInput(std::string(searchFailed ? "(failed reverse-i-search)'" : "(reverse-i-search)'") +
+                 searchQuery + "': " + match);
+}
+
+void Console::EndHistorySearch(bool acceptMatch) {
+    // Up/down arrows continue from an accepted match
+    searching = false;
+    if (acceptMatch && searchMatch >= 0) {
+        historyIndex = searchMatch;
+        ReplaceInput(history.Get(searchMatch));
+    } else {
+        ReplaceInput(searchSavedInput);
+    }
 }
 
 void Console::NoteScrolled() {
@@ -219,6 +338,11 @@ void Console::TypeInput(const std::string& text) {
     }
 }
 
+void Console::TypeInput(const std::string& text, double time) {
+    if (!text.empty() && inInputMode && (echoPendingSince < 0 || time < echoPendingSince)) echoPendingSince = time;
+    TypeInput(text);
+}
+
 void Console::ReplaceInput(const std::string& newInput) {
     display->SetCursor(inputStartPos.row, inputStartPos.col);
     for (size_t i = 0; i < inputBuf.length(); i++) {
@@ -242,34 +366,79 @@ void Console::SetCursorForInput(bool showSuggestion) {
 
     display->SetCursor(curRow, curCol);
 
+    // Any suggestion still being worked out is for older input now
+    suggestionRequest++;
     if (!showSuggestion) return;
 
+    // The index is quick enough to ask on every key; a callback may not be
     curSuggestion = "";
-    if (autocompleteCallback && inputIndex == (int)inputBuf.length()) {
-        curSuggestion = autocompleteCallback(inputBuf);
+    if (searching || inputIndex != (int)inputBuf.length()) return;
+    if (completionIndex) curSuggestion = completionIndex->Complete(CompletionIndex::LastToken(inputBuf));
+    if (curSuggestion.empty() && autocompleteCallback) {
+        if (suggestionPool) RequestSuggestion();
+        else curSuggestion = autocompleteCallback(inputBuf);
     }
+    ShowSuggestion();
+}
 
-    if (!curSuggestion.empty()) {
-        Color c = display->GetTextColor();
-        Color back = display->GetBackColor();
+void Console::ShowSuggestion() {
+    // Drawn after the cursor, which stays put
+    if (curSuggestion.empty()) return;
+    int curRow, curCol;
+    display->GetCursor(curRow, curCol);
+    Color c = display->GetTextColor();
+    Color back = display->GetBackColor();
+
+    // Blend text color with background for suggestion
+    Color blendedColor = {
+        (unsigned char)(c.r * 0.25f + back.r * 0.75f),
+        (unsigned char)(c.g * 0.25f + back.g * 0.75f),
+        (unsigned char)(c.b * 0.25f + back.b * 0.75f),
+        (unsigned char)255
+    };
+
+    display->SetTextColor(blendedColor);
+    display->Print(curSuggestion);
+    display->SetTextColor(c);
+    display->SetCursor(curRow, curCol);
+}
 
-        // Blend text color with background for suggestion
-        Color blendedColor = {
-            (unsigned char)(c.r * 0.25f + back.r * 0.75f),
-            (unsigned char)(c.g * 0.25f + back.g * 0.75f),
-            (unsigned char)(c.b * 0.25f + back.b * 0.75f),
-            (unsigned char)255
-        };
+void Console::SetAutocompleteAsync(bool async) {
+    if (async && !suggestionPool) {
+        suggestionPool = new ThreadPool(1);
+    } else if (!async && suggestionPool) {
+        delete suggestionPool;      // finishes (or skips) queued requests
+        suggestionPool = nullptr;
+    }
+}
 
-        display->SetTextColor(blendedColor);
-        display->Print(curSuggestion);
-        display->SetTextColor(c);
+void Console::RequestSuggestion() {
+    // Requests overtaken by more typing are skipped, so a slow callback
+    // never falls further behind than one call
+    unsigned int request = suggestionRequest;
+    AutocompleteCallback callback = autocompleteCallback;
+    std::string input = inputBuf;
+    suggestionPool->Submit([this, request, callback, input] {
+        if (request != suggestionRequest) return;
+        std::string suggestion = callback(input);
+        std::lock_guard<std::mutex> lock(suggestionMutex);
+        readySuggestion = suggestion;
+        readyRequest = request;
+    });
+}
 
-        for (size_t i = 0; i < curSuggestion.length(); i++) {
-            display->Backup();
-        }
-        display->SetCursor(curRow, curCol);
+void Console::ShowReadySuggestion() {
+    std::string suggestion;
+    {
+        std::lock_guard<std::mutex> lock(suggestionMutex);
+        if (readyRequest == 0) return;
+        if (readyRequest == suggestionRequest) suggestion.swap(readySuggestion);
+        readyRequest = 0;
     }
+    // Still current: nothing has moved the cursor since it was requested
+    if (!inInputMode || searching || !curSuggestion.empty()) return;
+    curSuggestion = suggestion;
+    ShowSuggestion();
 }
 
 void Console::ClearAutocomplete() {
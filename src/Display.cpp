@@ -1,7 +1,37 @@
 #include "Display.h"
+#include "RenderQueue.h"
 
-Display::Display() : visible(true) {
+Display::Display() : visible(true), scale(1.0f), scrollX(0), scrollY(0) {
 }
 
 Display::~Display() {
 }
+
+Matrix Display::ApplyTransform(const Matrix& m) const {
+    // Window coordinates run y-down, so the screen's bottom-left corner is
+    // (kScreenLeft, kScreenBottom) and scrolling up moves content down the window:
+    //   x' = kScreenLeft + (x - kScreenLeft) * scale - scrollX
+    //   y' = kScreenBottom + (y - kScreenBottom) * scale + scrollY
+    float tx = kScreenLeft * (1.0f - scale) - scrollX;
+    float ty = kScreenBottom * (1.0f - scale) + scrollY;
+
+    // Scale/translate matrix multiplied by m (transform applied first)
+    Matrix r = m;
+    r.m0 = scale * m.m0;  r.m1 = scale * m.m1;  r.m2 = scale * m.m2;  r.m3 = scale * m.m3;
+    r.m4 = scale * m.m4;  r.m5 = scale * m.m5;  r.m6 = scale * m.m6;  r.m7 = scale * m.m7;
+    r.m12 = tx * m.m0 + ty * m.m4 + m.m12;
+    r.m13 = tx * m.m1 + ty * m.m5 + m.m13;
+    r.m14 = tx * m.m2 + ty * m.m6 + m.m14;
+    r.m15 = tx * m.m3 + ty * m.m7 + m.m15;
+    return r;
+}
+
+Rectangle Display::GetVisibleArea() const {
+    return Rectangle{ scrollX / scale, scrollY / scale, (float)kScreenWidth / scale, (float)kScreenHeight / scale };
+}
+
+void Display::RenderRecorded() {
+    static RenderQueue queue;
+    queue.BeginFrame();
+    if (Record(queue)) queue.Flush();
+}
@@ -0,0 +1,301 @@
+#include "FrameCapture.h"
+#include "Qoi.h"
+#include "raylib.h"
+#include "external/glad.h"     // raylib's GL loader, for pixel buffer objects and fences
+#include <chrono>
+#include <cstring>
+
+namespace {
+    const uint32_t kVideoVersion = 1;
+    const long kFrameCountOffset = 24;  // in the .qov header (see VideoStream.h)
+
+    void WriteU32(FILE* f, uint32_t value) {
+        unsigned char bytes[4] = {
+            (unsigned char)value, (unsigned char)(value >> 8), (unsigned char)(value >> 16), (unsigned char)(value >> 24)
+        };
+        fwrite(bytes, 1, 4, f);
+    }
+}
+
+FrameCapture::FrameCapture()
+    : x(0), y(0), width(0), height(0), buffersLoaded(false), nextSlot(0),
+      videoState(kIdle), videoFile(nullptr), droppedVideoFrames(0), capturedFrames(0), droppedFrames(0),
+      lastOverheadMs(0), maxOverheadMs(0), totalOverheadMs(0), overheadFrames(0),
+      quitting(false), videoFrameCount(0) {
+    for (Slot& slot : slots) {
+        slot.buffer = 0;
+        slot.fence = nullptr;
+        slot.forVideo = false;
+    }
+}
+
+FrameCapture::~FrameCapture() {
+    // GL objects must already be gone (Unload); just don't leave the thread running
+    if (encoder.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quitting = true;
+        }
+        jobAvailable.notify_one();
+        encoder.join();
+    }
+}
+
+void FrameCapture::SetRegion(int x, int y, int width, int height) {
+    // Buffers are sized for the region when first used
+    if (buffersLoaded) return;
+    this->x = x;
+    this->y = y;
+    this->width = width;
+    this->height = height;
+}
+
+void FrameCapture::RequestScreenshot(const char* path) {
+    pendingScreenshot = path;
+}
+
+bool FrameCapture::StartRecording(const char* path, int fps) {
+    if (videoState != kIdle || fps <= 0 || width <= 0 || height <= 0) return false;
+    videoFile = fopen(path, "wb");
+    if (!videoFile) {
+        TraceLog(LOG_WARNING, "FrameCapture: Cannot write %s", path);
+        return false;
+    }
+
+    // The frame count is filled in when recording finishes
+    fwrite("QOIV", 1, 4, videoFile);
+    WriteU32(videoFile, kVideoVersion);
+    WriteU32(videoFile, (uint32_t)width);
+    WriteU32(videoFile, (uint32_t)height);
+    WriteU32(videoFile, (uint32_t)fps);
+    WriteU32(videoFile, 1);
+    WriteU32(videoFile, 0);
+    videoState = kRecording;
+    droppedVideoFrames = 0;
+    return true;
+}
+
+void FrameCapture::StopRecording() {
+    if (videoState == kRecording) videoState = kStopping;
+}
+
+bool FrameCapture::EnsureBuffers() {
+    if (buffersLoaded) return true;
+    if (width <= 0 || height <= 0) return false;
+
+    size_t size = (size_t)width * height * 4;
+    for (Slot& slot : slots) {
+        glGenBuffers(1, &slot.buffer);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)size, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    freeBuffers.resize(kMaxQueuedFrames);
+    for (std::vector<unsigned char>& buffer : freeBuffers) buffer.resize(size);
+    quitting = false;
+    encoder = std::thread(&FrameCapture::EncoderLoop, this);
+    buffersLoaded = true;
+    return true;
+}
+
+bool FrameCapture::TryCollect(Slot& slot) {
+    // Zero timeout: only poll the fence
+    GLenum status = glClientWaitSync((GLsync)slot.fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) return false;
+    glDeleteSync((GLsync)slot.fence);
+    slot.fence = nullptr;
+
+    Job job;
+    bool screenshot = !slot.screenshotPath.empty();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!freeBuffers.empty()) {
+            job.pixels.swap(freeBuffers.back());
+            freeBuffers.pop_back();
+        }
+    }
+    if (job.pixels.empty() && !screenshot) {
+        // The encoder is behind; drop this frame rather than wait for it
+        droppedFrames++;
+        if (slot.forVideo) droppedVideoFrames++;
+        return true;
+    }
+
+    size_t size = (size_t)width * height * 4;
+    job.pixels.resize(size);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)size, GL_MAP_READ_BIT);
+    if (mapped) {
+        memcpy(job.pixels.data(), mapped, size);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    job.width = width;
+    job.height = height;
+    job.screenshotPath.swap(slot.screenshotPath);
+    job.video = slot.forVideo ? videoFile : nullptr;
+    job.videoFrames = slot.forVideo ? 1 + droppedVideoFrames : 0;
+    job.finishVideo = false;
+    if (slot.forVideo) droppedVideoFrames = 0;
+    capturedFrames++;
+    Submit(job);
+    return true;
+}
+
+void FrameCapture::Submit(Job& job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+    }
+    jobAvailable.notify_one();
+}
+
+void FrameCapture::CaptureFrame(unsigned int framebuffer) {
+    bool wanted = !pendingScreenshot.empty() || videoState == kRecording;
+    bool pending = false;
+    for (const Slot& slot : slots) pending = pending || slot.fence;
+    if (!wanted && !pending && videoState != kStopping) return;
+    if (!EnsureBuffers()) return;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // Collect finished readbacks, oldest first (the ring is written in order)
+    for (int i = 0; i < kReadbackSlots; i++) {
+        Slot& slot = slots[(nextSlot + i) % kReadbackSlots];
+        if (slot.fence && !TryCollect(slot)) break;
+    }
+
+    if (wanted) {
+        Slot& slot = slots[nextSlot];
+        if (slot.fence) {
+            // The GPU is kReadbackSlots frames behind; skip this frame (a
+            // requested screenshot waits for the next one)
+            droppedFrames++;
+            if (videoState == kRecording) droppedVideoFrames++;
+        } else {
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+            glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+            slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            slot.forVideo = videoState == kRecording;
+            slot.screenshotPath.swap(pendingScreenshot);
+            pendingScreenshot.clear();
+            nextSlot = (nextSlot + 1) % kReadbackSlots;
+        }
+    }
+
+    // A stopped video is finished once its last frames are collected
+    if (videoState == kStopping) {
+        bool videoPending = false;
+        for (const Slot& slot : slots) videoPending = videoPending || (slot.fence && slot.forVideo);
+        if (!videoPending) {
+            Job job;
+            job.width = job.height = 0;
+            job.video = videoFile;
+            job.videoFrames = 0;
+            job.finishVideo = true;
+            Submit(job);
+            videoFile = nullptr;
+            videoState = kIdle;
+        }
+    }
+
+    lastOverheadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (lastOverheadMs > maxOverheadMs) maxOverheadMs = lastOverheadMs;
+    totalOverheadMs += lastOverheadMs;
+    overheadFrames++;
+}
+
+void FrameCapture::Unload() {
+    if (!buffersLoaded) {
+        if (videoFile) fclose(videoFile);
+        videoFile = nullptr;
+        videoState = kIdle;
+        return;
+    }
+
+    // Shutting down, so waiting is fine: collect every outstanding readback
+    StopRecording();
+    for (int i = 0; i < kReadbackSlots; i++) {
+        Slot& slot = slots[(nextSlot + i) % kReadbackSlots];
+        if (!slot.fence) continue;
+        glClientWaitSync((GLsync)slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000ull);
+        TryCollect(slot);
+        if (slot.fence) {
+            glDeleteSync((GLsync)slot.fence);
+            slot.fence = nullptr;
+        }
+    }
+    pendingScreenshot.clear();
+    CaptureFrame(0);     // submits the video's finishing job
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quitting = true;
+    }
+    jobAvailable.notify_one();
+    encoder.join();
+
+    for (Slot& slot : slots) {
+        glDeleteBuffers(1, &slot.buffer);
+        slot.buffer = 0;
+    }
+    freeBuffers.clear();
+    buffersLoaded = false;
+    if (capturedFrames > 0) {
+        TraceLog(LOG_INFO, "FrameCapture: %d frames captured, %d dropped; overhead %.3f ms average, %.3f ms max per frame",
+                 capturedFrames, droppedFrames, GetAverageOverheadMs(), maxOverheadMs);
+    }
+}
+
+void FrameCapture::EncoderLoop() {
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobAvailable.wait(lock, [this] { return !jobs.empty() || quitting; });
+            if (jobs.empty()) return;   // quitting, and all work done
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        if (!job.pixels.empty()) {
+            // Read back bottom-up; images and video frames are top-down
+            size_t rowBytes = (size_t)job.width * 4;
+            flipped.resize(rowBytes * job.height);
+            for (int row = 0; row < job.height; row++) {
+                memcpy(&flipped[row * rowBytes], &job.pixels[(size_t)(job.height - 1 - row) * rowBytes], rowBytes);
+            }
+
+            if (!job.screenshotPath.empty()) {
+                Image image = { flipped.data(), job.width, job.height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+                if (!ExportImage(image, job.screenshotPath.c_str())) {
+                    TraceLog(LOG_WARNING, "FrameCapture: Cannot write %s", job.screenshotPath.c_str());
+                }
+            }
+            if (job.video && job.videoFrames > 0) {
+                // Frames dropped just before this one repeat it, keeping the timing
+                encoded.clear();
+                Qoi::Encode(flipped.data(), job.width, job.height, encoded);
+                for (int i = 0; i < job.videoFrames; i++) {
+                    WriteU32(job.video, (uint32_t)encoded.size());
+                    fwrite(encoded.data(), 1, encoded.size(), job.video);
+                }
+                videoFrameCount += job.videoFrames;
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            freeBuffers.push_back(std::move(job.pixels));
+        }
+
+        if (job.finishVideo && job.video) {
+            fseek(job.video, kFrameCountOffset, SEEK_SET);
+            WriteU32(job.video, (uint32_t)videoFrameCount);
+            fclose(job.video);
+            videoFrameCount = 0;
+        }
+    }
+}
@@ -0,0 +1,126 @@
+#include "GradientDisplay.h"
+#include "rlgl.h"
+
+namespace {
+    const Color kDefaultTop = { 33, 33, 99, 255 };
+    const Color kDefaultBottom = { 0, 0, 0, 255 };
+}
+
+// Static member initialization
+Shader GradientDisplay::shader = {0};
+int GradientDisplay::startPointLoc = -1;
+int GradientDisplay::endPointLoc = -1;
+int GradientDisplay::stopCountLoc = -1;
+int GradientDisplay::stopColorsLoc = -1;
+int GradientDisplay::stopPositionsLoc = -1;
+bool GradientDisplay::shaderLoaded = false;
+
+GradientDisplay::GradientDisplay() {
+    Clear();
+}
+
+GradientDisplay::~GradientDisplay() {
+}
+
+bool GradientDisplay::LoadShader(const char* vertexPath, const char* fragmentPath) {
+    if (shaderLoaded) {
+        ::UnloadShader(shader);
+    }
+
+    shader = ::LoadShader(vertexPath, fragmentPath);
+    if (shader.id == 0) {
+        shaderLoaded = false;
+        return false;
+    }
+
+    startPointLoc = GetShaderLocation(shader, "startPoint");
+    endPointLoc = GetShaderLocation(shader, "endPoint");
+    stopCountLoc = GetShaderLocation(shader, "stopCount");
+    stopColorsLoc = GetShaderLocation(shader, "stopColors");
+    stopPositionsLoc = GetShaderLocation(shader, "stopPositions");
+    shaderLoaded = true;
+
+    return true;
+}
+
+void GradientDisplay::UnloadShader() {
+    if (shaderLoaded) {
+        ::UnloadShader(shader);
+        shaderLoaded = false;
+    }
+}
+
+void GradientDisplay::Clear() {
+    startPoint = Vector2{ kScreenWidth / 2.0f, (float)kScreenHeight };
+    endPoint = Vector2{ kScreenWidth / 2.0f, 0 };
+    Color defaults[2] = { kDefaultTop, kDefaultBottom };
+    SetStops(defaults, nullptr, 2);
+}
+
+void GradientDisplay::SetStops(const Color* colors, const float* positions, int count) {
+    if (count < 1) return;
+    if (count > kMaxStops) count = kMaxStops;
+    for (int i = 0; i < count; i++) {
+        this->colors[i] = colors[i];
+        if (positions) this->positions[i] = positions[i];
+        else this->positions[i] = count > 1 ? (float)i / (count - 1) : 0.0f;
+    }
+    stopCount = count;
+}
+
+Color GradientDisplay::GetStopColor(int index) const {
+    if (index < 0 || index >= stopCount) return BLANK;
+    return colors[index];
+}
+
+bool GradientDisplay::IsOpaque() const {
+    // A transformed quad may not cover the whole screen
+    if (!visible || HasTransform()) return false;
+    for (int i = 0; i < stopCount; i++) {
+        if (colors[i].a < 255) return false;
+    }
+    return true;
+}
+
+void GradientDisplay::Render() {
+    if (!visible) return;
+
+    if (!shaderLoaded) {
+        // No shader: show the first stop rather than rasterizing on the CPU
+        DrawRectangle(kScreenLeft, kScreenTop, kScreenWidth, kScreenHeight, colors[0]);
+        return;
+    }
+
+    float stopColors[kMaxStops * 4];
+    for (int i = 0; i < stopCount; i++) {
+        stopColors[i * 4 + 0] = colors[i].r / 255.0f;
+        stopColors[i * 4 + 1] = colors[i].g / 255.0f;
+        stopColors[i * 4 + 2] = colors[i].b / 255.0f;
+        stopColors[i * 4 + 3] = colors[i].a / 255.0f;
+    }
+    SetShaderValue(shader, startPointLoc, &startPoint, SHADER_UNIFORM_VEC2);
+    SetShaderValue(shader, endPointLoc, &endPoint, SHADER_UNIFORM_VEC2);
+    SetShaderValue(shader, stopCountLoc, &stopCount, SHADER_UNIFORM_INT);
+    SetShaderValueV(shader, stopColorsLoc, stopColors, SHADER_UNIFORM_VEC4, stopCount);
+    SetShaderValueV(shader, stopPositionsLoc, positions, SHADER_UNIFORM_FLOAT, stopCount);
+
+    // One screen-sized quad; texture coordinates carry the bottom-up
+    // screen position for the fragment shader
+    const float left = kScreenLeft, right = kScreenLeft + kScreenWidth;
+    const float top = kScreenTop, bottom = kScreenBottom;
+    BeginShaderMode(shader);
+    rlSetTexture(rlGetTextureIdDefault());
+    rlBegin(RL_QUADS);
+    rlColor4ub(255, 255, 255, 255);
+    rlTexCoord2f(0, kScreenHeight);
+    rlVertex2f(left, top);
+    rlTexCoord2f(0, 0);
+    rlVertex2f(left, bottom);
+    rlTexCoord2f(kScreenWidth, 0);
+    rlVertex2f(right, bottom);
+    rlTexCoord2f(kScreenWidth, kScreenHeight);
+    rlVertex2f(right, top);
+    rlEnd();
+    rlSetTexture(0);
+    EndShaderMode();
+}
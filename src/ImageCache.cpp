@@ -0,0 +1,199 @@
+#include "ImageCache.h"
+#include "ResourcePath.h"
+#include "ResourceArchive.h"
+#include "MappedFile.h"
+#include "Qoi.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+namespace {
+    const char kMagic[4] = { 'M', 'M', 'I', 'C' };
+    const uint32_t kVersion = 1;
+
+    // Header of a cache entry; the QOI data follows
+    struct CacheHeader {
+        char magic[4];
+        uint32_t version;
+        uint64_t sourceSize;
+        int64_t sourceModTime;  // 0 if unknown (e.g. source is in the archive)
+        uint64_t sourceHash;
+        uint64_t decodeMicros;  // how long decoding the source took
+    };
+
+    std::atomic<bool> enabled(true);
+    std::atomic<int> hitCount(0);
+    std::atomic<int> missCount(0);
+    std::atomic<long long> microsSaved(0);
+
+    long long MicrosSince(std::chrono::steady_clock::time_point start) {
+        return (long long)std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+
+    uint64_t HashData(const unsigned char* data, size_t size) {
+        // FNV-1a, 8 bytes at a time
+        uint64_t hash = 14695981039346656037ULL;
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            uint64_t word;
+            memcpy(&word, data + i, 8);
+            hash = (hash ^ word) * 1099511628211ULL;
+        }
+        for (; i < size; i++) hash = (hash ^ data[i]) * 1099511628211ULL;
+        return hash ^ size;
+    }
+
+    std::string EntryPath(const char* relativePath) {
+        std::string folder = GetCacheFolder();
+        if (folder.empty()) return "";
+        char name[32];
+        uint64_t pathHash = ResourceArchiveFormat::HashPath(relativePath, strlen(relativePath));
+        snprintf(name, sizeof(name), "/%016llx.mmic", (unsigned long long)pathHash);
+        return folder + name;
+    }
+
+    // Decode the QOI payload of a mapped cache entry
+    Image DecodeEntry(const MappedFile& entry) {
+        Image image = Image{};
+        const unsigned char* qoi = entry.GetData() + sizeof(CacheHeader);
+        size_t qoiSize = entry.GetSize() - sizeof(CacheHeader);
+        int width, height;
+        if (!Qoi::ReadHeader(qoi, qoiSize, &width, &height)) return image;
+
+        unsigned char* pixels = (unsigned char*)MemAlloc((unsigned int)width * height * 4);
+        if (!Qoi::Decode(qoi, qoiSize, pixels, width, height)) {
+            MemFree(pixels);
+            return image;
+        }
+        image.data = pixels;
+        image.width = width;
+        image.height = height;
+        image.mipmaps = 1;
+        image.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+        return image;
+    }
+
+    void WriteEntry(const std::string& path, const CacheHeader& header, const Image& image) {
+        std::vector<unsigned char> qoi;
+        Qoi::Encode((const unsigned char*)image.data, image.width, image.height, qoi);
+
+        // Write to a temporary file and rename, so readers never see half an entry
+        std::string tempPath = path + ".tmp";
+        FILE* f = fopen(tempPath.c_str(), "wb");
+        if (!f) return;
+        bool ok = fwrite(&header, sizeof(header), 1, f) == 1
+               && fwrite(qoi.data(), 1, qoi.size(), f) == qoi.size();
+        ok = (fclose(f) == 0) && ok;
+        if (ok) ok = (rename(tempPath.c_str(), path.c_str()) == 0);
+        if (!ok) remove(tempPath.c_str());
+    }
+}
+
+Image ImageCache::Load(const char* relativePath) {
+    auto start = std::chrono::steady_clock::now();
+    std::string entryPath = enabled ? EntryPath(relativePath) : "";
+
+    // Size and modification time of the loose source file, if there is one
+    struct stat info;
+    bool haveStat = (stat(GetResourceFile(relativePath).c_str(), &info) == 0);
+    uint64_t sourceSize = haveStat ? (uint64_t)info.st_size : 0;
+    int64_t sourceModTime = haveStat ? (int64_t)info.st_mtime : 0;
+
+    MappedFile entry;
+    const CacheHeader* header = nullptr;
+    if (!entryPath.empty() && entry.Open(entryPath.c_str()) && entry.GetSize() > sizeof(CacheHeader)) {
+        header = (const CacheHeader*)entry.GetData();
+        if (memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 || header->version != kVersion) header = nullptr;
+    }
+
+    // Fast path: source unchanged since the entry was written
+    if (header && haveStat && sourceModTime != 0
+        && header->sourceSize == sourceSize && header->sourceModTime == sourceModTime) {
+        Image image = DecodeEntry(entry);
+        if (image.data) {
+            hitCount++;
+            microsSaved += (long long)header->decodeMicros - MicrosSince(start);
+            return image;
+        }
+    }
+
+    ResourceData data;
+    if (!data.Load(relativePath)) return Image{};
+    uint64_t sourceHash = HashData(data.GetData(), data.GetSize());
+
+    // Touched but identical source: still a hit
+    if (header && header->sourceSize == data.GetSize() && header->sourceHash == sourceHash) {
+        Image image = DecodeEntry(entry);
+        if (image.data) {
+            hitCount++;
+            microsSaved += (long long)header->decodeMicros - MicrosSince(start);
+            if (header->sourceModTime != sourceModTime) {
+                // Record the new time, so next launch takes the fast path
+                CacheHeader newHeader = *header;
+                newHeader.sourceModTime = sourceModTime;
+                entry.Close();
+                FILE* f = fopen(entryPath.c_str(), "r+b");
+                if (f) {
+                    fwrite(&newHeader, sizeof(newHeader), 1, f);
+                    fclose(f);
+                }
+            }
+            return image;
+        }
+    }
+    entry.Close();
+
+    // Miss: decode the source, and cache the result
+    auto decodeStart = std::chrono::steady_clock::now();
+    const char* fileType = GetFileExtension(relativePath);
+    Image image = LoadImageFromMemory(fileType, data.GetData(), (int)data.GetSize());
+    if (!image.data) return image;
+    ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    long long decodeMicros = MicrosSince(decodeStart);
+    missCount++;
+
+    if (!entryPath.empty()) {
+        CacheHeader newHeader;
+        memset(&newHeader, 0, sizeof(newHeader));
+        memcpy(newHeader.magic, kMagic, sizeof(kMagic));
+        newHeader.version = kVersion;
+        newHeader.sourceSize = data.GetSize();
+        newHeader.sourceModTime = sourceModTime;
+        newHeader.sourceHash = sourceHash;
+        newHeader.decodeMicros = (uint64_t)decodeMicros;
+        WriteEntry(entryPath, newHeader, image);
+    }
+    return image;
+}
+
+void ImageCache::Remove(const char* relativePath) {
+    std::string entryPath = EntryPath(relativePath);
+    if (!entryPath.empty()) remove(entryPath.c_str());
+}
+
+void ImageCache::SetEnabled(bool enable) {
+    enabled = enable;
+}
+
+bool ImageCache::IsEnabled() {
+    return enabled;
+}
+
+int ImageCache::GetHitCount() {
+    return hitCount;
+}
+
+int ImageCache::GetMissCount() {
+    return missCount;
+}
+
+double ImageCache::GetSecondsSaved() {
+    return microsSaved / 1000000.0;
+}
@@ -0,0 +1,178 @@
+#include "InputLog.h"
+#include "raylib.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+    const char kMagic[4] = { 'M', 'M', 'I', 'L' };
+    const unsigned char kVersion = 1;
+    const int kMouseButtons = 7;        // MOUSE_BUTTON_LEFT .. MOUSE_BUTTON_BACK
+    const int kGamepadButtons = 18;     // GAMEPAD_BUTTON_UNKNOWN .. GAMEPAD_BUTTON_RIGHT_THUMB
+    const int kGamepadAxes = 6;
+}
+
+InputLog::InputLog() : readPos(0), recording(false), frameCount(0), mouseX(0), mouseY(0) {
+    for (int i = 0; i < kGamepadAxes; i++) axes[i] = 0;
+}
+
+void InputLog::StartRecording() {
+    data.assign(kMagic, kMagic + 4);
+    data.push_back(kVersion);
+    recording = true;
+    frameCount = 0;
+    mouseX = mouseY = -1;
+    for (int i = 0; i < kGamepadAxes; i++) axes[i] = 0;
+}
+
+void InputLog::WriteVarint(uint32_t value) {
+    while (value >= 0x80) {
+        data.push_back((unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    data.push_back((unsigned char)value);
+}
+
+bool InputLog::ReadVarint(uint32_t& out) {
+    out = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (readPos >= data.size()) return false;
+        unsigned char byte = data[readPos++];
+        out |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+bool InputLog::ReadSigned(int& out) {
+    uint32_t value;
+    if (!ReadVarint(value)) return false;
+    out = (int)(value >> 1) ^ -(int)(value & 1);
+    return true;
+}
+
+void InputLog::BeginFrame(float deltaTime) {
+    if (!recording) return;
+    data.push_back(kFrame);
+    WriteVarint((uint32_t)lroundf(deltaTime * 1000000.0f));
+    frameCount++;
+}
+
+void InputLog::RecordKey(char key) {
+    if (!recording) return;
+    data.push_back(kKey);
+    WriteVarint((unsigned char)key);
+}
+
+void InputLog::RecordEvent(int type, int a, int b) {
+    if (!recording) return;
+    data.push_back((unsigned char)type);
+    WriteSigned(a);
+    WriteSigned(b);
+}
+
+void InputLog::CaptureDevices() {
+    if (!recording) return;
+
+    Vector2 mouse = GetMousePosition();
+    int x = (int)mouse.x, y = (int)mouse.y;
+    if (x != mouseX || y != mouseY) {
+        RecordEvent(kMouseMove, x, y);
+        mouseX = x;
+        mouseY = y;
+    }
+    for (int button = 0; button < kMouseButtons; button++) {
+        if (IsMouseButtonPressed(button)) RecordEvent(kMouseButton, button, 1);
+        if (IsMouseButtonReleased(button)) RecordEvent(kMouseButton, button, 0);
+    }
+
+    if (!IsGamepadAvailable(0)) return;
+    for (int button = 1; button < kGamepadButtons; button++) {
+        if (IsGamepadButtonPressed(0, button)) RecordEvent(kGamepadButton, button, 1);
+        if (IsGamepadButtonReleased(0, button)) RecordEvent(kGamepadButton, button, 0);
+    }
+    int axisCount = GetGamepadAxisCount(0);
+    for (int axis = 0; axis < axisCount && axis < kGamepadAxes; axis++) {
+        float position = GetGamepadAxisMovement(0, axis);
+        if ((int)(position * 32767) != (int)(axes[axis] * 32767)) {
+            RecordEvent(kGamepadAxis, axis, (int)(position * 32767));
+            axes[axis] = position;
+        }
+    }
+}
+
+bool InputLog::Save(const char* path) const {
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        TraceLog(LOG_WARNING, "InputLog: Cannot write %s", path);
+        return false;
+    }
+    bool ok = fwrite(data.data(), 1, data.size(), f) == data.size();
+    fclose(f);
+    return ok;
+}
+
+bool InputLog::Load(const char* path) {
+    recording = false;
+    frameCount = 0;
+    data.clear();
+    readPos = 0;
+
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        TraceLog(LOG_WARNING, "InputLog: Cannot open %s", path);
+        return false;
+    }
+    unsigned char buffer[4096];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) data.insert(data.end(), buffer, buffer + n);
+    fclose(f);
+
+    if (data.size() < 5 || memcmp(data.data(), kMagic, 4) != 0 || data[4] != kVersion) {
+        TraceLog(LOG_WARNING, "InputLog: %s is not an input log", path);
+        data.clear();
+        return false;
+    }
+    readPos = 5;
+
+    // Count frames up front, so replay can report progress
+    while (readPos < data.size()) {
+        int type = data[readPos++];
+        uint32_t value;
+        int a, b;
+        if (type == kFrame) {
+            if (!ReadVarint(value)) break;
+            frameCount++;
+        } else if (type == kKey) {
+            if (!ReadVarint(value)) break;
+        } else if (!ReadSigned(a) || !ReadSigned(b)) {
+            break;
+        }
+    }
+    readPos = 5;
+    return true;
+}
+
+bool InputLog::ReadFrame(float& outDeltaTime, std::vector<Event>& outEvents) {
+    outEvents.clear();
+    if (readPos >= data.size() || data[readPos] != kFrame) return false;
+    readPos++;
+    uint32_t micros;
+    if (!ReadVarint(micros)) return false;
+    outDeltaTime = micros / 1000000.0f;
+
+    while (readPos < data.size() && data[readPos] != kFrame) {
+        Event event;
+        event.type = data[readPos++];
+        event.a = event.b = 0;
+        if (event.type == kKey) {
+            uint32_t key;
+            if (!ReadVarint(key)) return false;
+            event.a = (int)key;
+        } else if (!ReadSigned(event.a) || !ReadSigned(event.b)) {
+            return false;
+        }
+        outEvents.push_back(event);
+    }
+    return true;
+}
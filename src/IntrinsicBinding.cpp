@@ -0,0 +1,34 @@
+#include "IntrinsicBinding.h"
+#include <cstdio>
+
+// Value of one hex digit, or -1
+static int HexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+Color ColorFromScript(const char* s) {
+    Color result = { 0, 0, 0, 255 };
+    if (!s) return result;
+    if (*s == '#') s++;
+
+    unsigned char* channels[4] = { &result.r, &result.g, &result.b, &result.a };
+    for (int i = 0; i < 4; i++) {
+        if (!s[0] || !s[1]) break;
+        int hi = HexDigit(s[0]);
+        int lo = HexDigit(s[1]);
+        if (hi < 0 || lo < 0) break;
+        *channels[i] = (unsigned char)(hi * 16 + lo);
+        s += 2;
+    }
+    return result;
+}
+
+MiniScript::String ColorToScript(Color c) {
+    char buf[10];
+    if (c.a == 255) snprintf(buf, sizeof(buf), "#%02X%02X%02X", c.r, c.g, c.b);
+    else snprintf(buf, sizeof(buf), "#%02X%02X%02X%02X", c.r, c.g, c.b, c.a);
+    return MiniScript::String(buf);
+}
@@ -0,0 +1,224 @@
+#include "LineReader.h"
+#include "raylib.h"
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define LINE_SSE 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define LINE_NEON 1
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+    // 32-bit builds keep most of their address space for everything else
+    const uint64_t kDefaultMapBudget = sizeof(void*) >= 8 ? (uint64_t)1 << 40 : (uint64_t)256 << 20;
+
+    inline int LowestBit(uint32_t mask) {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return (int)index;
+#else
+        return __builtin_ctz(mask);
+#endif
+    }
+
+    int SeekTo(FILE* f, uint64_t offset) {
+#ifdef _WIN32
+        return _fseeki64(f, (long long)offset, SEEK_SET);
+#else
+        return fseeko(f, (off_t)offset, SEEK_SET);
+#endif
+    }
+
+    uint64_t FileSize(FILE* f) {
+#ifdef _WIN32
+        _fseeki64(f, 0, SEEK_END);
+        uint64_t size = (uint64_t)_ftelli64(f);
+#else
+        fseeko(f, 0, SEEK_END);
+        uint64_t size = (uint64_t)ftello(f);
+#endif
+        SeekTo(f, 0);
+        return size;
+    }
+}
+
+uint64_t LineReader::mapBudget = kDefaultMapBudget;
+
+LineReader::LineReader()
+    : data(nullptr), size(0), isOpen(false), nextLine(0), stream(nullptr), chunkStart(0), chunkLength(0) {
+}
+
+LineReader::~LineReader() {
+    Close();
+}
+
+void LineReader::Close() {
+    file.Close();
+    if (stream) fclose(stream);
+    stream = nullptr;
+    data = nullptr;
+    size = 0;
+    isOpen = false;
+    lineStarts.clear();
+    nextLine = 0;
+    chunk.clear();
+    chunkStart = 0;
+    chunkLength = 0;
+}
+
+void LineReader::IndexLines(const unsigned char* bytes, size_t count, uint64_t offset) {
+    // Each newline starts a line at the byte after it
+    size_t i = 0;
+#if defined(LINE_SSE)
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; i + 64 <= count; i += 64) {
+        uint32_t m0 = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(bytes + i)), newline));
+        uint32_t m1 = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(bytes + i + 16)), newline));
+        uint32_t m2 = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(bytes + i + 32)), newline));
+        uint32_t m3 = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(bytes + i + 48)), newline));
+        uint32_t low = m0 | m1 << 16;
+        uint32_t high = m2 | m3 << 16;
+        while (low) {
+            lineStarts.push_back(offset + i + LowestBit(low) + 1);
+            low &= low - 1;
+        }
+        while (high) {
+            lineStarts.push_back(offset + i + 32 + LowestBit(high) + 1);
+            high &= high - 1;
+        }
+    }
+#elif defined(LINE_NEON)
+    const uint8x16_t newline = vdupq_n_u8('\n');
+    for (; i + 16 <= count; i += 16) {
+        uint8x16_t hits = vceqq_u8(vld1q_u8(bytes + i), newline);
+        uint64x2_t lanes = vreinterpretq_u64_u8(hits);
+        if ((vgetq_lane_u64(lanes, 0) | vgetq_lane_u64(lanes, 1)) == 0) continue;
+        for (size_t j = i; j < i + 16; j++) {
+            if (bytes[j] == '\n') lineStarts.push_back(offset + j + 1);
+        }
+    }
+#endif
+    for (; i < count; i++) {
+        if (bytes[i] == '\n') lineStarts.push_back(offset + i + 1);
+    }
+}
+
+bool LineReader::Open(const char* path) {
+    Close();
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        TraceLog(LOG_WARNING, "LineReader: Cannot open %s", path);
+        return false;
+    }
+    uint64_t fileSize = FileSize(f);
+
+    if (fileSize <= mapBudget) {
+        fclose(f);
+        // An empty file has no lines (and cannot be mapped)
+        if (fileSize > 0) {
+            if (!file.Open(path)) {
+                TraceLog(LOG_WARNING, "LineReader: Cannot map %s", path);
+                return false;
+            }
+            data = file.GetData();
+            size = file.GetSize();
+        }
+        IndexData();
+        return true;
+    }
+
+    stream = f;
+    size = fileSize;
+    if (!IndexStream()) {
+        TraceLog(LOG_WARNING, "LineReader: Error reading %s", path);
+        Close();
+        return false;
+    }
+    isOpen = true;
+    return true;
+}
+
+bool LineReader::OpenMemory(const unsigned char* bytes, size_t count) {
+    Close();
+    data = bytes;
+    size = count;
+    IndexData();
+    return true;
+}
+
+void LineReader::IndexData() {
+    if (size > 0) {
+        lineStarts.push_back(0);
+        IndexLines(data, (size_t)size, 0);
+        if (lineStarts.back() == size) lineStarts.pop_back();
+    }
+    isOpen = true;
+}
+
+bool LineReader::IndexStream() {
+    chunk.resize(kChunkSize);
+    lineStarts.clear();
+    if (size > 0) lineStarts.push_back(0);
+    uint64_t offset = 0;
+    while (offset < size) {
+        size_t count = fread(chunk.data(), 1, kChunkSize, stream);
+        if (count == 0) return false;
+        IndexLines(chunk.data(), count, offset);
+        offset += count;
+    }
+    if (!lineStarts.empty() && lineStarts.back() == size) lineStarts.pop_back();
+    chunkLength = 0;        // the buffer no longer matches chunkStart
+    return true;
+}
+
+bool LineReader::LoadChunk(uint64_t start, size_t minLength) {
+    // Lines longer than a chunk get a window of their own size
+    if (chunk.size() < minLength) chunk.resize(minLength);
+    size_t length = chunk.size();
+    if (start + length > size) length = (size_t)(size - start);
+    if (SeekTo(stream, start) != 0 || fread(chunk.data(), 1, length, stream) != length) {
+        chunkLength = 0;
+        return false;
+    }
+    chunkStart = start;
+    chunkLength = length;
+    return true;
+}
+
+bool LineReader::GetLine(size_t line, const char** outText, size_t* outLength) {
+    if (line >= lineStarts.size()) return false;
+    uint64_t start = lineStarts[line];
+    uint64_t end = line + 1 < lineStarts.size() ? lineStarts[line + 1] : size;
+
+    const unsigned char* text;
+    if (!stream) {
+        text = data + start;
+    } else {
+        if (start < chunkStart || end > chunkStart + chunkLength) {
+            if (!LoadChunk(start, (size_t)(end - start))) return false;
+        }
+        text = chunk.data() + (start - chunkStart);
+    }
+
+    size_t length = (size_t)(end - start);
+    if (length > 0 && text[length - 1] == '\n') length--;
+    if (length > 0 && text[length - 1] == '\r') length--;
+    *outText = (const char*)text;
+    *outLength = length;
+    return true;
+}
+
+bool LineReader::GetLine(size_t line, std::string& out) {
+    const char* text;
+    size_t length;
+    if (!GetLine(line, &text, &length)) return false;
+    out.assign(text, length);
+    return true;
+}
@@ -1,7 +1,9 @@
 #include "Machine.h"
 #include "SolidColorDisplay.h"
+#include "SoftwareRenderer.h"
+#include "rlgl.h"
 
-Machine::Machine() {
+Machine::Machine() : softwareRenderer(nullptr) {
     // Initialize all 8 display layers with SolidColorDisplay by default
     displays.resize(kDisplayCount, nullptr);
     for (int i = 0; i < kDisplayCount; i++) {
@@ -15,11 +17,21 @@ Machine::~Machine() {
         delete display;
     }
     displays.clear();
+    delete softwareRenderer;
 }
 
-void Machine::Update() {
+void Machine::SetSoftwareRendering(bool enabled) {
+    if (enabled == IsSoftwareRendering()) return;
+    if (enabled) {
+        softwareRenderer = new SoftwareRenderer();
+    } else {
+        delete softwareRenderer;
+        softwareRenderer = nullptr;
+    }
+}
+
+void Machine::Update(float deltaTime) {
     // Update all displays (for cursor blinking, animations, etc.)
-    float deltaTime = GetFrameTime();
     for (int i = 0; i < kDisplayCount; i++) {
         if (displays[i]) {
             displays[i]->Update(deltaTime);
@@ -29,11 +41,48 @@ void Machine::Update() {
 }
 
 void Machine::Render() {
+    // Frames the software renderer can't draw fall through to the GL path
+    if (softwareRenderer && softwareRenderer->Rasterize(*this)) {
+        softwareRenderer->Present();
+        return;
+    }
+
     // Render each display in reverse order (7 down to 0)
-    // so that display 0 is on top
-    for (int i = kDisplayCount - 1; i >= 0; i--) {
-        if (displays[i]) displays[i]->Render();
+    // so that display 0 is on top, starting at the topmost opaque one
+    int first = kDisplayCount - 1;
+    for (int i = 0; i < kDisplayCount; i++) {
+        if (displays[i] && displays[i]->IsOpaque()) {
+            first = i;
+            break;
+        }
+    }
+
+    // Layers that can record into the queue share its batches; the rest
+    // draw immediately, after the queue flushes what lies beneath them
+    renderQueue.BeginFrame();
+    for (int i = first; i >= 0; i--) {
+        Display* display = displays[i];
+        if (!display || !display->IsVisible()) continue;
+        if (!display->HasTransform()) {
+            if (!display->Record(renderQueue)) {
+                renderQueue.Flush();
+                display->Render();
+            }
+            continue;
+        }
+
+        // Scissoring flushes the batch, so the previous layers draw with the
+        // plain matrix and this layer's vertices all get its own
+        renderQueue.Flush();
+        BeginScissorMode(Display::kScreenLeft, Display::kScreenTop, Display::kScreenWidth, Display::kScreenHeight);
+        Matrix saved = rlGetMatrixModelview();
+        rlSetMatrixModelview(display->ApplyTransform(saved));
+        if (display->Record(renderQueue)) renderQueue.Flush();
+        else display->Render();
+        EndScissorMode();
+        rlSetMatrixModelview(saved);
     }
+    renderQueue.Flush();
 }
 
 Display* Machine::GetDisplay(int index) {
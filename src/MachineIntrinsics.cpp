@@ -0,0 +1,265 @@
+#include "MachineIntrinsics.h"
+#include "Machine.h"
+#include "TextDisplay.h"
+#include "PixelDisplay.h"
+#include "SpriteDisplay.h"
+#include <cstring>
+
+static Machine* targetMachine = nullptr;
+static TextDisplay* targetText = nullptr;
+
+void SetIntrinsicTargets(Machine* machine, TextDisplay* text) {
+    targetMachine = machine;
+    targetText = text;
+}
+
+//--------------------------------------------------------------------------------
+// text
+
+static int TextRow() {
+    if (!targetText) return 0;
+    int row, col;
+    targetText->GetCursor(row, col);
+    return row;
+}
+
+static int TextColumn() {
+    if (!targetText) return 0;
+    int row, col;
+    targetText->GetCursor(row, col);
+    return col;
+}
+
+static void TextSetCursor(int row, int column) {
+    if (targetText) targetText->SetCursor(row, column);
+}
+
+static void TextPrint(MiniScript::String s) {
+    if (!targetText) return;
+    targetText->Print(s.c_str());
+    targetText->Put('\n');
+}
+
+static void TextClear() {
+    if (targetText) targetText->Clear();
+}
+
+static Color TextColor() {
+    return targetText ? targetText->GetTextColor() : WHITE;
+}
+
+static void TextSetColor(Color c) {
+    if (targetText) targetText->SetTextColor(c);
+}
+
+static Color TextBackColor() {
+    return targetText ? targetText->GetBackColor() : BLANK;
+}
+
+static void TextSetBackColor(Color c) {
+    if (targetText) targetText->SetBackColor(c);
+}
+
+static bool TextInverse() {
+    return targetText ? targetText->GetInverse() : false;
+}
+
+static void TextSetInverse(bool inverse) {
+    if (targetText) targetText->SetInverse(inverse);
+}
+
+static MiniScript::String TextCell(int x, int y) {
+    TextDisplay::Cell* cell = targetText ? targetText->Get(y, x) : nullptr;
+    if (!cell) return MiniScript::String("");
+    char buf[2] = { cell->character, '\0' };
+    return MiniScript::String(buf);
+}
+
+static void TextSetCell(int x, int y, MiniScript::String k) {
+    if (!targetText) return;
+    const char* s = k.c_str();
+    targetText->Set(y, x, s[0] ? s[0] : ' ');
+}
+
+//--------------------------------------------------------------------------------
+// gfx (the PixelDisplay in layer 5, as in Mini Micro)
+
+static PixelDisplay* Gfx() {
+    return targetMachine ? dynamic_cast<PixelDisplay*>(targetMachine->GetDisplay(5)) : nullptr;
+}
+
+static void GfxClear(Color color) {
+    if (PixelDisplay* gfx = Gfx()) gfx->Clear(color);
+}
+
+static Color GfxPixel(int x, int y) {
+    PixelDisplay* gfx = Gfx();
+    return gfx ? gfx->GetPixel(x, y) : BLANK;
+}
+
+static void GfxSetPixel(int x, int y, Color color) {
+    if (PixelDisplay* gfx = Gfx()) gfx->SetPixel(x, y, color);
+}
+
+static void GfxLine(int x1, int y1, int x2, int y2, Color color, int penSize) {
+    if (PixelDisplay* gfx = Gfx()) gfx->Line(x1, y1, x2, y2, color, penSize);
+}
+
+static void GfxFillRect(int left, int bottom, int width, int height, Color color) {
+    if (PixelDisplay* gfx = Gfx()) gfx->FillRect(left, bottom, width, height, color);
+}
+
+static void GfxDrawRect(int left, int bottom, int width, int height, Color color, int penSize) {
+    if (PixelDisplay* gfx = Gfx()) gfx->DrawRect(left, bottom, width, height, color, penSize);
+}
+
+static void GfxFillEllipse(int left, int bottom, int width, int height, Color color) {
+    if (PixelDisplay* gfx = Gfx()) gfx->FillEllipse(left, bottom, width, height, color);
+}
+
+static void GfxDrawEllipse(int left, int bottom, int width, int height, Color color, int penSize) {
+    if (PixelDisplay* gfx = Gfx()) gfx->DrawEllipse(left, bottom, width, height, color, penSize);
+}
+
+static void GfxFloodFill(int x, int y, Color color) {
+    if (PixelDisplay* gfx = Gfx()) gfx->FloodFill(x, y, color);
+}
+
+//--------------------------------------------------------------------------------
+// sprites (the SpriteDisplay in layer 4, as in Mini Micro).  Bulk queries
+// run in C++ against the display's spatial hash, instead of the script
+// testing every pair of sprites itself.
+
+static SpriteDisplay* Sprites() {
+    return targetMachine ? dynamic_cast<SpriteDisplay*>(targetMachine->GetDisplay(4)) : nullptr;
+}
+
+static bool SpriteOverlaps(int sprite, int other) {
+    SpriteDisplay* sprites = Sprites();
+    return sprites ? sprites->Overlaps(sprite, other) : false;
+}
+
+static std::vector<int> SpriteOverlapping(int sprite) {
+    std::vector<int> result;
+    if (SpriteDisplay* sprites = Sprites()) sprites->FindOverlapping(sprite, result);
+    return result;
+}
+
+static std::vector<int> SpritesAt(float x, float y) {
+    std::vector<int> result;
+    if (SpriteDisplay* sprites = Sprites()) sprites->FindAt(x, y, result);
+    return result;
+}
+
+static std::vector<std::pair<int, int>> SpriteCollisions() {
+    std::vector<std::pair<int, int>> result;
+    if (SpriteDisplay* sprites = Sprites()) sprites->FindCollidingPairs(result);
+    return result;
+}
+
+//--------------------------------------------------------------------------------
+// display
+
+static bool DisplayVisible(int index) {
+    Display* display = targetMachine ? targetMachine->GetDisplay(index) : nullptr;
+    return display ? display->IsVisible() : false;
+}
+
+static void DisplaySetVisible(int index, bool visible) {
+    Display* display = targetMachine ? targetMachine->GetDisplay(index) : nullptr;
+    if (display) display->SetVisible(visible);
+}
+
+static float DisplayScale(int index) {
+    Display* display = targetMachine ? targetMachine->GetDisplay(index) : nullptr;
+    return display ? display->GetScale() : 1.0f;
+}
+
+static void DisplaySetScale(int index, float scale) {
+    Display* display = targetMachine ? targetMachine->GetDisplay(index) : nullptr;
+    if (display) display->SetScale(scale);
+}
+
+static float DisplayScrollX(int index) {
+    Display* display = targetMachine ? targetMachine->GetDisplay(index) : nullptr;
+    return display ? display->GetScrollX() : 0.0f;
+}
+
+static float DisplayScrollY(int index) {
+    Display* display = targetMachine ? targetMachine->GetDisplay(index) : nullptr;
+    return display ? display->GetScrollY() : 0.0f;
+}
+
+static void DisplaySetScroll(int index, float x, float y) {
+    Display* display = targetMachine ? targetMachine->GetDisplay(index) : nullptr;
+    if (display) display->SetScroll(x, y);
+}
+
+//--------------------------------------------------------------------------------
+// The table
+
+static constexpr const char* kRowColParams[] = { "row", "column" };
+static constexpr const char* kStringParams[] = { "s" };
+static constexpr const char* kColorParams[] = { "color" };
+static constexpr const char* kBoolParams[] = { "value" };
+static constexpr const char* kCellParams[] = { "x", "y" };
+static constexpr const char* kSetCellParams[] = { "x", "y", "k" };
+static constexpr const char* kIndexParams[] = { "index" };
+static constexpr const char* kSetVisibleParams[] = { "index", "visible" };
+static constexpr const char* kSetScaleParams[] = { "index", "scale" };
+static constexpr const char* kSetScrollParams[] = { "index", "x", "y" };
+static constexpr const char* kPixelParams[] = { "x", "y" };
+static constexpr const char* kSpriteParams[] = { "sprite" };
+static constexpr const char* kSpritePairParams[] = { "sprite", "other" };
+static constexpr const char* kSetPixelParams[] = { "x", "y", "color" };
+static constexpr const char* kLineParams[] = { "x1", "y1", "x2", "y2", "color", "penSize" };
+static constexpr const char* kFillBoxParams[] = { "left", "bottom", "width", "height", "color" };
+static constexpr const char* kDrawBoxParams[] = { "left", "bottom", "width", "height", "color", "penSize" };
+
+static constexpr IntrinsicDef kMachineIntrinsics[] = {
+    BindIntrinsic<&TextRow>("text.row"),
+    BindIntrinsic<&TextColumn>("text.column"),
+    BindIntrinsic<&TextSetCursor>("text.setCursor", kRowColParams),
+    BindIntrinsic<&TextPrint>("text.print", kStringParams),
+    BindIntrinsic<&TextClear>("text.clear"),
+    BindIntrinsic<&TextColor>("text.color"),
+    BindIntrinsic<&TextSetColor>("text.setColor", kColorParams),
+    BindIntrinsic<&TextBackColor>("text.backColor"),
+    BindIntrinsic<&TextSetBackColor>("text.setBackColor", kColorParams),
+    BindIntrinsic<&TextInverse>("text.inverse"),
+    BindIntrinsic<&TextSetInverse>("text.setInverse", kBoolParams),
+    BindIntrinsic<&TextCell>("text.cell", kCellParams),
+    BindIntrinsic<&TextSetCell>("text.setCell", kSetCellParams),
+    BindIntrinsic<&GfxClear>("gfx.clear", kColorParams),
+    BindIntrinsic<&GfxPixel>("gfx.pixel", kPixelParams),
+    BindIntrinsic<&GfxSetPixel>("gfx.setPixel", kSetPixelParams),
+    BindIntrinsic<&GfxLine>("gfx.line", kLineParams),
+    BindIntrinsic<&GfxFillRect>("gfx.fillRect", kFillBoxParams),
+    BindIntrinsic<&GfxDrawRect>("gfx.drawRect", kDrawBoxParams),
+    BindIntrinsic<&GfxFillEllipse>("gfx.fillEllipse", kFillBoxParams),
+    BindIntrinsic<&GfxDrawEllipse>("gfx.drawEllipse", kDrawBoxParams),
+    BindIntrinsic<&GfxFloodFill>("gfx.floodFill", kSetPixelParams),
+    BindIntrinsic<&SpriteOverlaps>("sprite.overlaps", kSpritePairParams),
+    BindIntrinsic<&SpriteOverlapping>("sprite.overlapping", kSpriteParams),
+    BindIntrinsic<&SpritesAt>("sprite.at", kPixelParams),
+    BindIntrinsic<&SpriteCollisions>("sprite.collisions"),
+    BindIntrinsic<&DisplayVisible>("display.visible", kIndexParams),
+    BindIntrinsic<&DisplaySetVisible>("display.setVisible", kSetVisibleParams),
+    BindIntrinsic<&DisplayScale>("display.scale", kIndexParams),
+    BindIntrinsic<&DisplaySetScale>("display.setScale", kSetScaleParams),
+    BindIntrinsic<&DisplayScrollX>("display.scrollX", kIndexParams),
+    BindIntrinsic<&DisplayScrollY>("display.scrollY", kIndexParams),
+    BindIntrinsic<&DisplaySetScroll>("display.setScroll", kSetScrollParams),
+};
+
+const IntrinsicDef* GetMachineIntrinsics(int& outCount) {
+    outCount = (int)(sizeof(kMachineIntrinsics) / sizeof(kMachineIntrinsics[0]));
+    return kMachineIntrinsics;
+}
+
+const IntrinsicDef* FindIntrinsic(const IntrinsicDef* table, int count, const char* name) {
+    for (int i = 0; i < count; i++) {
+        if (strcmp(table[i].name, name) == 0) return &table[i];
+    }
+    return nullptr;
+}
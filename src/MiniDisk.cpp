@@ -0,0 +1,556 @@
+#include "MiniDisk.h"
+#include "raylib.h"
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+
+namespace {
+    const uint32_t kLocalHeaderSignature = 0x04034b50;
+    const uint32_t kCentralHeaderSignature = 0x02014b50;
+    const uint32_t kEndOfDirectorySignature = 0x06054b50;
+    const size_t kLocalHeaderSize = 30;
+    const size_t kCentralHeaderSize = 46;
+    const size_t kEndOfDirectorySize = 22;
+    const size_t kMaxCommentSize = 65535;
+    const uint16_t kMethodStored = 0;
+    const uint16_t kMethodDeflated = 8;
+    const uint16_t kZipVersion = 20;
+    const uint32_t kDirectoryAttribute = 0x10;     // MS-DOS external attribute
+
+    uint16_t ReadU16(const unsigned char* p) { return (uint16_t)(p[0] | p[1] << 8); }
+    uint32_t ReadU32(const unsigned char* p) {
+        return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+    }
+    void WriteU16(std::vector<unsigned char>& out, uint16_t v) {
+        out.push_back((unsigned char)v);
+        out.push_back((unsigned char)(v >> 8));
+    }
+    void WriteU32(std::vector<unsigned char>& out, uint32_t v) {
+        for (int i = 0; i < 4; i++) out.push_back((unsigned char)(v >> (i * 8)));
+    }
+
+    std::string ParentOf(const std::string& path) {
+        size_t slash = path.rfind('/');
+        return slash == std::string::npos ? std::string() : path.substr(0, slash);
+    }
+    std::string NameOf(const std::string& path) {
+        size_t slash = path.rfind('/');
+        return slash == std::string::npos ? path : path.substr(slash + 1);
+    }
+
+    uint32_t DosTimeNow() {
+        time_t now = time(nullptr);
+        const struct tm* t = localtime(&now);
+        uint32_t date = (uint32_t)((t->tm_year - 80) << 9 | (t->tm_mon + 1) << 5 | t->tm_mday);
+        uint32_t clock = (uint32_t)(t->tm_hour << 11 | t->tm_min << 5 | t->tm_sec / 2);
+        return date << 16 | clock;
+    }
+}
+
+MiniDisk::MiniDisk()
+    : writable(false), idleTime(0), writeSequence(0), flushPool(nullptr), flushSequence(0),
+      flushing(false), flushWritten(false), flushDone(false), cacheBytes(0),
+      cacheLimit(kDefaultCacheBytes), readCounter(0), cacheHits(0), cacheMisses(0) {
+}
+
+MiniDisk::~MiniDisk() {
+    if (!Eject()) {
+        TraceLog(LOG_WARNING, "MiniDisk: Discarding unwritten changes to %s", diskPath.c_str());
+        Close();
+    }
+    delete flushPool;
+}
+
+bool MiniDisk::Mount(const char* zipPath, bool writable) {
+    if (!Eject()) return false;
+    if (!file.Open(zipPath)) {
+        TraceLog(LOG_WARNING, "MiniDisk: Cannot open %s", zipPath);
+        return false;
+    }
+    diskPath = zipPath;
+    this->writable = writable;
+    if (!ParseCentralDirectory()) {
+        TraceLog(LOG_WARNING, "MiniDisk: %s is not a supported zip file", zipPath);
+        Close();
+        return false;
+    }
+    return true;
+}
+
+bool MiniDisk::Eject() {
+    if (IsMounted() && HasPendingWrites() && !Flush()) {
+        TraceLog(LOG_WARNING, "MiniDisk: %s stays mounted; its changes could not be written", diskPath.c_str());
+        return false;
+    }
+    Close();
+    return true;
+}
+
+void MiniDisk::Close() {
+    if (flushing) {
+        flushPool->WaitIdle();
+        flushing = false;
+        if (flushWritten) remove((diskPath + ".tmp").c_str());
+        flushChanges.clear();
+    }
+    ClearCache();
+    file.Close();
+    entries.clear();
+    index.clear();
+    children.clear();
+    journal.clear();
+    idleTime = 0;
+}
+
+bool MiniDisk::Reopen() {
+    ClearCache();
+    file.Close();
+    entries.clear();
+    index.clear();
+    children.clear();
+    if (!file.Open(diskPath.c_str()) || !ParseCentralDirectory()) {
+        TraceLog(LOG_WARNING, "MiniDisk: Cannot reopen %s", diskPath.c_str());
+        file.Close();
+        return false;
+    }
+    return true;
+}
+
+bool MiniDisk::ParseCentralDirectory() {
+    const unsigned char* data = file.GetData();
+    size_t size = file.GetSize();
+    if (size < kEndOfDirectorySize) return false;
+
+    // The end record is last, after a comment of up to 64 KB
+    size_t end = size - kEndOfDirectorySize;
+    size_t stop = end > kMaxCommentSize ? end - kMaxCommentSize : 0;
+    const unsigned char* record = nullptr;
+    for (size_t pos = end + 1; pos-- > stop; ) {
+        if (ReadU32(data + pos) == kEndOfDirectorySignature) {
+            record = data + pos;
+            break;
+        }
+    }
+    if (!record) return false;
+
+    // No zip64: a full 16-bit count or 32-bit offset means one is needed
+    uint16_t count = ReadU16(record + 10);
+    uint32_t directorySize = ReadU32(record + 12);
+    uint32_t directoryOffset = ReadU32(record + 16);
+    if (count == 0xFFFF || directoryOffset == 0xFFFFFFFF) return false;
+    if ((size_t)directoryOffset + directorySize > size) return false;
+
+    entries.reserve(count);
+    index.reserve(count * 2);
+    const unsigned char* p = data + directoryOffset;
+    const unsigned char* directoryEnd = p + directorySize;
+    children[std::string()];
+    for (int i = 0; i < count; i++) {
+        if (p + kCentralHeaderSize > directoryEnd || ReadU32(p) != kCentralHeaderSignature) return false;
+        uint16_t nameLength = ReadU16(p + 28);
+        uint16_t extraLength = ReadU16(p + 30);
+        uint16_t commentLength = ReadU16(p + 32);
+        const unsigned char* next = p + kCentralHeaderSize + nameLength + extraLength + commentLength;
+        if (next > directoryEnd) return false;
+
+        Entry entry;
+        entry.path.assign((const char*)p + kCentralHeaderSize, nameLength);
+        entry.method = ReadU16(p + 10);
+        entry.dosTime = ReadU32(p + 12);
+        entry.crc = ReadU32(p + 16);
+        entry.compressedSize = ReadU32(p + 20);
+        entry.size = ReadU32(p + 24);
+        entry.localOffset = ReadU32(p + 42);
+        entry.isDirectory = !entry.path.empty() && entry.path.back() == '/';
+        entry.implicit = false;
+        p = next;
+
+        while (!entry.path.empty() && entry.path.back() == '/') entry.path.pop_back();
+        if (entry.path.empty()) continue;
+        AddEntry(entry);
+    }
+    return true;
+}
+
+int MiniDisk::AddEntry(const Entry& entry) {
+    std::unordered_map<std::string, int>::iterator found = index.find(entry.path);
+    if (found != index.end()) {
+        // A directory's own entry may come after files that implied it
+        Entry& existing = entries[found->second];
+        if (existing.implicit && entry.isDirectory) existing = entry;
+        return found->second;
+    }
+
+    // Directories are implied by the paths of the files in them
+    std::string parent = ParentOf(entry.path);
+    if (!parent.empty() && !index.count(parent)) {
+        Entry directory = Entry();
+        directory.path = parent;
+        directory.isDirectory = true;
+        directory.implicit = true;
+        AddEntry(directory);
+    }
+
+    int i = (int)entries.size();
+    entries.push_back(entry);
+    index[entry.path] = i;
+    children[parent].push_back(i);
+    if (entry.isDirectory) children[entry.path];
+    return i;
+}
+
+int MiniDisk::FindEntry(const std::string& path) const {
+    std::unordered_map<std::string, int>::const_iterator found = index.find(path);
+    return found == index.end() ? -1 : found->second;
+}
+
+const unsigned char* MiniDisk::EntryData(const Entry& entry) const {
+    // The local header repeats the name and has its own extra field
+    const unsigned char* data = file.GetData();
+    size_t size = file.GetSize();
+    if ((size_t)entry.localOffset + kLocalHeaderSize > size) return nullptr;
+    const unsigned char* header = data + entry.localOffset;
+    if (ReadU32(header) != kLocalHeaderSignature) return nullptr;
+    size_t start = (size_t)entry.localOffset + kLocalHeaderSize + ReadU16(header + 26) + ReadU16(header + 28);
+    if (start + entry.compressedSize > size) return nullptr;
+    return data + start;
+}
+
+bool MiniDisk::IsDirectoryPath(const std::string& path) const {
+    if (path.empty()) return IsMounted();
+    std::unordered_map<std::string, Pending>::const_iterator pending = journal.find(path);
+    if (pending != journal.end()) return !pending->second.deleted && pending->second.isDirectory;
+    int i = FindEntry(path);
+    return i >= 0 && entries[i].isDirectory;
+}
+
+bool MiniDisk::Exists(const std::string& path) const {
+    FileInfo info;
+    return GetInfo(path, info);
+}
+
+bool MiniDisk::GetInfo(const std::string& path, FileInfo& outInfo) const {
+    outInfo.name = NameOf(path);
+    if (path.empty()) {
+        outInfo.size = 0;
+        outInfo.isDirectory = true;
+        outInfo.dosTime = 0;
+        return IsMounted();
+    }
+    std::unordered_map<std::string, Pending>::const_iterator pending = journal.find(path);
+    if (pending != journal.end()) {
+        if (pending->second.deleted) return false;
+        outInfo.size = pending->second.data.size();
+        outInfo.isDirectory = pending->second.isDirectory;
+        outInfo.dosTime = pending->second.dosTime;
+        return true;
+    }
+    int i = FindEntry(path);
+    if (i < 0) return false;
+    outInfo.size = entries[i].size;
+    outInfo.isDirectory = entries[i].isDirectory;
+    outInfo.dosTime = entries[i].dosTime;
+    return true;
+}
+
+bool MiniDisk::ListDirectory(const std::string& path, std::vector<FileInfo>& out) const {
+    if (!IsDirectoryPath(path)) return false;
+
+    FileInfo info;
+    std::unordered_map<std::string, std::vector<int>>::const_iterator list = children.find(path);
+    if (list != children.end()) {
+        for (int i : list->second) {
+            const Entry& entry = entries[i];
+            if (journal.count(entry.path)) continue;    // changed; listed below
+            info.name = NameOf(entry.path);
+            info.size = entry.size;
+            info.isDirectory = entry.isDirectory;
+            info.dosTime = entry.dosTime;
+            out.push_back(info);
+        }
+    }
+
+    // The journal only holds changes since the last flush, so it is short
+    for (const std::pair<const std::string, Pending>& item : journal) {
+        if (item.second.deleted || ParentOf(item.first) != path) continue;
+        info.name = NameOf(item.first);
+        info.size = item.second.data.size();
+        info.isDirectory = item.second.isDirectory;
+        info.dosTime = item.second.dosTime;
+        out.push_back(info);
+    }
+    return true;
+}
+
+bool MiniDisk::ReadFile(const std::string& path, const unsigned char** outData, size_t* outSize) {
+    readCounter++;
+    std::unordered_map<std::string, Pending>::const_iterator pending = journal.find(path);
+    if (pending != journal.end()) {
+        static const unsigned char empty = 0;
+        if (pending->second.deleted || pending->second.isDirectory) return false;
+        *outData = pending->second.data.empty() ? &empty : pending->second.data.data();
+        *outSize = pending->second.data.size();
+        return true;
+    }
+
+    int i = FindEntry(path);
+    if (i < 0 || entries[i].isDirectory) return false;
+    const Entry& entry = entries[i];
+    const unsigned char* raw = EntryData(entry);
+    if (!raw) return false;
+
+    if (entry.method == kMethodStored) {
+        *outData = raw;
+        *outSize = entry.size;
+        return true;
+    }
+    if (entry.method != kMethodDeflated) {
+        TraceLog(LOG_WARNING, "MiniDisk: %s uses unsupported compression method %d", path.c_str(), entry.method);
+        return false;
+    }
+
+    std::unordered_map<int, CacheItem>::iterator cached = cache.find(i);
+    if (cached != cache.end()) {
+        cacheHits++;
+        cached->second.lastUsed = readCounter;
+        *outData = cached->second.data;
+        *outSize = cached->second.size;
+        return true;
+    }
+
+    cacheMisses++;
+    int inflatedSize = 0;
+    unsigned char* inflated = DecompressData(raw, (int)entry.compressedSize, &inflatedSize);
+    if (!inflated || (uint32_t)inflatedSize != entry.size) {
+        TraceLog(LOG_WARNING, "MiniDisk: Cannot inflate %s", path.c_str());
+        MemFree(inflated);
+        return false;
+    }
+    EvictCache(entry.size);
+    CacheItem item;
+    item.data = inflated;
+    item.size = entry.size;
+    item.lastUsed = readCounter;
+    cache[i] = item;
+    cacheBytes += entry.size;
+    *outData = inflated;
+    *outSize = entry.size;
+    return true;
+}
+
+void MiniDisk::EvictCache(size_t incoming) {
+    while (!cache.empty() && cacheBytes + incoming > cacheLimit) {
+        std::unordered_map<int, CacheItem>::iterator oldest = cache.begin();
+        for (std::unordered_map<int, CacheItem>::iterator it = cache.begin(); it != cache.end(); ++it) {
+            if (it->second.lastUsed < oldest->second.lastUsed) oldest = it;
+        }
+        cacheBytes -= oldest->second.size;
+        MemFree(oldest->second.data);
+        cache.erase(oldest);
+    }
+}
+
+void MiniDisk::ClearCache() {
+    for (std::pair<const int, CacheItem>& item : cache) MemFree(item.second.data);
+    cache.clear();
+    cacheBytes = 0;
+}
+
+bool MiniDisk::WriteFile(const std::string& path, const void* data, size_t size) {
+    if (!IsMounted() || !writable || path.empty() || IsDirectoryPath(path)) return false;
+    if (!IsDirectoryPath(ParentOf(path))) return false;
+    Pending& pending = journal[path];
+    pending.deleted = false;
+    pending.isDirectory = false;
+    pending.data.assign((const unsigned char*)data, (const unsigned char*)data + size);
+    pending.dosTime = DosTimeNow();
+    pending.sequence = NoteWrite();
+    return true;
+}
+
+bool MiniDisk::MakeDirectory(const std::string& path) {
+    if (!IsMounted() || !writable || path.empty()) return false;
+    if (Exists(path)) return IsDirectoryPath(path);
+    if (!IsDirectoryPath(ParentOf(path))) return false;
+    Pending& pending = journal[path];
+    pending.deleted = false;
+    pending.isDirectory = true;
+    pending.data.clear();
+    pending.dosTime = DosTimeNow();
+    pending.sequence = NoteWrite();
+    return true;
+}
+
+bool MiniDisk::Delete(const std::string& path) {
+    if (!IsMounted() || !writable || path.empty() || !Exists(path)) return false;
+    if (IsDirectoryPath(path)) {
+        std::vector<FileInfo> contents;
+        ListDirectory(path, contents);
+        if (!contents.empty()) return false;
+    }
+    if (FindEntry(path) < 0 && !flushing) {
+        journal.erase(path);        // never written back; just forget it
+        NoteWrite();
+    } else {
+        // (A flush in progress may be writing the file back)
+        Pending& pending = journal[path];
+        pending.deleted = true;
+        pending.isDirectory = false;
+        pending.data.clear();
+        pending.sequence = NoteWrite();
+    }
+    return true;
+}
+
+void MiniDisk::Update(float deltaTime) {
+    if (flushing) {
+        if (flushDone) FinishBackgroundFlush();
+        return;
+    }
+    if (journal.empty() || !IsMounted()) return;
+    idleTime += deltaTime;
+    if (idleTime >= kIdleFlushSeconds) StartBackgroundFlush();
+}
+
+void MiniDisk::StartBackgroundFlush() {
+    // The worker gets a copy, so writes can go on while it runs
+    flushChanges = journal;
+    flushSequence = writeSequence;
+    flushing = true;
+    flushWritten = false;
+    flushDone = false;
+    if (!flushPool) flushPool = new ThreadPool(1);
+    flushPool->Submit([this] {
+        flushWritten = WriteZip(flushChanges, diskPath + ".tmp");
+        flushDone = true;
+    });
+}
+
+bool MiniDisk::FinishBackgroundFlush() {
+    flushPool->WaitIdle();
+    flushing = false;
+    flushChanges.clear();
+    idleTime = 0;       // on failure, try again after another idle period
+    return flushWritten && SwapIn(diskPath + ".tmp", flushSequence);
+}
+
+bool MiniDisk::Flush() {
+    // A failed background flush is retried here, so Eject gets its own try
+    if (flushing) FinishBackgroundFlush();
+    if (journal.empty()) return true;
+    if (!IsMounted() || !writable) return false;
+    std::string tempPath = diskPath + ".tmp";
+    return WriteZip(journal, tempPath) && SwapIn(tempPath, writeSequence);
+}
+
+bool MiniDisk::WriteZip(const Journal& changes, const std::string& tempPath) const {
+    FILE* f = fopen(tempPath.c_str(), "wb");
+    if (!f) {
+        TraceLog(LOG_WARNING, "MiniDisk: Cannot write %s", tempPath.c_str());
+        return false;
+    }
+
+    // Unchanged entries are copied as they are (still compressed), then the
+    // journal's files are added stored
+    std::vector<unsigned char> header;
+    std::vector<unsigned char> directory;
+    uint32_t offset = 0;
+    int count = 0;
+    bool ok = true;
+    auto writeEntry = [&](const std::string& path, bool isDirectory, uint16_t method, uint32_t dosTime,
+                          uint32_t crc, uint32_t compressedSize, uint32_t size, const unsigned char* data) {
+        std::string name = isDirectory ? path + "/" : path;
+        header.clear();
+        WriteU32(header, kLocalHeaderSignature);
+        WriteU16(header, kZipVersion);
+        WriteU16(header, 0);
+        WriteU16(header, method);
+        WriteU32(header, dosTime);
+        WriteU32(header, crc);
+        WriteU32(header, compressedSize);
+        WriteU32(header, size);
+        WriteU16(header, (uint16_t)name.size());
+        WriteU16(header, 0);
+        header.insert(header.end(), name.begin(), name.end());
+        ok = ok && fwrite(header.data(), 1, header.size(), f) == header.size();
+        if (compressedSize) ok = ok && fwrite(data, 1, compressedSize, f) == compressedSize;
+
+        WriteU32(directory, kCentralHeaderSignature);
+        WriteU16(directory, kZipVersion);
+        WriteU16(directory, kZipVersion);
+        WriteU16(directory, 0);
+        WriteU16(directory, method);
+        WriteU32(directory, dosTime);
+        WriteU32(directory, crc);
+        WriteU32(directory, compressedSize);
+        WriteU32(directory, size);
+        WriteU16(directory, (uint16_t)name.size());
+        WriteU16(directory, 0);
+        WriteU16(directory, 0);
+        WriteU16(directory, 0);
+        WriteU16(directory, 0);
+        WriteU32(directory, isDirectory ? kDirectoryAttribute : 0);
+        WriteU32(directory, offset);
+        directory.insert(directory.end(), name.begin(), name.end());
+        offset += (uint32_t)header.size() + compressedSize;
+        count++;
+    };
+
+    for (const Entry& entry : entries) {
+        if (entry.implicit || changes.count(entry.path)) continue;
+        const unsigned char* data = entry.isDirectory ? nullptr : EntryData(entry);
+        if (!entry.isDirectory && !data) continue;
+        writeEntry(entry.path, entry.isDirectory, entry.method, entry.dosTime, entry.crc,
+                   entry.compressedSize, entry.size, data);
+    }
+    std::vector<std::string> added;
+    for (const std::pair<const std::string, Pending>& item : changes) {
+        if (!item.second.deleted) added.push_back(item.first);
+    }
+    std::sort(added.begin(), added.end());
+    for (const std::string& path : added) {
+        const Pending& pending = changes.at(path);
+        uint32_t size = (uint32_t)pending.data.size();
+        uint32_t crc = size ? ComputeCRC32((unsigned char*)pending.data.data(), (int)size) : 0;
+        writeEntry(path, pending.isDirectory, kMethodStored, pending.dosTime, crc, size, size, pending.data.data());
+    }
+
+    header.clear();
+    WriteU32(header, kEndOfDirectorySignature);
+    WriteU16(header, 0);
+    WriteU16(header, 0);
+    WriteU16(header, (uint16_t)count);
+    WriteU16(header, (uint16_t)count);
+    WriteU32(header, (uint32_t)directory.size());
+    WriteU32(header, offset);
+    WriteU16(header, 0);
+    ok = ok && count < 0xFFFF;
+    ok = ok && fwrite(directory.data(), 1, directory.size(), f) == directory.size();
+    ok = ok && fwrite(header.data(), 1, header.size(), f) == header.size();
+    ok = (fclose(f) == 0) && ok;
+    if (!ok) {
+        TraceLog(LOG_WARNING, "MiniDisk: Writing %s failed; changes kept in memory", tempPath.c_str());
+        remove(tempPath.c_str());
+    }
+    return ok;
+}
+
+bool MiniDisk::SwapIn(const std::string& tempPath, unsigned int sequence) {
+    // Unmapped first, as Windows can't replace a mapped file
+    ClearCache();
+    file.Close();
+    bool replaced = MappedFile::Replace(diskPath.c_str(), tempPath.c_str());
+    if (!replaced) {
+        TraceLog(LOG_WARNING, "MiniDisk: Cannot replace %s; changes kept in memory", diskPath.c_str());
+        remove(tempPath.c_str());
+    }
+
+    // Whichever file is there now: the new one, or the untouched old one
+    if (!Reopen()) return false;
+    if (!replaced) return false;
+    for (Journal::iterator it = journal.begin(); it != journal.end(); ) {
+        if (it->second.sequence <= sequence) it = journal.erase(it);
+        else ++it;
+    }
+    return true;
+}
@@ -0,0 +1,307 @@
+#include "MusicStream.h"
+#include "AudioMixer.h"
+#include "ResourcePath.h"
+#include "ResourceArchive.h"
+#include "raylib.h"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    const int kFormatPcm = 1;
+    const int kFormatFloat = 3;
+    const int kFormatExtensible = 0xFFFE;
+    const int kMinSampleRate = 8000;
+
+    uint32_t ReadU32(const unsigned char* p) {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    uint16_t ReadU16(const unsigned char* p) {
+        return (uint16_t)(p[0] | (p[1] << 8));
+    }
+
+    float SampleToFloat(const unsigned char* p, int bytes, int format) {
+        if (format == kFormatFloat) {
+            float value;
+            memcpy(&value, p, sizeof(value));
+            return value;
+        }
+        switch (bytes) {
+        case 1: return (p[0] - 128) * (1.0f / 128.0f);
+        case 2: return (int16_t)ReadU16(p) * (1.0f / 32768.0f);
+        case 3: return (int32_t)(ReadU32(p - 1) & 0xFFFFFF00u) * (1.0f / 2147483648.0f);
+        default: return (int32_t)ReadU32(p) * (1.0f / 2147483648.0f);
+        }
+    }
+
+    void Wait() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+}
+
+MusicStream::MusicStream()
+    : file(nullptr), memory(nullptr), memorySize(0), memoryPos(0), quit(false), format(0), channels(0), sampleRate(0), bytesPerSample(0),
+      dataOffset(0), totalFrames(0), sourceFrame(0), resamplePos(0), haveCarry(false),
+      playing(false), finished(false), looping(false), loopStart(0), loopEnd(0),
+      seekRequest(-1), flushPending(false), playedFrames(0), positionBase(0), volume(1.0f) {
+}
+
+MusicStream::~MusicStream() {
+    Close();
+}
+
+bool MusicStream::Open(const char* relativePath) {
+    Close();
+    if (GetResourceArchive().GetFile(relativePath, &memory, &memorySize)) {
+        memoryPos = 0;
+        return Start(relativePath);
+    }
+    return OpenFile(GetResourceFile(relativePath).c_str());
+}
+
+bool MusicStream::OpenFile(const char* path) {
+    Close();
+    file = fopen(path, "rb");
+    if (!file) {
+        TraceLog(LOG_WARNING, "MusicStream: could not open %s", path);
+        return false;
+    }
+    return Start(path);
+}
+
+bool MusicStream::Start(const char* name) {
+    if (!ParseHeader()) {
+        TraceLog(LOG_WARNING, "MusicStream: %s is not a supported WAV file", name);
+        if (file) fclose(file);
+        file = nullptr;
+        memory = nullptr;
+        return false;
+    }
+
+    // Buffers sized once for the worst case of this file's rate
+    int blockAlign = bytesPerSample * channels;
+    double step = (double)sampleRate / AudioMixer::kSampleRate;
+    int maxOutFrames = (int)((kChunkFrames + 1) / step) + 2;
+    rawChunk.resize((size_t)kChunkFrames * blockAlign + 1);
+    srcChunk.resize((size_t)(kChunkFrames + 1) * 2);
+    outChunk.resize((size_t)maxOutFrames * 2);
+
+    ring.Clear();
+    quit = false;
+    playing = false;
+    finished = false;
+    seekRequest = -1;
+    flushPending = false;
+    playedFrames = 0;
+    positionBase = 0;
+    SeekSource(0);
+    decoder = std::thread(&MusicStream::DecoderLoop, this);
+    return true;
+}
+
+void MusicStream::Close() {
+    if (decoder.joinable()) {
+        quit = true;
+        decoder.join();
+    }
+    if (file) fclose(file);
+    file = nullptr;
+    memory = nullptr;
+    memorySize = 0;
+    playing = false;
+    ring.Clear();
+}
+
+size_t MusicStream::ReadBytes(void* dest, size_t size, size_t count) {
+    if (file) return fread(dest, size, count, file);
+    size_t available = memoryPos < memorySize ? (memorySize - memoryPos) / size : 0;
+    if (count > available) count = available;
+    memcpy(dest, memory + memoryPos, size * count);
+    memoryPos += size * count;
+    return count;
+}
+
+bool MusicStream::SeekBytes(long offset) {
+    if (file) return fseek(file, offset, SEEK_SET) == 0;
+    if (offset < 0 || (size_t)offset > memorySize) return false;
+    memoryPos = (size_t)offset;
+    return true;
+}
+
+long MusicStream::TellBytes() const {
+    return file ? ftell(file) : (long)memoryPos;
+}
+
+bool MusicStream::ParseHeader() {
+    unsigned char riff[12];
+    if (ReadBytes(riff, 1, 12) != 12) return false;
+    if (memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0) return false;
+
+    bool haveFormat = false;
+    unsigned char chunk[8];
+    while (ReadBytes(chunk, 1, 8) == 8) {
+        uint32_t size = ReadU32(chunk + 4);
+        long next = TellBytes() + (long)size + (size & 1);     // chunks are word-aligned
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            unsigned char fmt[40];
+            size_t want = size < sizeof(fmt) ? size : sizeof(fmt);
+            if (want < 16 || ReadBytes(fmt, 1, want) != want) return false;
+            format = ReadU16(fmt);
+            channels = ReadU16(fmt + 2);
+            sampleRate = (int)ReadU32(fmt + 4);
+            bytesPerSample = ReadU16(fmt + 14) / 8;
+            if (format == kFormatExtensible && want >= 26) format = ReadU16(fmt + 24);
+            haveFormat = true;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!haveFormat) return false;
+            bool supported = channels >= 1 && sampleRate >= kMinSampleRate
+                && ((format == kFormatPcm && bytesPerSample >= 1 && bytesPerSample <= 4)
+                    || (format == kFormatFloat && bytesPerSample == 4));
+            if (!supported) return false;
+            dataOffset = TellBytes();
+            totalFrames = size / (uint32_t)(bytesPerSample * channels);
+            return totalFrames > 0;
+        }
+        if (!SeekBytes(next)) return false;
+    }
+    return false;
+}
+
+void MusicStream::SetLoopPoints(double startSeconds, double endSeconds) {
+    int64_t start = (int64_t)(startSeconds * sampleRate);
+    int64_t end = (int64_t)(endSeconds * sampleRate);
+    if (start < 0 || start >= totalFrames) start = 0;
+    if (end <= start || end > totalFrames) end = 0;
+    loopStart = start;
+    loopEnd = end;
+}
+
+void MusicStream::Seek(double seconds) {
+    int64_t frame = (int64_t)(seconds * sampleRate);
+    if (frame < 0) frame = 0;
+    if (frame > totalFrames) frame = totalFrames;
+    seekRequest = frame;
+}
+
+double MusicStream::GetDuration() const {
+    return sampleRate ? (double)totalFrames / sampleRate : 0;
+}
+
+size_t MusicStream::GetMemoryUsage() const {
+    return sizeof(*this) + rawChunk.capacity()
+        + (srcChunk.capacity() + outChunk.capacity()) * sizeof(float);
+}
+
+double MusicStream::GetPosition() const {
+    if (!sampleRate) return 0;
+    double position = (double)positionBase / sampleRate + (double)playedFrames / AudioMixer::kSampleRate;
+    int64_t end = loopEnd ? (int64_t)loopEnd : totalFrames;
+    double loopEndTime = (double)end / sampleRate;
+    if (looping && position > loopEndTime) {
+        double loopStartTime = (double)loopStart / sampleRate;
+        double length = loopEndTime - loopStartTime;
+        if (length > 0) position = loopStartTime + fmod(position - loopStartTime, length);
+    }
+    return position < GetDuration() ? position : GetDuration();
+}
+
+//--------------------------------------------------------------------------------
+// Decoder thread
+
+void MusicStream::SeekSource(int64_t frame) {
+    sourceFrame = frame;
+    SeekBytes(dataOffset + (long)(frame * bytesPerSample * channels));
+    resamplePos = 0;
+    haveCarry = false;
+    finished = false;
+}
+
+int MusicStream::DecodeChunk(float* srcFrames, int maxFrames) {
+    int blockAlign = bytesPerSample * channels;
+    // The extra leading byte lets 24-bit samples be read as a 32-bit word
+    unsigned char* raw = rawChunk.data() + 1;
+    int frames = (int)ReadBytes(raw, blockAlign, maxFrames);
+    for (int i = 0; i < frames; i++) {
+        const unsigned char* p = raw + i * blockAlign;
+        float left = SampleToFloat(p, bytesPerSample, format);
+        float right = channels > 1 ? SampleToFloat(p + bytesPerSample, bytesPerSample, format) : left;
+        srcFrames[i * 2] = left;
+        srcFrames[i * 2 + 1] = right;
+    }
+    sourceFrame += frames;
+    return frames;
+}
+
+void MusicStream::DecoderLoop() {
+    const double step = (double)sampleRate / AudioMixer::kSampleRate;
+    while (!quit) {
+        int64_t seek = seekRequest.exchange(-1);
+        if (seek >= 0) {
+            SeekSource(seek);
+            positionBase = seek;
+            flushPending = true;    // Read drops whatever was queued from before
+        }
+        // A stream that reached its end starts over if looping is turned on
+        // afterwards; the tail already queued still plays first
+        int64_t end = loopEnd ? (int64_t)loopEnd : totalFrames;
+        bool restart = finished && looping && sourceFrame >= end;
+        if (flushPending || (finished && !restart) || ring.GetCapacity() - ring.Size() < outChunk.size()) {
+            Wait();
+            continue;
+        }
+
+        if (sourceFrame >= end) {
+            if (looping) SeekSource(loopStart < end ? (int64_t)loopStart : 0);
+            else finished = true;
+            continue;
+        }
+
+        int carry = haveCarry ? 1 : 0;
+        int64_t remaining = end - sourceFrame;
+        int want = remaining < kChunkFrames ? (int)remaining : kChunkFrames;
+        int got = DecodeChunk(srcChunk.data() + carry * 2, want);
+        if (got <= 0) {
+            finished = true;    // truncated file or read error
+            continue;
+        }
+
+        // Linear resampling to the mixer rate.  The last source frame is
+        // carried into the next chunk so interpolation spans the boundary.
+        const float* src = srcChunk.data();
+        float* out = outChunk.data();
+        int count = got + carry;
+        int outFrames = 0;
+        double pos = resamplePos;
+        while (pos + 1 < count) {
+            int i = (int)pos;
+            float t = (float)(pos - i);
+            out[outFrames * 2] = src[i * 2] + (src[i * 2 + 2] - src[i * 2]) * t;
+            out[outFrames * 2 + 1] = src[i * 2 + 1] + (src[i * 2 + 3] - src[i * 2 + 1]) * t;
+            outFrames++;
+            pos += step;
+        }
+        resamplePos = pos - (count - 1);
+        srcChunk[0] = src[(count - 1) * 2];
+        srcChunk[1] = src[(count - 1) * 2 + 1];
+        haveCarry = true;
+
+        ring.PushMany(out, (size_t)outFrames * 2);
+    }
+}
+
+//--------------------------------------------------------------------------------
+// Audio thread
+
+int MusicStream::Read(float* out, int frames) {
+    if (flushPending.load(std::memory_order_acquire)) {
+        ring.Clear();
+        playedFrames = 0;
+        flushPending.store(false, std::memory_order_release);
+    }
+    if (!playing) return 0;
+
+    int got = (int)(ring.PopMany(out, (size_t)frames * 2) / 2);
+    playedFrames += got;
+    return got;
+}
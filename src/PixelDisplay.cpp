@@ -0,0 +1,359 @@
+#include "PixelDisplay.h"
+#include "RenderQueue.h"
+#include "PixelKernels.h"
+#include "TextureAtlas.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace PixelKernels;
+
+//--------------------------------------------------------------------------------
+// PixelDisplay
+
+PixelDisplay::PixelDisplay() : width(0), height(0), texture(Texture2D{}) {
+    dirty.reserve(kMaxDirtyRects);
+    SetSize(kDefaultWidth, kDefaultHeight);
+}
+
+PixelDisplay::~PixelDisplay() {
+    if (texture.id) UnloadTexture(texture);
+}
+
+void PixelDisplay::SetSize(int width, int height) {
+    this->width = width > 0 ? width : 1;
+    this->height = height > 0 ? height : 1;
+    pixels.assign((size_t)this->width * this->height, 0);
+    dirty.clear();
+    if (texture.id) UnloadTexture(texture);
+    texture = Texture2D{};      // recreated at the next Render
+}
+
+void PixelDisplay::Clear() {
+    Clear(BLANK);
+}
+
+void PixelDisplay::Clear(Color color) {
+    FillPixels(pixels.data(), PackColor(color), width * height);
+    MarkDirty(0, 0, width, height);
+}
+
+Color PixelDisplay::GetPixel(int x, int y) const {
+    if (x < 0 || y < 0 || x >= width || y >= height) return BLANK;
+    return UnpackColor(pixels[(size_t)(height - 1 - y) * width + x]);
+}
+
+void PixelDisplay::SetPixel(int x, int y, Color color) {
+    if (x < 0 || y < 0 || x >= width || y >= height) return;
+    Row(y)[x] = PackColor(color);
+    MarkDirty(x, y, x + 1, y + 1);
+}
+
+void PixelDisplay::FillSpan(int y, int left, int right, uint32_t value) {
+    if (y < 0 || y >= height) return;
+    if (left < 0) left = 0;
+    if (right > width) right = width;
+    if (left < right) FillPixels(Row(y) + left, value, right - left);
+}
+
+void PixelDisplay::FillRows(int left, int bottom, int right, int top, uint32_t value) {
+    if (bottom < 0) bottom = 0;
+    if (top > height) top = height;
+    for (int y = bottom; y < top; y++) FillSpan(y, left, right, value);
+    MarkDirty(left, bottom, right, top);
+}
+
+void PixelDisplay::FillRect(int left, int bottom, int width, int height, Color color) {
+    FillRows(left, bottom, left + width, bottom + height, PackColor(color));
+}
+
+void PixelDisplay::DrawRect(int left, int bottom, int width, int height, Color color, int penSize) {
+    uint32_t value = PackColor(color);
+    int pen = std::min(std::max(penSize, 1), std::min(width, height) / 2 + 1);
+    int right = left + width;
+    int top = bottom + height;
+    FillRows(left, bottom, right, bottom + pen, value);
+    FillRows(left, top - pen, right, top, value);
+    FillRows(left, bottom + pen, left + pen, top - pen, value);
+    FillRows(right - pen, bottom + pen, right, top - pen, value);
+}
+
+void PixelDisplay::Line(int x1, int y1, int x2, int y2, Color color, int penSize) {
+    uint32_t value = PackColor(color);
+    if (penSize < 1) penSize = 1;
+    int before = (penSize - 1) / 2;     // pen extent on each side of the line
+    int after = penSize - before;
+
+    if (y1 == y2) {
+        FillRows(std::min(x1, x2) - before, y1 - before, std::max(x1, x2) + after, y1 + after, value);
+        return;
+    }
+
+    // Bresenham; a pen wider than 1 stamps a square at each step
+    int dx = abs(x2 - x1), sx = x1 < x2 ? 1 : -1;
+    int dy = -abs(y2 - y1), sy = y1 < y2 ? 1 : -1;
+    int err = dx + dy;
+    int x = x1, y = y1;
+    while (true) {
+        if (penSize == 1) {
+            if (x >= 0 && y >= 0 && x < width && y < height) Row(y)[x] = value;
+        } else {
+            for (int py = y - before; py < y + after; py++) FillSpan(py, x - before, x + after, value);
+        }
+        if (x == x2 && y == y2) break;
+        int e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x += sx; }
+        if (e2 <= dx) { err += dx; y += sy; }
+    }
+    MarkDirty(std::min(x1, x2) - before, std::min(y1, y2) - before,
+              std::max(x1, x2) + after, std::max(y1, y2) + after);
+}
+
+void PixelDisplay::FillEllipse(int left, int bottom, int width, int height, Color color) {
+    if (width <= 0 || height <= 0) return;
+    uint32_t value = PackColor(color);
+    double rx = width * 0.5, ry = height * 0.5;
+    double cx = left + rx, cy = bottom + ry;
+    for (int y = std::max(bottom, 0); y < std::min(bottom + height, this->height); y++) {
+        double dy = (y + 0.5 - cy) / ry;
+        double dx = rx * sqrt(std::max(0.0, 1.0 - dy * dy));
+        FillSpan(y, (int)lround(cx - dx), (int)lround(cx + dx), value);
+    }
+    MarkDirty(left, bottom, left + width, bottom + height);
+}
+
+void PixelDisplay::DrawEllipse(int left, int bottom, int width, int height, Color color, int penSize) {
+    if (width <= 0 || height <= 0) return;
+    uint32_t value = PackColor(color);
+    if (penSize < 1) penSize = 1;
+    double rx = width * 0.5, ry = height * 0.5;
+    double cx = left + rx, cy = bottom + ry;
+    double irx = rx - penSize, iry = ry - penSize;
+    for (int y = std::max(bottom, 0); y < std::min(bottom + height, this->height); y++) {
+        double dy = (y + 0.5 - cy) / ry;
+        double dx = rx * sqrt(std::max(0.0, 1.0 - dy * dy));
+        int outerLeft = (int)lround(cx - dx), outerRight = (int)lround(cx + dx);
+
+        // Fill the outer span minus the inner ellipse's span on this row
+        double idy = iry > 0 ? (y + 0.5 - cy) / iry : 2.0;
+        if (irx <= 0 || fabs(idy) >= 1.0) {
+            FillSpan(y, outerLeft, outerRight, value);
+            continue;
+        }
+        double idx = irx * sqrt(1.0 - idy * idy);
+        FillSpan(y, outerLeft, (int)lround(cx - idx), value);
+        FillSpan(y, (int)lround(cx + idx), outerRight, value);
+    }
+    MarkDirty(left, bottom, left + width, bottom + height);
+}
+
+void PixelDisplay::FillPolygon(const Vector2* points, int count, Color color) {
+    if (count < 3) return;
+    uint32_t value = PackColor(color);
+    float minY = points[0].y, maxY = points[0].y;
+    float minX = points[0].x, maxX = points[0].x;
+    for (int i = 1; i < count; i++) {
+        minY = std::min(minY, points[i].y);
+        maxY = std::max(maxY, points[i].y);
+        minX = std::min(minX, points[i].x);
+        maxX = std::max(maxX, points[i].x);
+    }
+
+    // Scanline at each row's center: fill between pairs of edge crossings
+    int top = std::min((int)ceilf(maxY), height);
+    for (int y = std::max((int)floorf(minY), 0); y < top; y++) {
+        float sampleY = y + 0.5f;
+        crossings.clear();
+        for (int i = 0, j = count - 1; i < count; j = i++) {
+            const Vector2& a = points[j];
+            const Vector2& b = points[i];
+            if ((a.y <= sampleY) != (b.y <= sampleY)) {
+                crossings.push_back(a.x + (sampleY - a.y) * (b.x - a.x) / (b.y - a.y));
+            }
+        }
+        std::sort(crossings.begin(), crossings.end());
+        for (size_t i = 0; i + 1 < crossings.size(); i += 2) {
+            FillSpan(y, (int)lroundf(crossings[i]), (int)lroundf(crossings[i + 1]), value);
+        }
+    }
+    MarkDirty((int)floorf(minX), (int)floorf(minY), (int)ceilf(maxX) + 1, (int)ceilf(maxY));
+}
+
+void PixelDisplay::FloodFill(int x, int y, Color color) {
+    if (x < 0 || y < 0 || x >= width || y >= height) return;
+    uint32_t value = PackColor(color);
+    uint32_t target = Row(y)[x];
+    if (target == value) return;
+
+    // Scanline fill, working in framebuffer rows
+    int minX = x, maxX = x + 1, minRow = height - 1 - y, maxRow = minRow + 1;
+    seeds.clear();
+    seeds.push_back(FillSeed{ x, height - 1 - y });
+    while (!seeds.empty()) {
+        FillSeed seed = seeds.back();
+        seeds.pop_back();
+        uint32_t* line = &pixels[(size_t)seed.row * width];
+        if (line[seed.x] != target) continue;
+
+        int left = seed.x;
+        while (left > 0 && line[left - 1] == target) left--;
+        int right = FindMismatch(line, seed.x, width, target);
+        FillPixels(line + left, value, right - left);
+        minX = std::min(minX, left);
+        maxX = std::max(maxX, right);
+        minRow = std::min(minRow, seed.row);
+        maxRow = std::max(maxRow, seed.row + 1);
+
+        // Seed each run of target pixels in the rows above and below
+        for (int row = seed.row - 1; row <= seed.row + 1; row += 2) {
+            if (row < 0 || row >= height) continue;
+            const uint32_t* next = &pixels[(size_t)row * width];
+            for (int i = left; i < right; ) {
+                if (next[i] == target) {
+                    seeds.push_back(FillSeed{ i, row });
+                    i = FindMismatch(next, i, right, target);
+                } else {
+                    i++;
+                }
+            }
+        }
+    }
+    MarkDirty(minX, height - maxRow, maxX, height - minRow);
+}
+
+void PixelDisplay::DrawImage(const Image& image, int left, int bottom) {
+    DrawImage(image, Rectangle{ 0, 0, (float)image.width, (float)image.height }, left, bottom);
+}
+
+void PixelDisplay::DrawImage(const Image& image, Rectangle source, int left, int bottom) {
+    if (!image.data || image.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) {
+        TraceLog(LOG_WARNING, "PixelDisplay: DrawImage needs an RGBA8 image");
+        return;
+    }
+    int srcX = std::max((int)source.x, 0);
+    int srcY = std::max((int)source.y, 0);
+    int srcWidth = std::min((int)source.width, image.width - srcX);
+    int srcHeight = std::min((int)source.height, image.height - srcY);
+    int x0 = std::max(left, 0);
+    int x1 = std::min(left + srcWidth, width);
+    if (x0 >= x1 || srcHeight <= 0) return;
+
+    // Image rows are top-down, like the framebuffer
+    const uint32_t* src = (const uint32_t*)image.data + (size_t)srcY * image.width + srcX;
+    int topRow = height - (bottom + srcHeight);
+    for (int j = 0; j < srcHeight; j++) {
+        int row = topRow + j;
+        if (row < 0 || row >= height) continue;
+        BlendPixels(&pixels[(size_t)row * width + x0], src + (size_t)j * image.width + (x0 - left), x1 - x0);
+    }
+    MarkDirty(left, bottom, left + srcWidth, bottom + srcHeight);
+}
+
+void PixelDisplay::DrawImage(const ResourceManager::TextureResource* resource, int left, int bottom) {
+    if (!resource || !resource->IsReady()) return;
+    if (resource->atlasRegion >= 0) {
+        const TextureAtlas& atlas = TextureAtlas::Shared();
+        TextureAtlas::Region region = atlas.GetRegion(resource->atlasRegion);
+        DrawImage(atlas.GetPageImage(region.page), region.source, left, bottom);
+        return;
+    }
+    Image image = LoadImageFromTexture(resource->texture);
+    ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    DrawImage(image, left, bottom);
+    UnloadImage(image);
+}
+
+//--------------------------------------------------------------------------------
+// Dirty rectangles and upload
+
+void PixelDisplay::MarkDirty(int left, int bottom, int right, int top) {
+    DirtyRect rect = { std::max(left, 0), std::max(height - top, 0),
+                       std::min(right, width), std::min(height - bottom, height) };
+    if (rect.left >= rect.right || rect.top >= rect.bottom) return;
+
+    auto unite = [](const DirtyRect& a, const DirtyRect& b) {
+        return DirtyRect{ std::min(a.left, b.left), std::min(a.top, b.top),
+                          std::max(a.right, b.right), std::max(a.bottom, b.bottom) };
+    };
+    auto area = [](const DirtyRect& r) { return (long)(r.right - r.left) * (r.bottom - r.top); };
+
+    // Absorb rects that overlap or touch this one (the union may then reach others)
+    for (size_t i = 0; i < dirty.size(); ) {
+        const DirtyRect& other = dirty[i];
+        if (other.left <= rect.right && rect.left <= other.right
+            && other.top <= rect.bottom && rect.top <= other.bottom) {
+            rect = unite(rect, other);
+            dirty[i] = dirty.back();
+            dirty.pop_back();
+            i = 0;
+        } else {
+            i++;
+        }
+    }
+
+    // Out of slots: merge with whichever rect grows the least
+    if ((int)dirty.size() >= kMaxDirtyRects) {
+        size_t best = 0;
+        long bestGrowth = -1;
+        for (size_t i = 0; i < dirty.size(); i++) {
+            long growth = area(unite(dirty[i], rect)) - area(dirty[i]);
+            if (bestGrowth < 0 || growth < bestGrowth) {
+                best = i;
+                bestGrowth = growth;
+            }
+        }
+        rect = unite(dirty[best], rect);
+        dirty[best] = dirty.back();
+        dirty.pop_back();
+    }
+    dirty.push_back(rect);
+}
+
+void PixelDisplay::UploadDirty() {
+    if (dirty.empty()) return;
+
+    long dirtyArea = 0;
+    for (const DirtyRect& r : dirty) dirtyArea += (long)(r.right - r.left) * (r.bottom - r.top);
+    if (dirtyArea * 2 > (long)width * height) {
+        UpdateTexture(texture, pixels.data());
+        dirty.clear();
+        return;
+    }
+
+    for (const DirtyRect& r : dirty) {
+        int w = r.right - r.left;
+        int h = r.bottom - r.top;
+        const uint32_t* src = &pixels[(size_t)r.top * width];
+        if (w != width) {
+            // Pack the rows of a partial-width rect contiguously
+            uploadBuffer.resize((size_t)w * h);
+            for (int j = 0; j < h; j++) {
+                memcpy(&uploadBuffer[(size_t)j * w], &pixels[(size_t)(r.top + j) * width + r.left], w * sizeof(uint32_t));
+            }
+            src = uploadBuffer.data();
+        }
+        UpdateTextureRec(texture, Rectangle{ (float)r.left, (float)r.top, (float)w, (float)h }, src);
+    }
+    dirty.clear();
+}
+
+void PixelDisplay::Render() {
+    RenderRecorded();
+}
+
+bool PixelDisplay::Record(RenderQueue& queue) {
+    if (!visible) return true;
+
+    if (!texture.id) {
+        Image image = { pixels.data(), width, height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+        texture = LoadTextureFromImage(image);
+        dirty.clear();
+    } else {
+        UploadDirty();
+    }
+
+    queue.BeginLayer(false);
+    RenderQueue::DrawState state = { Shader{ 0, nullptr }, texture.id, BLEND_ALPHA };
+    queue.AddRect(state, (float)kScreenLeft, (float)kScreenTop, (float)width, (float)height, 0, 0, 1, 1, WHITE);
+    return true;
+}
@@ -0,0 +1,168 @@
+#include "PixelKernels.h"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PIXEL_SSE 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define PIXEL_NEON 1
+#endif
+
+void PixelKernels::FillPixels(uint32_t* dst, uint32_t value, int count) {
+    int i = 0;
+#if defined(PIXEL_SSE)
+    __m128i v = _mm_set1_epi32((int)value);
+    for (; i + 16 <= count; i += 16) {
+        _mm_storeu_si128((__m128i*)(dst + i), v);
+        _mm_storeu_si128((__m128i*)(dst + i + 4), v);
+        _mm_storeu_si128((__m128i*)(dst + i + 8), v);
+        _mm_storeu_si128((__m128i*)(dst + i + 12), v);
+    }
+    for (; i + 4 <= count; i += 4) _mm_storeu_si128((__m128i*)(dst + i), v);
+#elif defined(PIXEL_NEON)
+    uint32x4_t v = vdupq_n_u32(value);
+    for (; i + 16 <= count; i += 16) {
+        vst1q_u32(dst + i, v);
+        vst1q_u32(dst + i + 4, v);
+        vst1q_u32(dst + i + 8, v);
+        vst1q_u32(dst + i + 12, v);
+    }
+    for (; i + 4 <= count; i += 4) vst1q_u32(dst + i, v);
+#endif
+    for (; i < count; i++) dst[i] = value;
+}
+
+uint32_t PixelKernels::BlendPixel(uint32_t d, uint32_t s) {
+    uint32_t a = s >> 24;
+    if (a == 255) return s;
+    if (a == 0) return d;
+    uint32_t result = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        uint32_t sc = shift == 24 ? 255 : (s >> shift) & 0xFF;
+        uint32_t x = sc * a + ((d >> shift) & 0xFF) * (255 - a) + 128;
+        result |= ((x + (x >> 8)) >> 8) << shift;
+    }
+    return result;
+}
+
+void PixelKernels::BlendPixels(uint32_t* dst, const uint32_t* src, int count) {
+    int i = 0;
+#if defined(PIXEL_SSE)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alphaBits = _mm_set1_epi32((int)0xFF000000);
+    const __m128i alphaLanes = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+    const __m128i full = _mm_set1_epi16(255);
+    const __m128i half = _mm_set1_epi16(128);
+    for (; i + 4 <= count; i += 4) {
+        __m128i s = _mm_loadu_si128((const __m128i*)(src + i));
+        int opaque = _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(s, alphaBits), alphaBits));
+        if (opaque == 0xFFFF) {
+            _mm_storeu_si128((__m128i*)(dst + i), s);
+            continue;
+        }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(s, alphaBits), zero)) == 0xFFFF) continue;
+
+        __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+        __m128i out[2];
+        for (int half8 = 0; half8 < 2; half8++) {
+            __m128i s16 = half8 ? _mm_unpackhi_epi8(s, zero) : _mm_unpacklo_epi8(s, zero);
+            __m128i d16 = half8 ? _mm_unpackhi_epi8(d, zero) : _mm_unpacklo_epi8(d, zero);
+            __m128i a16 = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s16, 0xFF), 0xFF);
+            s16 = _mm_or_si128(s16, alphaLanes);    // result alpha = a + da * (1 - a)
+            __m128i x = _mm_add_epi16(_mm_mullo_epi16(s16, a16),
+                                      _mm_mullo_epi16(d16, _mm_sub_epi16(full, a16)));
+            x = _mm_add_epi16(x, half);
+            out[half8] = _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+        }
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(out[0], out[1]));
+    }
+#elif defined(PIXEL_NEON)
+    static const uint8_t kAlphaIndex[8] = { 3, 3, 3, 3, 7, 7, 7, 7 };
+    static const uint8_t kAlphaLanes[8] = { 0, 0, 0, 255, 0, 0, 0, 255 };
+    const uint8x8_t alphaIndex = vld1_u8(kAlphaIndex);
+    const uint8x8_t alphaLanes = vld1_u8(kAlphaLanes);
+    for (; i + 2 <= count; i += 2) {
+        uint8x8_t s = vld1_u8((const uint8_t*)(src + i));
+        uint8x8_t d = vld1_u8((const uint8_t*)(dst + i));
+        uint8x8_t a = vtbl1_u8(s, alphaIndex);
+        uint16x8_t x = vmull_u8(vorr_u8(s, alphaLanes), a);
+        x = vmlal_u8(x, d, vmvn_u8(a));
+        vst1_u8((uint8_t*)(dst + i), vrshrn_n_u16(vrsraq_n_u16(x, x, 8), 8));
+    }
+#endif
+    for (; i < count; i++) dst[i] = BlendPixel(dst[i], src[i]);
+}
+
+int PixelKernels::FindMismatch(const uint32_t* row, int start, int end, uint32_t value) {
+    int i = start;
+#if defined(PIXEL_SSE)
+    __m128i v = _mm_set1_epi32((int)value);
+    for (; i + 4 <= end; i += 4) {
+        __m128i eq = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(row + i)), v);
+        if (_mm_movemask_epi8(eq) != 0xFFFF) break;
+    }
+#elif defined(PIXEL_NEON)
+    uint32x4_t v = vdupq_n_u32(value);
+    for (; i + 4 <= end; i += 4) {
+        uint32x4_t eq = vceqq_u32(vld1q_u32(row + i), v);
+        uint32x2_t both = vand_u32(vget_low_u32(eq), vget_high_u32(eq));
+        if ((vget_lane_u32(both, 0) & vget_lane_u32(both, 1)) != 0xFFFFFFFFu) break;
+    }
+#endif
+    while (i < end && row[i] == value) i++;
+    return i;
+}
+
+
+void PixelKernels::BlendGlyphSpan(uint32_t* dst, const unsigned char* mask, int count, uint32_t fore, uint32_t back) {
+    const int kChunk = 64;
+    uint32_t mixed[kChunk];
+    while (count > 0) {
+        int n = count < kChunk ? count : kChunk;
+        int i = 0;
+#if defined(PIXEL_SSE)
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i full = _mm_set1_epi16(255);
+        const __m128i half = _mm_set1_epi16(128);
+        const __m128i f16 = _mm_unpacklo_epi8(_mm_set1_epi32((int)fore), zero);
+        const __m128i b16 = _mm_unpacklo_epi8(_mm_set1_epi32((int)back), zero);
+        for (; i + 4 <= n; i += 4) {
+            int32_t m4;
+            memcpy(&m4, mask + i, 4);
+            __m128i m = _mm_unpacklo_epi8(_mm_cvtsi32_si128(m4), zero);
+            m = _mm_unpacklo_epi16(m, m);           // m0 m0 m1 m1 m2 m2 m3 m3
+            __m128i out[2];
+            for (int half8 = 0; half8 < 2; half8++) {
+                __m128i m16 = half8 ? _mm_unpackhi_epi32(m, m) : _mm_unpacklo_epi32(m, m);
+                __m128i x = _mm_add_epi16(_mm_mullo_epi16(f16, m16),
+                                          _mm_mullo_epi16(b16, _mm_sub_epi16(full, m16)));
+                x = _mm_add_epi16(x, half);
+                out[half8] = _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+            }
+            _mm_storeu_si128((__m128i*)(mixed + i), _mm_packus_epi16(out[0], out[1]));
+        }
+#elif defined(PIXEL_NEON)
+        const uint8x8_t f = vreinterpret_u8_u32(vdup_n_u32(fore));
+        const uint8x8_t b = vreinterpret_u8_u32(vdup_n_u32(back));
+        for (; i + 2 <= n; i += 2) {
+            uint8x8_t m = vext_u8(vdup_n_u8(mask[i]), vdup_n_u8(mask[i + 1]), 4);
+            uint16x8_t x = vmull_u8(f, m);
+            x = vmlal_u8(x, b, vmvn_u8(m));
+            vst1_u8((uint8_t*)(mixed + i), vrshrn_n_u16(vrsraq_n_u16(x, x, 8), 8));
+        }
+#endif
+        for (; i < n; i++) {
+            uint32_t m = mask[i];
+            uint32_t result = 0;
+            for (int shift = 0; shift < 32; shift += 8) {
+                uint32_t x = ((fore >> shift) & 0xFF) * m + ((back >> shift) & 0xFF) * (255 - m) + 128;
+                result |= ((x + (x >> 8)) >> 8) << shift;
+            }
+            mixed[i] = result;
+        }
+        BlendPixels(dst, mixed, n);
+        dst += n;
+        mask += n;
+        count -= n;
+    }
+}
@@ -0,0 +1,192 @@
+#include "Profiler.h"
+#include "TextDisplay.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+Profiler::Profiler()
+    : running(false), byTime(false),
+      interval(1000), countdown(1000),
+      sampleDue(false), timerQuit(false),
+      totalSamples(0) {
+    // ID 0 is reserved for frames whose function is unknown
+    InternFunction("?");
+}
+
+Profiler::~Profiler() {
+    Stop();
+}
+
+void Profiler::StartByInstructions(int instructionInterval) {
+    Stop();
+    interval = instructionInterval > 0 ? instructionInterval : 1;
+    countdown = interval;
+    byTime = false;
+    running = true;
+}
+
+void Profiler::StartByTime(int intervalMs) {
+    Stop();
+    if (intervalMs < 1) intervalMs = 1;
+    byTime = true;
+    sampleDue = false;
+    timerQuit = false;
+    timerThread = std::thread(&Profiler::TimerLoop, this, intervalMs);
+    running = true;
+}
+
+void Profiler::Stop() {
+    running = false;
+    StopTimer();
+}
+
+void Profiler::StopTimer() {
+    if (!timerThread.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(timerMutex);
+        timerQuit = true;
+    }
+    timerWake.notify_all();
+    timerThread.join();
+}
+
+void Profiler::TimerLoop(int intervalMs) {
+    std::unique_lock<std::mutex> lock(timerMutex);
+    while (!timerQuit) {
+        timerWake.wait_for(lock, std::chrono::milliseconds(intervalMs));
+        if (!timerQuit) sampleDue.store(true, std::memory_order_relaxed);
+    }
+}
+
+void Profiler::Reset() {
+    stackCounts.clear();
+    totalSamples = 0;
+}
+
+int Profiler::InternFunction(const std::string& name) {
+    auto it = functionIds.find(name);
+    if (it != functionIds.end()) return it->second;
+    int id = (int)functionNames.size();
+    functionNames.push_back(name);
+    functionIds[name] = id;
+    return id;
+}
+
+const std::string& Profiler::GetFunctionName(int function) const {
+    if (function < 0 || function >= (int)functionNames.size()) return functionNames[0];
+    return functionNames[function];
+}
+
+void Profiler::TakeSample() {
+    countdown = interval;
+    sampleDue.store(false, std::memory_order_relaxed);
+    if (!stackWalker) return;
+
+    scratchStack.clear();
+    stackWalker(scratchStack);
+    if (scratchStack.empty()) return;
+    for (Frame& frame : scratchStack) {
+        if (frame.function < 0 || frame.function >= (int)functionNames.size()) frame.function = 0;
+    }
+
+    // Only a never-before-seen stack allocates
+    auto it = stackCounts.find(scratchStack);
+    if (it != stackCounts.end()) it->second++;
+    else stackCounts.emplace(scratchStack, 1);
+    totalSamples++;
+}
+
+size_t Profiler::StackHash::operator()(const std::vector<Frame>& stack) const {
+    // FNV-1a over the frame fields
+    uint64_t hash = 14695981039346656037ULL;
+    for (const Frame& frame : stack) {
+        hash = (hash ^ (uint32_t)frame.function) * 1099511628211ULL;
+        hash = (hash ^ (uint32_t)frame.line) * 1099511628211ULL;
+    }
+    return (size_t)hash;
+}
+
+bool Profiler::WriteFoldedStacks(const char* path) const {
+    FILE* f = fopen(path, "w");
+    if (!f) return false;
+
+    for (const auto& entry : stackCounts) {
+        const std::vector<Frame>& stack = entry.first;
+        for (size_t i = 0; i < stack.size(); i++) {
+            if (i > 0) fputc(';', f);
+            fprintf(f, "%s:%d", GetFunctionName(stack[i].function).c_str(), stack[i].line);
+        }
+        fprintf(f, " %d\n", entry.second);
+    }
+
+    fclose(f);
+    return true;
+}
+
+std::string Profiler::GetSummary(int maxEntries) const {
+    if (totalSamples == 0) return "No profile samples.\n";
+
+    // Self counts per function and per line come from the leaf frame;
+    // total counts per function count each stack once per function in it
+    std::vector<int> selfByFunc(functionNames.size(), 0);
+    std::vector<int> totalByFunc(functionNames.size(), 0);
+    std::vector<int> seenInStack(functionNames.size(), -1);
+    std::unordered_map<uint64_t, int> selfByLine;
+
+    int stackIndex = 0;
+    for (const auto& entry : stackCounts) {
+        const std::vector<Frame>& stack = entry.first;
+        const Frame& leaf = stack.back();
+        selfByFunc[leaf.function] += entry.second;
+        selfByLine[((uint64_t)(uint32_t)leaf.function << 32) | (uint32_t)leaf.line] += entry.second;
+        for (const Frame& frame : stack) {
+            if (seenInStack[frame.function] == stackIndex) continue;
+            seenInStack[frame.function] = stackIndex;
+            totalByFunc[frame.function] += entry.second;
+        }
+        stackIndex++;
+    }
+
+    std::vector<int> funcs;
+    for (int i = 0; i < (int)functionNames.size(); i++) {
+        if (totalByFunc[i] > 0) funcs.push_back(i);
+    }
+    std::sort(funcs.begin(), funcs.end(), [&](int a, int b) {
+        return selfByFunc[a] > selfByFunc[b];
+    });
+
+    std::vector<std::pair<uint64_t, int>> lines(selfByLine.begin(), selfByLine.end());
+    std::sort(lines.begin(), lines.end(), [](const std::pair<uint64_t, int>& a,
+                                             const std::pair<uint64_t, int>& b) {
+        return a.second > b.second;
+    });
+
+    std::string result;
+    char buf[256];
+    snprintf(buf, sizeof(buf), "%d samples\n self%%  total%%  function\n", totalSamples);
+    result += buf;
+    for (int i = 0; i < (int)funcs.size() && i < maxEntries; i++) {
+        int func = funcs[i];
+        snprintf(buf, sizeof(buf), "%5.1f  %6.1f  %s\n",
+                 100.0f * selfByFunc[func] / totalSamples,
+                 100.0f * totalByFunc[func] / totalSamples,
+                 GetFunctionName(func).c_str());
+        result += buf;
+    }
+
+    result += " self%  line\n";
+    for (int i = 0; i < (int)lines.size() && i < maxEntries; i++) {
+        int func = (int)(lines[i].first >> 32);
+        int line = (int)(uint32_t)lines[i].first;
+        snprintf(buf, sizeof(buf), "%5.1f  %s:%d\n",
+                 100.0f * lines[i].second / totalSamples,
+                 GetFunctionName(func).c_str(), line);
+        result += buf;
+    }
+    return result;
+}
+
+void Profiler::PrintSummary(TextDisplay* display, int maxEntries) const {
+    if (display) display->Print(GetSummary(maxEntries));
+}
@@ -0,0 +1,164 @@
+#include "Qoi.h"
+#include <cstring>
+
+namespace {
+    const unsigned char kOpIndex = 0x00;
+    const unsigned char kOpDiff = 0x40;
+    const unsigned char kOpLuma = 0x80;
+    const unsigned char kOpRun = 0xC0;
+    const unsigned char kOpRGB = 0xFE;
+    const unsigned char kOpRGBA = 0xFF;
+    const unsigned char kMask2 = 0xC0;
+    const int kHeaderSize = 14;
+    const unsigned char kEndMarker[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+
+    struct Pixel {
+        unsigned char r, g, b, a;
+    };
+
+    inline int HashIndex(const Pixel& p) {
+        return (p.r * 3 + p.g * 5 + p.b * 7 + p.a * 11) % 64;
+    }
+
+    inline void Write32(std::vector<unsigned char>& out, unsigned int v) {
+        out.push_back((unsigned char)(v >> 24));
+        out.push_back((unsigned char)(v >> 16));
+        out.push_back((unsigned char)(v >> 8));
+        out.push_back((unsigned char)v);
+    }
+
+    inline unsigned int Read32(const unsigned char* p) {
+        return ((unsigned int)p[0] << 24) | ((unsigned int)p[1] << 16)
+            | ((unsigned int)p[2] << 8) | (unsigned int)p[3];
+    }
+}
+
+void Qoi::Encode(const unsigned char* pixels, int width, int height, std::vector<unsigned char>& out) {
+    out.reserve(out.size() + kHeaderSize + (size_t)width * height + sizeof(kEndMarker));
+    out.push_back('q'); out.push_back('o'); out.push_back('i'); out.push_back('f');
+    Write32(out, (unsigned int)width);
+    Write32(out, (unsigned int)height);
+    out.push_back(4);   // channels
+    out.push_back(0);   // sRGB with linear alpha
+
+    Pixel index[64];
+    memset(index, 0, sizeof(index));
+    Pixel prev = { 0, 0, 0, 255 };
+    int run = 0;
+    size_t count = (size_t)width * height;
+
+    for (size_t i = 0; i < count; i++) {
+        Pixel px;
+        memcpy(&px, pixels + i * 4, 4);
+
+        if (memcmp(&px, &prev, 4) == 0) {
+            run++;
+            if (run == 62 || i == count - 1) {
+                out.push_back((unsigned char)(kOpRun | (run - 1)));
+                run = 0;
+            }
+            continue;
+        }
+        if (run > 0) {
+            out.push_back((unsigned char)(kOpRun | (run - 1)));
+            run = 0;
+        }
+
+        int hash = HashIndex(px);
+        if (memcmp(&index[hash], &px, 4) == 0) {
+            out.push_back((unsigned char)(kOpIndex | hash));
+        } else {
+            index[hash] = px;
+            if (px.a == prev.a) {
+                signed char dr = (signed char)(px.r - prev.r);
+                signed char dg = (signed char)(px.g - prev.g);
+                signed char db = (signed char)(px.b - prev.b);
+                signed char drg = (signed char)(dr - dg);
+                signed char dbg = (signed char)(db - dg);
+                if (dr > -3 && dr < 2 && dg > -3 && dg < 2 && db > -3 && db < 2) {
+                    out.push_back((unsigned char)(kOpDiff | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+                } else if (drg > -9 && drg < 8 && dg > -33 && dg < 32 && dbg > -9 && dbg < 8) {
+                    out.push_back((unsigned char)(kOpLuma | (dg + 32)));
+                    out.push_back((unsigned char)((drg + 8) << 4 | (dbg + 8)));
+                } else {
+                    out.push_back(kOpRGB);
+                    out.push_back(px.r);
+                    out.push_back(px.g);
+                    out.push_back(px.b);
+                }
+            } else {
+                out.push_back(kOpRGBA);
+                out.push_back(px.r);
+                out.push_back(px.g);
+                out.push_back(px.b);
+                out.push_back(px.a);
+            }
+        }
+        prev = px;
+    }
+
+    out.insert(out.end(), kEndMarker, kEndMarker + sizeof(kEndMarker));
+}
+
+bool Qoi::ReadHeader(const unsigned char* data, size_t size, int* outWidth, int* outHeight) {
+    if (size < (size_t)kHeaderSize + sizeof(kEndMarker) || memcmp(data, "qoif", 4) != 0) return false;
+    unsigned int width = Read32(data + 4);
+    unsigned int height = Read32(data + 8);
+    if (width == 0 || height == 0 || width > 32768 || height > 32768) return false;
+    *outWidth = (int)width;
+    *outHeight = (int)height;
+    return true;
+}
+
+bool Qoi::Decode(const unsigned char* data, size_t size, unsigned char* outPixels, int width, int height) {
+    int w, h;
+    if (!ReadHeader(data, size, &w, &h) || w != width || h != height) return false;
+
+    Pixel index[64];
+    memset(index, 0, sizeof(index));
+    Pixel px = { 0, 0, 0, 255 };
+    int run = 0;
+    size_t pos = kHeaderSize;
+    size_t end = size - sizeof(kEndMarker);
+    size_t count = (size_t)width * height;
+
+    for (size_t i = 0; i < count; i++) {
+        if (run > 0) {
+            run--;
+        } else if (pos < end) {
+            unsigned char b1 = data[pos++];
+            if (b1 == kOpRGB) {
+                if (pos + 3 > end) return false;
+                px.r = data[pos++];
+                px.g = data[pos++];
+                px.b = data[pos++];
+            } else if (b1 == kOpRGBA) {
+                if (pos + 4 > end) return false;
+                px.r = data[pos++];
+                px.g = data[pos++];
+                px.b = data[pos++];
+                px.a = data[pos++];
+            } else if ((b1 & kMask2) == kOpIndex) {
+                px = index[b1];
+            } else if ((b1 & kMask2) == kOpDiff) {
+                px.r += ((b1 >> 4) & 0x03) - 2;
+                px.g += ((b1 >> 2) & 0x03) - 2;
+                px.b += (b1 & 0x03) - 2;
+            } else if ((b1 & kMask2) == kOpLuma) {
+                if (pos >= end) return false;
+                unsigned char b2 = data[pos++];
+                int vg = (b1 & 0x3F) - 32;
+                px.r += vg - 8 + ((b2 >> 4) & 0x0F);
+                px.g += vg;
+                px.b += vg - 8 + (b2 & 0x0F);
+            } else {
+                run = b1 & 0x3F;
+            }
+            index[HashIndex(px)] = px;
+        } else {
+            return false;   // ran out of data
+        }
+        memcpy(outPixels + i * 4, &px, 4);
+    }
+    return true;
+}
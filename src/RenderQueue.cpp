@@ -0,0 +1,141 @@
+#include "RenderQueue.h"
+#include "rlgl.h"
+#include <algorithm>
+
+namespace {
+    const int kMaxLayer = 255;
+    const uint32_t kMaxState = 0xFFFFFF;
+    const uint64_t kSequenceMask = 0xFFFFFFFFu;
+}
+
+RenderQueue::RenderQueue()
+    : lastState(-1), layerSortable(false), layer(0),
+      commandCount(0), batchCount(0), stateChangeCount(0) {
+}
+
+void RenderQueue::BeginFrame() {
+    quads.clear();
+    keys.clear();
+    states.clear();
+    lastState = -1;
+    layer = 0;
+    layerSortable = false;
+    commandCount = 0;
+    batchCount = 0;
+    stateChangeCount = 0;
+}
+
+void RenderQueue::BeginLayer(bool sortable) {
+    if (!quads.empty() && layer < kMaxLayer) layer++;
+    layerSortable = sortable;
+}
+
+int RenderQueue::InternState(const DrawState& state) {
+    // Quads nearly always come in runs of one state; check the last one first
+    if (lastState >= 0) {
+        const DrawState& last = states[lastState];
+        if (last.texture == state.texture && last.shader.id == state.shader.id && last.blendMode == state.blendMode) {
+            return lastState;
+        }
+    }
+    for (int i = 0; i < (int)states.size(); i++) {
+        const DrawState& s = states[i];
+        if (s.texture == state.texture && s.shader.id == state.shader.id && s.blendMode == state.blendMode) {
+            lastState = i;
+            return i;
+        }
+    }
+    states.push_back(state);
+    lastState = (int)states.size() - 1;
+    return lastState;
+}
+
+void RenderQueue::AddQuad(const DrawState& state, const Vector2 corners[4],
+                          float u0, float v0, float u1, float v1, Color color, Vector2 extra) {
+    Quad quad;
+    for (int i = 0; i < 4; i++) quad.corners[i] = corners[i];
+    quad.u0 = u0;
+    quad.v0 = v0;
+    quad.u1 = u1;
+    quad.v1 = v1;
+    quad.color = color;
+    quad.extra = extra;
+    quad.state = InternState(state);
+
+    uint64_t key = (uint64_t)layer << 56 | (uint64_t)quads.size();
+    if (layerSortable) key |= (uint64_t)std::min((uint32_t)quad.state, kMaxState) << 32;
+    keys.push_back(key);
+    quads.push_back(quad);
+    commandCount++;
+}
+
+void RenderQueue::AddRect(const DrawState& state, float x, float y, float width, float height,
+                          float u0, float v0, float u1, float v1, Color color, Vector2 extra) {
+    Vector2 corners[4] = {
+        { x, y }, { x, y + height }, { x + width, y + height }, { x + width, y }
+    };
+    AddQuad(state, corners, u0, v0, u1, v1, color, extra);
+}
+
+void RenderQueue::ApplyState(const DrawState* current, const DrawState& next) {
+    // Shader and blend changes flush Raylib's batch; a texture change only
+    // starts a new draw call within it.  Each counts as one state change.
+    unsigned int currentShader = current ? current->shader.id : 0;
+    if (next.shader.id != currentShader) {
+        if (next.shader.id) BeginShaderMode(next.shader);
+        else EndShaderMode();
+        stateChangeCount++;
+    }
+    int currentBlend = current ? current->blendMode : BLEND_ALPHA;
+    if (next.blendMode != currentBlend) {
+        BeginBlendMode(next.blendMode);
+        stateChangeCount++;
+    }
+    if (!current || next.texture != current->texture) {
+        rlSetTexture(next.texture);
+        stateChangeCount++;
+    }
+}
+
+void RenderQueue::Flush() {
+    if (keys.empty()) return;
+
+    // Layers recorded in order with nothing to regroup need no sort
+    if (!std::is_sorted(keys.begin(), keys.end())) std::sort(keys.begin(), keys.end());
+
+    const DrawState* current = nullptr;
+    int currentIndex = -1;
+    for (uint64_t key : keys) {
+        const Quad& q = quads[key & kSequenceMask];
+        if (q.state != currentIndex) {
+            if (current) rlEnd();
+            const DrawState& next = states[q.state];
+            ApplyState(current, next);
+            rlBegin(RL_QUADS);
+            current = &next;
+            currentIndex = q.state;
+            batchCount++;
+        }
+
+        rlColor4ub(q.color.r, q.color.g, q.color.b, q.color.a);
+        rlNormal3f(q.extra.x, q.extra.y, 1.0f);
+        rlTexCoord2f(q.u0, q.v0);
+        rlVertex2f(q.corners[0].x, q.corners[0].y);
+        rlTexCoord2f(q.u0, q.v1);
+        rlVertex2f(q.corners[1].x, q.corners[1].y);
+        rlTexCoord2f(q.u1, q.v1);
+        rlVertex2f(q.corners[2].x, q.corners[2].y);
+        rlTexCoord2f(q.u1, q.v0);
+        rlVertex2f(q.corners[3].x, q.corners[3].y);
+    }
+    rlEnd();
+    rlSetTexture(0);
+    if (current->shader.id) EndShaderMode();
+    if (current->blendMode != BLEND_ALPHA) EndBlendMode();
+
+    // States stay interned for the rest of the frame; later quads start
+    // from a fresh layer
+    quads.clear();
+    keys.clear();
+    layer = 0;
+}
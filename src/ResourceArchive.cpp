@@ -0,0 +1,90 @@
+#include "ResourceArchive.h"
+#include "raylib.h"
+
+using namespace ResourceArchiveFormat;
+
+ResourceArchive::ResourceArchive() : entries(nullptr), entryCount(0) {
+}
+
+bool ResourceArchive::Open(const char* path) {
+    Close();
+    if (!file.Open(path)) return false;
+
+    const unsigned char* base = file.GetData();
+    size_t size = file.GetSize();
+    const ArchiveHeader* header = (const ArchiveHeader*)base;
+    if (size < sizeof(ArchiveHeader)
+        || memcmp(header->magic, kMagic, sizeof(kMagic)) != 0
+        || header->version != kVersion
+        || size < sizeof(ArchiveHeader) + (uint64_t)header->entryCount * sizeof(ArchiveEntry)) {
+        TraceLog(LOG_WARNING, "Ignoring invalid resource archive %s", path);
+        file.Close();
+        return false;
+    }
+
+    // Reject entries that point outside the file, so lookups need no checks
+    const ArchiveEntry* table = (const ArchiveEntry*)(base + sizeof(ArchiveHeader));
+    for (uint32_t i = 0; i < header->entryCount; i++) {
+        const ArchiveEntry& e = table[i];
+        uint64_t pixelsSize = (uint64_t)e.width * e.height * 4;
+        if (e.pathOffset + e.pathLength > size || e.dataOffset + e.dataSize > size
+            || (e.pixelsOffset && e.pixelsOffset + pixelsSize > size)) {
+            TraceLog(LOG_WARNING, "Ignoring corrupt resource archive %s", path);
+            file.Close();
+            return false;
+        }
+    }
+
+    entries = table;
+    entryCount = header->entryCount;
+    TraceLog(LOG_INFO, "Mapped resource archive %s (%d entries)", path, (int)entryCount);
+    return true;
+}
+
+void ResourceArchive::Close() {
+    file.Close();
+    entries = nullptr;
+    entryCount = 0;
+}
+
+const ArchiveEntry* ResourceArchive::Find(const char* relativePath) const {
+    if (!entryCount) return nullptr;
+    size_t length = strlen(relativePath);
+    uint64_t hash = HashPath(relativePath, length);
+
+    // Binary search for the first entry with this hash
+    uint32_t lo = 0, hi = entryCount;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (entries[mid].pathHash < hash) lo = mid + 1;
+        else hi = mid;
+    }
+
+    // Then check the (almost always single) entry with that hash
+    const unsigned char* base = file.GetData();
+    for (; lo < entryCount && entries[lo].pathHash == hash; lo++) {
+        const ArchiveEntry& e = entries[lo];
+        if (e.pathLength == length && memcmp(base + e.pathOffset, relativePath, length) == 0) {
+            return &e;
+        }
+    }
+    return nullptr;
+}
+
+bool ResourceArchive::GetFile(const char* relativePath, const unsigned char** outData, size_t* outSize) const {
+    const ArchiveEntry* e = Find(relativePath);
+    if (!e) return false;
+    *outData = file.GetData() + e->dataOffset;
+    *outSize = (size_t)e->dataSize;
+    return true;
+}
+
+bool ResourceArchive::GetPixels(const char* relativePath, const unsigned char** outPixels,
+                                int* outWidth, int* outHeight) const {
+    const ArchiveEntry* e = Find(relativePath);
+    if (!e || !e->pixelsOffset) return false;
+    *outPixels = file.GetData() + e->pixelsOffset;
+    *outWidth = (int)e->width;
+    *outHeight = (int)e->height;
+    return true;
+}
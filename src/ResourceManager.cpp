@@ -0,0 +1,237 @@
+#include "ResourceManager.h"
+#include "ResourcePath.h"
+#include "ResourceArchive.h"
+#include "ImageCache.h"
+#include "TextureAtlas.h"
+#include <algorithm>
+
+ResourceManager& ResourceManager::Shared() {
+    static ResourceManager instance;
+    return instance;
+}
+
+ResourceManager::ResourceManager() : pool(nullptr), pendingCount(0) {
+}
+
+ResourceManager::~ResourceManager() {
+    // Window and audio device are gone by now, so only stop the workers;
+    // call Shutdown() first to actually release GPU/audio resources
+    delete pool;
+}
+
+ResourceManager::TextureResource* ResourceManager::AcquireTexture(const char* path) {
+    return Acquire(textures, path, false);
+}
+
+ResourceManager::TextureResource* ResourceManager::AcquireImage(const char* path) {
+    return Acquire(images, path, true);
+}
+
+ResourceManager::TextureResource* ResourceManager::Acquire(
+        std::unordered_map<std::string, TextureResource*>& map, const char* path, bool packable) {
+    auto it = map.find(path);
+    if (it != map.end()) {
+        it->second->refCount++;
+        return it->second;
+    }
+
+    TextureResource* resource = new TextureResource();
+    resource->path = path;
+    resource->state = kPending;
+    resource->refCount = 1;
+    resource->image = Image{};
+    resource->imageMapped = false;
+    resource->packable = packable;
+    resource->atlasRegion = -1;
+    resource->texture = Texture2D{};
+    map[resource->path] = resource;
+    pendingCount++;
+
+    if (!pool) pool = new ThreadPool();
+    pool->Submit([this, resource] { DecodeTexture(resource); });
+    return resource;
+}
+
+ResourceManager::SoundResource* ResourceManager::AcquireSound(const char* path) {
+    auto it = sounds.find(path);
+    if (it != sounds.end()) {
+        it->second->refCount++;
+        return it->second;
+    }
+
+    SoundResource* resource = new SoundResource();
+    resource->path = path;
+    resource->state = kPending;
+    resource->refCount = 1;
+    resource->wave = Wave{};
+    resource->sound = Sound{};
+    sounds[resource->path] = resource;
+    pendingCount++;
+
+    if (!pool) pool = new ThreadPool();
+    pool->Submit([this, resource] { DecodeSound(resource); });
+    return resource;
+}
+
+void ResourceManager::Release(TextureResource* resource) {
+    if (!resource || resource->refCount <= 0) return;
+    resource->refCount--;
+    // A resource still being decoded is cleaned up when its upload comes due
+    if (resource->refCount == 0 && resource->state != kPending) Unload(resource);
+}
+
+void ResourceManager::Release(SoundResource* resource) {
+    if (!resource || resource->refCount <= 0) return;
+    resource->refCount--;
+    if (resource->refCount == 0 && resource->state != kPending) Unload(resource);
+}
+
+void ResourceManager::DecodeTexture(TextureResource* resource) {
+    // Worker thread: touches only resource->image, then hands off under the lock
+    const char* path = resource->path.c_str();
+    Image image = Image{};
+    bool mapped = false;
+    const unsigned char* pixels;
+    int width, height;
+    if (GetResourceArchive().GetPixels(path, &pixels, &width, &height)) {
+        // Pre-decoded by the resource packer; upload straight from the mapping
+        image.data = (void*)pixels;
+        image.width = width;
+        image.height = height;
+        image.mipmaps = 1;
+        image.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+        mapped = true;
+    } else {
+        image = ImageCache::Load(path);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    resource->image = image;
+    resource->imageMapped = mapped;
+    decodedTextures.push_back(resource);
+    decoded.notify_all();
+}
+
+void ResourceManager::DecodeSound(SoundResource* resource) {
+    const char* path = resource->path.c_str();
+    Wave wave = Wave{};
+    ResourceData data;
+    if (data.Load(path)) {
+        wave = LoadWaveFromMemory(GetFileExtension(path), data.GetData(), (int)data.GetSize());
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    resource->wave = wave;
+    decodedSounds.push_back(resource);
+    decoded.notify_all();
+}
+
+void ResourceManager::Upload(TextureResource* resource) {
+    pendingCount--;
+    if (resource->image.data) {
+        const Image& image = resource->image;
+        if (resource->packable && image.width <= kMaxPackedSize && image.height <= kMaxPackedSize) {
+            resource->atlasRegion = TextureAtlas::Shared().Add(image);
+        }
+        if (resource->atlasRegion < 0) resource->texture = LoadTextureFromImage(image);
+        if (!resource->imageMapped) UnloadImage(resource->image);
+        resource->image = Image{};
+    }
+    if (resource->texture.id == 0 && resource->atlasRegion < 0) {
+        TraceLog(LOG_ERROR, "Failed to load %s", resource->path.c_str());
+        resource->state = kFailed;
+    } else {
+        resource->state = kReady;
+    }
+    if (resource->refCount == 0) Unload(resource);
+}
+
+void ResourceManager::Upload(SoundResource* resource) {
+    pendingCount--;
+    if (resource->wave.data) {
+        resource->sound = LoadSoundFromWave(resource->wave);
+        UnloadWave(resource->wave);
+        resource->wave = Wave{};
+    }
+    if (resource->sound.frameCount == 0) {
+        TraceLog(LOG_ERROR, "Failed to load %s", resource->path.c_str());
+        resource->state = kFailed;
+    } else {
+        resource->state = kReady;
+    }
+    if (resource->refCount == 0) Unload(resource);
+}
+
+void ResourceManager::Unload(TextureResource* resource) {
+    (resource->packable ? images : textures).erase(resource->path);
+    if (resource->atlasRegion >= 0) TextureAtlas::Shared().Remove(resource->atlasRegion);
+    else if (resource->state == kReady) UnloadTexture(resource->texture);
+    delete resource;
+}
+
+void ResourceManager::Unload(SoundResource* resource) {
+    sounds.erase(resource->path);
+    if (resource->state == kReady) UnloadSound(resource->sound);
+    delete resource;
+}
+
+void ResourceManager::Finish(TextureResource* resource) {
+    if (!resource || resource->state != kPending) return;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        decoded.wait(lock, [&] {
+            return std::find(decodedTextures.begin(), decodedTextures.end(), resource)
+                != decodedTextures.end();
+        });
+        decodedTextures.erase(std::find(decodedTextures.begin(), decodedTextures.end(), resource));
+    }
+    Upload(resource);
+}
+
+void ResourceManager::Finish(SoundResource* resource) {
+    if (!resource || resource->state != kPending) return;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        decoded.wait(lock, [&] {
+            return std::find(decodedSounds.begin(), decodedSounds.end(), resource)
+                != decodedSounds.end();
+        });
+        decodedSounds.erase(std::find(decodedSounds.begin(), decodedSounds.end(), resource));
+    }
+    Upload(resource);
+}
+
+void ResourceManager::Update(int maxUploads) {
+    if (pendingCount == 0) return;
+
+    // Take a batch of decoded resources, oldest first
+    std::vector<TextureResource*> textureBatch;
+    std::vector<SoundResource*> soundBatch;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        int n = std::min(maxUploads, (int)decodedTextures.size());
+        textureBatch.assign(decodedTextures.begin(), decodedTextures.begin() + n);
+        decodedTextures.erase(decodedTextures.begin(), decodedTextures.begin() + n);
+        n = std::min(maxUploads - n, (int)decodedSounds.size());
+        soundBatch.assign(decodedSounds.begin(), decodedSounds.begin() + n);
+        decodedSounds.erase(decodedSounds.begin(), decodedSounds.begin() + n);
+    }
+
+    for (TextureResource* resource : textureBatch) Upload(resource);
+    for (SoundResource* resource : soundBatch) Upload(resource);
+}
+
+void ResourceManager::Shutdown() {
+    if (pool) pool->WaitIdle();
+    while (pendingCount > 0) Update(pendingCount);
+
+    // Copy first, since Unload removes entries from the maps
+    std::vector<TextureResource*> allTextures;
+    for (auto& entry : textures) allTextures.push_back(entry.second);
+    for (auto& entry : images) allTextures.push_back(entry.second);
+    for (TextureResource* resource : allTextures) Unload(resource);
+
+    std::vector<SoundResource*> allSounds;
+    for (auto& entry : sounds) allSounds.push_back(entry.second);
+    for (SoundResource* resource : allSounds) Unload(resource);
+}
@@ -1,6 +1,9 @@
 #include "ResourcePath.h"
+#include "ResourceArchive.h"
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <mutex>
 #include <string>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -11,6 +14,7 @@
 
 #ifdef _WIN32
 #include <windows.h>
+#include <direct.h>
 #endif
 
 // Check if a file or directory exists
@@ -39,15 +43,32 @@ static std::string GetDirectory(const char* path) {
     return "";
 }
 
-std::string GetResourcePath() {
+// Create a folder and any missing parents; returns true if it exists after
+static bool MakeFolders(const std::string& path) {
+    for (size_t i = 1; i <= path.length(); i++) {
+        if (i < path.length() && path[i] != '/' && path[i] != '\\') continue;
+        std::string partial = path.substr(0, i);
+        if (PathExists(partial.c_str())) continue;
+#ifdef _WIN32
+        _mkdir(partial.c_str());
+#else
+        mkdir(partial.c_str(), 0755);
+#endif
+    }
+    return PathExists(path.c_str());
+}
+
+// Find a top-level resource file or folder (e.g. "resources"), returning
+// its full path, or an empty string if it can't be found
+static std::string FindResourceLocation(const char* name) {
     // Try several locations in order of likelihood:
 
-    // 1. Current working directory + resources (for IDE development)
+    // 1. Current working directory (for IDE development)
     char cwd[1024];
     if (getcwd(cwd, sizeof(cwd))) {
-        std::string cwdResources = JoinPath(cwd, "resources");
-        if (PathExists(cwdResources.c_str())) {
-            return cwdResources;
+        std::string cwdPath = JoinPath(cwd, name);
+        if (PathExists(cwdPath.c_str())) {
+            return cwdPath;
         }
     }
 
@@ -57,22 +78,124 @@ std::string GetResourcePath() {
     uint32_t size = sizeof(execPath);
     if (_NSGetExecutablePath(execPath, &size) == 0) {
         // execPath is something like: /path/to/App.app/Contents/MacOS/executable
-        // We want: /path/to/App.app/Contents/Resources/resources
+        // We want: /path/to/App.app/Contents/Resources/<name>
         std::string exeDir = GetDirectory(execPath);           // Contents/MacOS
         std::string contentsDir = GetDirectory(exeDir.c_str()); // Contents
-        std::string bundleResources = JoinPath(contentsDir, "Resources");
-        bundleResources = JoinPath(bundleResources, "resources");
-        if (PathExists(bundleResources.c_str())) {
-            return bundleResources;
+        std::string bundlePath = JoinPath(contentsDir, "Resources");
+        bundlePath = JoinPath(bundlePath, name);
+        if (PathExists(bundlePath.c_str())) {
+            return bundlePath;
         }
     }
 #endif
 
-    // 3. Fallback: assume resources is in current directory
-    return "resources";
+    return "";
+}
+
+std::string GetResourcePath() {
+    std::string path = FindResourceLocation("resources");
+
+    // Fallback: assume resources is in current directory
+    if (path.empty()) path = "resources";
+    return path;
 }
 
 std::string GetResourceFile(const char* relativePath) {
     static std::string resourceBasePath = GetResourcePath();
     return JoinPath(resourceBasePath, relativePath);
 }
+
+// Pick (and create) the per-user folder for cached data
+static std::string FindCacheFolder() {
+    std::string base;
+#if defined(_WIN32)
+    const char* localAppData = getenv("LOCALAPPDATA");
+    if (localAppData) base = JoinPath(JoinPath(localAppData, "MiniMicro2"), "Cache");
+#elif defined(__APPLE__)
+    const char* home = getenv("HOME");
+    if (home) base = JoinPath(JoinPath(home, "Library/Caches"), "MiniMicro2");
+#else
+    const char* xdgCache = getenv("XDG_CACHE_HOME");
+    const char* home = getenv("HOME");
+    if (xdgCache && xdgCache[0]) base = JoinPath(xdgCache, "MiniMicro2");
+    else if (home) base = JoinPath(JoinPath(home, ".cache"), "MiniMicro2");
+#endif
+    if (base.empty() || !MakeFolders(base)) return "";
+    return base;
+}
+
+std::string GetCacheFolder() {
+    static std::string cacheFolder = FindCacheFolder();
+    return cacheFolder;
+}
+
+// Pick (and create) the per-user folder for data that isn't just a cache
+static std::string FindDataFolder() {
+    std::string base;
+#if defined(_WIN32)
+    const char* appData = getenv("APPDATA");
+    if (appData) base = JoinPath(appData, "MiniMicro2");
+#elif defined(__APPLE__)
+    const char* home = getenv("HOME");
+    if (home) base = JoinPath(JoinPath(home, "Library/Application Support"), "MiniMicro2");
+#else
+    const char* xdgData = getenv("XDG_DATA_HOME");
+    const char* home = getenv("HOME");
+    if (xdgData && xdgData[0]) base = JoinPath(xdgData, "MiniMicro2");
+    else if (home) base = JoinPath(JoinPath(home, ".local/share"), "MiniMicro2");
+#endif
+    if (base.empty() || !MakeFolders(base)) return "";
+    return base;
+}
+
+std::string GetDataFolder() {
+    static std::string dataFolder = FindDataFolder();
+    return dataFolder;
+}
+
+const ResourceArchive& GetResourceArchive() {
+    // Resources are loaded from worker threads, so open exactly once
+    static ResourceArchive archive;
+    static std::once_flag opened;
+    std::call_once(opened, [] {
+        std::string path = FindResourceLocation("resources.pak");
+        if (!path.empty()) archive.Open(path.c_str());
+    });
+    return archive;
+}
+
+ResourceData::ResourceData() : data(nullptr), size(0), owned(false) {
+}
+
+ResourceData::~ResourceData() {
+    Clear();
+}
+
+void ResourceData::Clear() {
+    if (owned) free((void*)data);
+    data = nullptr;
+    size = 0;
+    owned = false;
+}
+
+bool ResourceData::Load(const char* relativePath) {
+    Clear();
+    if (GetResourceArchive().GetFile(relativePath, &data, &size)) return true;
+
+    // Not in the archive; read the loose file
+    FILE* f = fopen(GetResourceFile(relativePath).c_str(), "rb");
+    if (!f) return false;
+    fseek(f, 0, SEEK_END);
+    long fileSize = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    unsigned char* buffer = fileSize > 0 ? (unsigned char*)malloc((size_t)fileSize) : nullptr;
+    if (buffer && fread(buffer, 1, (size_t)fileSize, f) == (size_t)fileSize) {
+        data = buffer;
+        size = (size_t)fileSize;
+        owned = true;
+    } else {
+        free(buffer);
+    }
+    fclose(f);
+    return data != nullptr;
+}
@@ -1,20 +1,18 @@
 #include "ScreenFont.h"
 #include "raylib.h"
+#include "ImageCache.h"
+#include "RenderQueue.h"
+#include "rlgl.h"
 
 // Static member initialization
 Shader ScreenFont::shader = {0};
-int ScreenFont::foreColorLoc = -1;
-int ScreenFont::backColorLoc = -1;
 bool ScreenFont::shaderLoaded = false;
 
-ScreenFont::ScreenFont()
-    : charWidth(0), charHeight(0), textureLoaded(false) {
+ScreenFont::ScreenFont() : fontResource(nullptr), maskWidth(0), maskHeight(0) {
 }
 
 ScreenFont::~ScreenFont() {
-    if (textureLoaded) {
-        UnloadTexture(fontTexture);
-    }
+    ResourceManager::Shared().Release(fontResource);
 }
 
 bool ScreenFont::LoadShader(const char* vertexPath, const char* fragmentPath) {
@@ -27,10 +25,6 @@ bool ScreenFont::LoadShader(const char* vertexPath, const char* fragmentPath) {
         shaderLoaded = false;
         return false;
     }
-
-    // Get shader uniform locations
-    foreColorLoc = GetShaderLocation(shader, "foreColor");
-    backColorLoc = GetShaderLocation(shader, "backColor");
     shaderLoaded = true;
 
     return true;
@@ -44,21 +38,36 @@ void ScreenFont::UnloadShader() {
 }
 
 bool ScreenFont::Load(const char* texturePath) {
-    if (textureLoaded) {
-        UnloadTexture(fontTexture);
-    }
+    ResourceManager& resources = ResourceManager::Shared();
+    ResourceManager::TextureResource* previous = fontResource;
+    fontResource = resources.AcquireTexture(texturePath);
+    resources.Release(previous);
+    glyphMasks.clear();
+    return fontResource->state != ResourceManager::kFailed;
+}
 
-    fontTexture = LoadTexture(texturePath);
-    if (fontTexture.id == 0) {
-        textureLoaded = false;
-        return false;
+bool ScreenFont::BuildGlyphMasks() {
+    if (HasGlyphMasks()) return true;
+    if (!IsLoaded()) return false;
+
+    // The texture itself stays on the GPU; decode (or fetch from the image
+    // cache) a CPU copy of the same file
+    Image image = ImageCache::Load(fontResource->path.c_str());
+    if (!image.data) return false;
+    maskWidth = image.width / 16;
+    maskHeight = image.height / 16;
+    glyphMasks.resize((size_t)256 * maskWidth * maskHeight);
+    const unsigned char* rgba = (const unsigned char*)image.data;
+    for (int glyph = 0; glyph < 256; glyph++) {
+        int left = (glyph % 16) * maskWidth;
+        int top = (glyph / 16) * maskHeight;
+        unsigned char* mask = &glyphMasks[(size_t)glyph * maskWidth * maskHeight];
+        for (int y = 0; y < maskHeight; y++) {
+            const unsigned char* src = rgba + ((size_t)(top + y) * image.width + left) * 4;
+            for (int x = 0; x < maskWidth; x++) mask[y * maskWidth + x] = src[x * 4 + 3];
+        }
     }
-
-    // Font should be a 16x16 grid
-    charWidth = fontTexture.width / 16;
-    charHeight = fontTexture.height / 16;
-    textureLoaded = true;
-
+    UnloadImage(image);
     return true;
 }
 
@@ -114,8 +123,13 @@ int ScreenFont::GetFontPosition(int unicode) const {
     return fontPos;
 }
 
-void ScreenFont::DrawChar(int unicode, float x, float y, Color foreColor, Color backColor) {
-    if (!textureLoaded) return;
+void ScreenFont::RecordChar(RenderQueue& queue, int unicode, float x, float y, Color foreColor, Color backColor) const {
+    if (!IsLoaded()) return;
+    const Texture2D& fontTexture = fontResource->texture;
+
+    // Font is a 16x16 grid
+    int charWidth = fontTexture.width / 16;
+    int charHeight = fontTexture.height / 16;
 
     int fontPos = GetFontPosition(unicode);
 
@@ -123,48 +137,24 @@ void ScreenFont::DrawChar(int unicode, float x, float y, Color foreColor, Color
     int charRow = fontPos / 16;
     int charCol = fontPos % 16;
 
-    // Source rectangle in the texture
-    Rectangle source = {
-        (float)(charCol * charWidth),
-        (float)(charRow * charHeight),
-        (float)charWidth,
-        (float)charHeight
-    };
-
-    // Destination rectangle on screen
-    Rectangle dest = {
-        x, y,
-        (float)charWidth,
-        (float)charHeight
-    };
+    // Source rectangle in the texture, normalized
+    float u0 = (float)(charCol * charWidth) / fontTexture.width;
+    float v0 = (float)(charRow * charHeight) / fontTexture.height;
+    float u1 = (float)((charCol + 1) * charWidth) / fontTexture.width;
+    float v1 = (float)((charRow + 1) * charHeight) / fontTexture.height;
 
     if (shaderLoaded) {
-        // Use shader to render with fore/back colors
-        // Convert colors to normalized float arrays
-        float foreColorNorm[4] = {
-            foreColor.r / 255.0f,
-            foreColor.g / 255.0f,
-            foreColor.b / 255.0f,
-            foreColor.a / 255.0f
-        };
-        float backColorNorm[4] = {
-            backColor.r / 255.0f,
-            backColor.g / 255.0f,
-            backColor.b / 255.0f,
-            backColor.a / 255.0f
-        };
-
-        SetShaderValue(shader, foreColorLoc, foreColorNorm, SHADER_UNIFORM_VEC4);
-        SetShaderValue(shader, backColorLoc, backColorNorm, SHADER_UNIFORM_VEC4);
-
-        BeginShaderMode(shader);
-        DrawTexturePro(fontTexture, source, dest, (Vector2){0, 0}, 0.0f, WHITE);
-        EndShaderMode();
+        // The shader unpacks the background from (r*256 + g, b*256 + a)
+        RenderQueue::DrawState state = { shader, fontTexture.id, BLEND_ALPHA };
+        Vector2 back = { backColor.r * 256.0f + backColor.g, backColor.b * 256.0f + backColor.a };
+        queue.AddRect(state, x, y, (float)charWidth, (float)charHeight, u0, v0, u1, v1, foreColor, back);
     } else {
         // Fallback: draw background and character separately
         if (backColor.a > 0) {
-            DrawRectangleRec(dest, backColor);
+            RenderQueue::DrawState plain = { Shader{ 0, nullptr }, rlGetTextureIdDefault(), BLEND_ALPHA };
+            queue.AddRect(plain, x, y, (float)charWidth, (float)charHeight, 0, 0, 1, 1, backColor);
         }
-        DrawTexturePro(fontTexture, source, dest, (Vector2){0, 0}, 0.0f, foreColor);
+        RenderQueue::DrawState state = { Shader{ 0, nullptr }, fontTexture.id, BLEND_ALPHA };
+        queue.AddRect(state, x, y, (float)charWidth, (float)charHeight, u0, v0, u1, v1, foreColor);
     }
 }
@@ -0,0 +1,124 @@
+#include "ScreenPresenter.h"
+#include "Display.h"
+#include "rlgl.h"
+#include <cmath>
+
+ScreenPresenter::ScreenPresenter()
+    : canvas(RenderTexture2D{}), overlay(RenderTexture2D{}), targetsLoaded(false), overlayReady(false),
+      integerScaling(false), scanlines(0), curvature(0), shader(Shader{}), shaderLoaded(false),
+      overlayLoc(-1), useOverlayLoc(-1), canvasSizeLoc(-1), outputScaleLoc(-1), screenRectLoc(-1),
+      scanlinesLoc(-1), curvatureLoc(-1) {
+}
+
+ScreenPresenter::~ScreenPresenter() {
+    if (targetsLoaded) {
+        UnloadRenderTexture(canvas);
+        UnloadRenderTexture(overlay);
+    }
+    if (shaderLoaded) UnloadShader(shader);
+}
+
+bool ScreenPresenter::LoadShader(const char* fragmentPath) {
+    if (shaderLoaded) ::UnloadShader(shader);
+    shader = ::LoadShader(nullptr, fragmentPath);
+    if (shader.id == 0) {
+        shaderLoaded = false;
+        return false;
+    }
+
+    overlayLoc = GetShaderLocation(shader, "overlay");
+    useOverlayLoc = GetShaderLocation(shader, "useOverlay");
+    canvasSizeLoc = GetShaderLocation(shader, "canvasSize");
+    outputScaleLoc = GetShaderLocation(shader, "outputScale");
+    screenRectLoc = GetShaderLocation(shader, "screenRect");
+    scanlinesLoc = GetShaderLocation(shader, "scanlines");
+    curvatureLoc = GetShaderLocation(shader, "curvature");
+    shaderLoaded = true;
+    return true;
+}
+
+void ScreenPresenter::EnsureTargets() {
+    if (targetsLoaded) return;
+    canvas = LoadRenderTexture(kCanvasWidth, kCanvasHeight);
+    overlay = LoadRenderTexture(kCanvasWidth, kCanvasHeight);
+    targetsLoaded = true;
+}
+
+void ScreenPresenter::BeginCanvas() {
+    EnsureTargets();
+    BeginTextureMode(canvas);
+}
+
+void ScreenPresenter::EndCanvas() {
+    EndTextureMode();
+}
+
+void ScreenPresenter::BeginOverlay() {
+    EnsureTargets();
+    BeginTextureMode(overlay);
+    ClearBackground(BLANK);
+
+    // Keep the art's own alpha, rather than alpha squared, where it lands
+    // on the transparent target
+    rlSetBlendFactorsSeparate(RL_SRC_ALPHA, RL_ONE_MINUS_SRC_ALPHA, RL_ONE, RL_ONE_MINUS_SRC_ALPHA,
+                              RL_FUNC_ADD, RL_FUNC_ADD);
+    BeginBlendMode(BLEND_CUSTOM_SEPARATE);
+}
+
+void ScreenPresenter::EndOverlay() {
+    EndBlendMode();
+    EndTextureMode();
+    overlayReady = true;
+}
+
+void ScreenPresenter::Present(bool withOverlay, Color background) {
+    EnsureTargets();
+    withOverlay = withOverlay && overlayReady;
+
+    // Fit the canvas to the window.  Scale is worked out in physical pixels,
+    // so integer scaling stays exact on HiDPI screens; drawing is in logical
+    // units, which raylib maps to physical ones.
+    float windowWidth = (float)GetScreenWidth();
+    float windowHeight = (float)GetScreenHeight();
+    float pixelRatio = windowWidth > 0 ? GetRenderWidth() / windowWidth : 1.0f;
+    float pixelScale = fminf(GetRenderWidth() / (float)kCanvasWidth, GetRenderHeight() / (float)kCanvasHeight);
+    if (integerScaling && pixelScale >= 1.0f) pixelScale = floorf(pixelScale);
+    float scale = pixelScale / pixelRatio;
+    Rectangle dest = { (windowWidth - kCanvasWidth * scale) / 2, (windowHeight - kCanvasHeight * scale) / 2,
+                       kCanvasWidth * scale, kCanvasHeight * scale };
+
+    // Render textures are stored bottom-up; a negative source height flips them
+    Rectangle source = { 0, 0, (float)kCanvasWidth, -(float)kCanvasHeight };
+
+    // Mouse positions in canvas coordinates, as before the window could scale
+    SetMouseOffset(-(int)dest.x, -(int)dest.y);
+    SetMouseScale(1.0f / scale, 1.0f / scale);
+
+    ClearBackground(background);
+    if (!shaderLoaded) {
+        bool whole = fabsf(pixelScale - floorf(pixelScale)) < 0.001f;
+        SetTextureFilter(canvas.texture, whole ? TEXTURE_FILTER_POINT : TEXTURE_FILTER_BILINEAR);
+        DrawTexturePro(canvas.texture, source, dest, Vector2{ 0, 0 }, 0.0f, WHITE);
+        if (withOverlay) DrawTexturePro(overlay.texture, source, dest, Vector2{ 0, 0 }, 0.0f, WHITE);
+        return;
+    }
+
+    // One pass: canvas with CRT effects, sharp-bilinear scaled, under the overlay
+    SetTextureFilter(canvas.texture, TEXTURE_FILTER_BILINEAR);
+    SetTextureFilter(overlay.texture, TEXTURE_FILTER_BILINEAR);
+    float canvasSize[2] = { (float)kCanvasWidth, (float)kCanvasHeight };
+    float screenRect[4] = { (float)Display::kScreenLeft, (float)Display::kScreenTop,
+                            (float)Display::kScreenWidth, (float)Display::kScreenHeight };
+    int useOverlay = withOverlay ? 1 : 0;
+    SetShaderValue(shader, canvasSizeLoc, canvasSize, SHADER_UNIFORM_VEC2);
+    SetShaderValue(shader, outputScaleLoc, &pixelScale, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(shader, screenRectLoc, screenRect, SHADER_UNIFORM_VEC4);
+    SetShaderValue(shader, scanlinesLoc, &scanlines, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(shader, curvatureLoc, &curvature, SHADER_UNIFORM_FLOAT);
+    SetShaderValue(shader, useOverlayLoc, &useOverlay, SHADER_UNIFORM_INT);
+
+    BeginShaderMode(shader);
+    SetShaderValueTexture(shader, overlayLoc, overlay.texture);
+    DrawTexturePro(canvas.texture, source, dest, Vector2{ 0, 0 }, 0.0f, WHITE);
+    EndShaderMode();
+}
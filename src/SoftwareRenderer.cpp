@@ -0,0 +1,179 @@
+#include "SoftwareRenderer.h"
+#include "Machine.h"
+#include "PixelDisplay.h"
+#include "PixelKernels.h"
+#include "ScreenPresenter.h"
+#include "SolidColorDisplay.h"
+#include "TextDisplay.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+using namespace PixelKernels;
+
+namespace {
+    const int kScreenLeft = Display::kScreenLeft;
+    const int kScreenTop = Display::kScreenTop;
+    const int kCanvasWidth = ScreenPresenter::kCanvasWidth;
+    const int kCanvasHeight = ScreenPresenter::kCanvasHeight;
+}
+
+SoftwareRenderer::SoftwareRenderer(int threadCount)
+    : pool(threadCount), pixels((size_t)kWidth * kHeight, 0), texture(Texture2D{}), lastRasterizeMs(0),
+      warnedUnsupported(false) {
+}
+
+SoftwareRenderer::~SoftwareRenderer() {
+    if (texture.id) UnloadTexture(texture);
+}
+
+bool SoftwareRenderer::Rasterize(Machine& machine) {
+    auto start = std::chrono::steady_clock::now();
+
+    // Gather layers on this thread, from the topmost opaque one up
+    int first = Machine::kDisplayCount - 1;
+    for (int i = 0; i < Machine::kDisplayCount; i++) {
+        Display* display = machine.GetDisplay(i);
+        if (display && display->IsOpaque()) {
+            first = i;
+            break;
+        }
+    }
+    layers.clear();
+    for (int i = first; i >= 0; i--) {
+        Display* display = machine.GetDisplay(i);
+        if (!display || !display->IsVisible()) continue;
+        bool supported = true;
+        if (display->HasTransform()) {
+            supported = false;
+        } else if (dynamic_cast<SolidColorDisplay*>(display)) {
+            layers.push_back(Layer{ kSolidLayer, display });
+        } else if (TextDisplay* text = dynamic_cast<TextDisplay*>(display)) {
+            // Masks are built here, so band jobs only ever read them
+            supported = text->GetFont()->BuildGlyphMasks();
+            if (supported) layers.push_back(Layer{ kTextLayer, display });
+        } else if (dynamic_cast<PixelDisplay*>(display)) {
+            layers.push_back(Layer{ kPixelLayer, display });
+        } else {
+            supported = false;
+        }
+        if (!supported) {
+            // Skipping the layer would show whatever is under it instead
+            if (!warnedUnsupported) {
+                TraceLog(LOG_WARNING, "SoftwareRenderer: layer %d can't be rasterized; drawing with GL", i);
+                warnedUnsupported = true;
+            }
+            layers.clear();
+            return false;
+        }
+    }
+
+    for (int top = 0; top < kHeight; top += kBandHeight) {
+        int bottom = top + kBandHeight < kHeight ? top + kBandHeight : kHeight;
+        pool.Submit([this, top, bottom]() { RenderBand(top, bottom); });
+    }
+    pool.WaitIdle();
+
+    lastRasterizeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+void SoftwareRenderer::RenderBand(int top, int bottom) {
+    // Start from a blank band, like the GL path's cleared canvas; otherwise
+    // a frame without an opaque layer would blend over the previous one
+    FillPixels(&pixels[(size_t)top * kWidth], 0, (bottom - top) * kWidth);
+    for (const Layer& layer : layers) {
+        switch (layer.kind) {
+        case kSolidLayer: {
+            // Like ClearBackground: replaces, rather than blends
+            uint32_t value = PackColor(static_cast<SolidColorDisplay*>(layer.display)->GetColor());
+            FillPixels(&pixels[(size_t)top * kWidth], value, (bottom - top) * kWidth);
+            break;
+        }
+        case kTextLayer:
+            RenderText(layer, top, bottom);
+            break;
+        case kPixelLayer:
+            RenderPixels(layer, top, bottom);
+            break;
+        }
+    }
+}
+
+void SoftwareRenderer::RenderText(const Layer& layer, int top, int bottom) {
+    const TextDisplay* text = static_cast<const TextDisplay*>(layer.display);
+    const ScreenFont* font = text->GetFont();
+    int glyphWidth = font->GetMaskWidth();
+    int glyphHeight = font->GetMaskHeight();
+
+    // Same cell order as TextDisplay::Render, so overlapping glyphs match
+    for (int row = 0; row < text->GetRows(); row++) {
+        int y = (int)floorf(text->GetCellPosition(row, 0).y + 0.5f) - kScreenTop;
+        int y0 = y > top ? y : top;
+        int y1 = y + glyphHeight < bottom ? y + glyphHeight : bottom;
+        if (y0 >= y1) continue;
+
+        for (int col = 0; col < text->GetCols(); col++) {
+            const TextDisplay::Cell* cell = text->Get(row, col);
+            int fontPos = font->GetFontPosition(cell->character);
+            if (fontPos < 0 || fontPos > 255) continue;
+            Color fore = cell->inverse ? cell->backColor : cell->foreColor;
+            Color back = cell->inverse ? cell->foreColor : cell->backColor;
+
+            int x = (int)floorf(text->GetCellPosition(row, col).x + 0.5f) - kScreenLeft;
+            int x0 = x > 0 ? x : 0;
+            int x1 = x + glyphWidth < kWidth ? x + glyphWidth : kWidth;
+            if (x0 >= x1) continue;
+
+            const unsigned char* mask = font->GetGlyphMask(fontPos);
+            for (int py = y0; py < y1; py++) {
+                BlendGlyphSpan(&pixels[(size_t)py * kWidth + x0], mask + (py - y) * glyphWidth + (x0 - x),
+                               x1 - x0, PackColor(fore), PackColor(back));
+            }
+        }
+    }
+}
+
+void SoftwareRenderer::RenderPixels(const Layer& layer, int top, int bottom) {
+    const PixelDisplay* gfx = static_cast<const PixelDisplay*>(layer.display);
+    int width = gfx->GetWidth() < kWidth ? gfx->GetWidth() : kWidth;
+    int rows = gfx->GetHeight() < bottom ? gfx->GetHeight() : bottom;
+    for (int y = top; y < rows; y++) {
+        BlendPixels(&pixels[(size_t)y * kWidth], gfx->GetPixels() + (size_t)y * gfx->GetWidth(), width);
+    }
+}
+
+void SoftwareRenderer::Present() {
+    if (!texture.id) {
+        Image image = { pixels.data(), kWidth, kHeight, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+        texture = LoadTextureFromImage(image);
+    } else {
+        UpdateTexture(texture, pixels.data());
+    }
+    DrawTexture(texture, kScreenLeft, kScreenTop, WHITE);
+}
+
+int SoftwareRenderer::CountMismatches(const Image& canvas, int tolerance, int* outMaxDifference) const {
+    int mismatches = 0;
+    int maxDifference = 0;
+    if (canvas.width != kCanvasWidth || canvas.height != kCanvasHeight || canvas.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8) {
+        if (outMaxDifference) *outMaxDifference = 255;
+        return kWidth * kHeight;
+    }
+    const unsigned char* image = (const unsigned char*)canvas.data;
+    for (int y = 0; y < kHeight; y++) {
+        const unsigned char* a = (const unsigned char*)&pixels[(size_t)y * kWidth];
+        const unsigned char* b = image + ((size_t)(y + kScreenTop) * kCanvasWidth + kScreenLeft) * 4;
+        for (int x = 0; x < kWidth; x++) {
+            int difference = 0;
+            for (int c = 0; c < 3; c++) {
+                int d = abs(a[x * 4 + c] - b[x * 4 + c]);
+                if (d > difference) difference = d;
+            }
+            if (difference > maxDifference) maxDifference = difference;
+            if (difference > tolerance) mismatches++;
+        }
+    }
+    if (outMaxDifference) *outMaxDifference = maxDifference;
+    return mismatches;
+}
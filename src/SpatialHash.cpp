@@ -0,0 +1,159 @@
+#include "SpatialHash.h"
+#include <cmath>
+
+namespace {
+    // Items spanning this many cells in either direction go in the
+    // oversized list, which every query checks, instead of in cells
+    const int kMaxCellSpan = 64;
+}
+
+SpatialHash::SpatialHash(float cellSize, int bucketCount)
+    : cellSize(cellSize), inverseCellSize(1.0f / cellSize), stamp(0), count(0) {
+    int size = 1;
+    while (size < bucketCount) size <<= 1;
+    bucketMask = size - 1;
+    buckets.resize(size);
+}
+
+void SpatialHash::Clear() {
+    for (std::vector<int>& bucket : buckets) bucket.clear();
+    items.clear();
+    oversized.clear();
+    stamps.clear();
+    count = 0;
+}
+
+int SpatialHash::CellOf(float v) const {
+    return (int)floorf(v * inverseCellSize);
+}
+
+int SpatialHash::Bucket(int cellX, int cellY) const {
+    uint32_t h = (uint32_t)cellX * 73856093u ^ (uint32_t)cellY * 19349663u;
+    return (int)(h & (uint32_t)bucketMask);
+}
+
+void SpatialHash::AddToCells(int id, const Item& item) {
+    for (int cy = item.cellY0; cy <= item.cellY1; cy++) {
+        for (int cx = item.cellX0; cx <= item.cellX1; cx++) {
+            buckets[Bucket(cx, cy)].push_back(id);
+        }
+    }
+}
+
+void SpatialHash::RemoveFromCells(int id, const Item& item) {
+    for (int cy = item.cellY0; cy <= item.cellY1; cy++) {
+        for (int cx = item.cellX0; cx <= item.cellX1; cx++) {
+            std::vector<int>& bucket = buckets[Bucket(cx, cy)];
+            for (size_t i = 0; i < bucket.size(); i++) {
+                if (bucket[i] == id) {
+                    bucket[i] = bucket.back();
+                    bucket.pop_back();
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void SpatialHash::Unlink(int id, const Item& item) {
+    if (!item.oversized) {
+        RemoveFromCells(id, item);
+        return;
+    }
+    for (size_t i = 0; i < oversized.size(); i++) {
+        if (oversized[i] == id) {
+            oversized[i] = oversized.back();
+            oversized.pop_back();
+            break;
+        }
+    }
+}
+
+void SpatialHash::Update(int id, float minX, float minY, float maxX, float maxY) {
+    if (id < 0) return;
+    if (id >= (int)items.size()) {
+        items.resize(id + 1, Item());
+        stamps.resize(id + 1, 0);
+    }
+
+    Item moved;
+    moved.minX = minX;
+    moved.minY = minY;
+    moved.maxX = maxX;
+    moved.maxY = maxY;
+    moved.cellX0 = CellOf(minX);
+    moved.cellY0 = CellOf(minY);
+    moved.cellX1 = CellOf(maxX);
+    moved.cellY1 = CellOf(maxY);
+    moved.oversized = moved.cellX1 - moved.cellX0 >= kMaxCellSpan || moved.cellY1 - moved.cellY0 >= kMaxCellSpan;
+    moved.present = true;
+
+    Item& item = items[id];
+    if (item.present) {
+        bool sameCells = item.oversized ? moved.oversized
+                       : !moved.oversized && item.cellX0 == moved.cellX0 && item.cellY0 == moved.cellY0
+                         && item.cellX1 == moved.cellX1 && item.cellY1 == moved.cellY1;
+        if (sameCells) {
+            item = moved;       // only the bounds changed
+            return;
+        }
+        Unlink(id, item);
+    } else {
+        count++;
+    }
+    item = moved;
+    if (item.oversized) oversized.push_back(id);
+    else AddToCells(id, item);
+}
+
+void SpatialHash::Remove(int id) {
+    if (!Contains(id)) return;
+    Unlink(id, items[id]);
+    items[id].present = false;
+    count--;
+}
+
+void SpatialHash::Query(float minX, float minY, float maxX, float maxY, std::vector<int>& out) {
+    if (++stamp == 0) {
+        // Wrapped around; forget old stamps so nothing is wrongly skipped
+        for (uint32_t& s : stamps) s = 0;
+        stamp = 1;
+    }
+
+    int x0 = CellOf(minX), y0 = CellOf(minY);
+    int x1 = CellOf(maxX), y1 = CellOf(maxY);
+    if (x1 - x0 >= kMaxCellSpan || y1 - y0 >= kMaxCellSpan) {
+        // Query covers a large area; checking every item is cheaper
+        for (int id = 0; id < (int)items.size(); id++) {
+            const Item& item = items[id];
+            if (item.present && item.minX <= maxX && minX <= item.maxX && item.minY <= maxY && minY <= item.maxY) {
+                out.push_back(id);
+            }
+        }
+        return;
+    }
+
+    for (int id : oversized) {
+        stamps[id] = stamp;
+        const Item& item = items[id];
+        if (item.minX <= maxX && minX <= item.maxX && item.minY <= maxY && minY <= item.maxY) {
+            out.push_back(id);
+        }
+    }
+    for (int cy = y0; cy <= y1; cy++) {
+        for (int cx = x0; cx <= x1; cx++) {
+            for (int id : buckets[Bucket(cx, cy)]) {
+                if (stamps[id] == stamp) continue;
+                stamps[id] = stamp;
+                const Item& item = items[id];
+                if (item.minX <= maxX && minX <= item.maxX && item.minY <= maxY && minY <= item.maxY) {
+                    out.push_back(id);
+                }
+            }
+        }
+    }
+}
+
+void SpatialHash::QueryPoint(float x, float y, std::vector<int>& out) {
+    Query(x, y, x, y, out);
+}
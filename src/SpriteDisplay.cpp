@@ -0,0 +1,447 @@
+#include "SpriteDisplay.h"
+#include "TextureAtlas.h"
+#include "RenderQueue.h"
+#include <algorithm>
+#include <cmath>
+
+SpriteDisplay::SpriteDisplay()
+    : anyChanged(false), removedCount(0), useOrder(false), sortByTexture(false), lastDrawnCount(0), lastBatchCount(0) {
+}
+
+SpriteDisplay::~SpriteDisplay() {
+}
+
+void SpriteDisplay::Clear() {
+    ids.clear();
+    x.clear();
+    y.clear();
+    scaleX.clear();
+    scaleY.clear();
+    rotation.clear();
+    cosR.clear();
+    sinR.clear();
+    tint.clear();
+    image.clear();
+    changed.clear();
+    corners.clear();
+    minX.clear();
+    minY.clear();
+    maxX.clear();
+    maxY.clear();
+    slotOfId.clear();
+    freeIds.clear();
+    removedCount = 0;
+    order.clear();
+    useOrder = false;
+    anyChanged = false;
+    spatialHash.Clear();
+}
+
+//--------------------------------------------------------------------------------
+// Images
+
+int SpriteDisplay::AddImage(Texture2D texture) {
+    return AddImage(texture, Rectangle{ 0, 0, (float)texture.width, (float)texture.height });
+}
+
+int SpriteDisplay::AddImage(Texture2D texture, Rectangle source) {
+    images.push_back(SpriteImage{ texture, source, nullptr, -1, 0 });
+    return (int)images.size() - 1;
+}
+
+int SpriteDisplay::AddImage(const TextureAtlas* atlas, int region) {
+    if (!atlas || !atlas->IsRegion(region)) return -1;
+    TextureAtlas::Region r = atlas->GetRegion(region);
+    images.push_back(SpriteImage{ r.texture, r.source, atlas, region, atlas->GetGeneration() });
+    return (int)images.size() - 1;
+}
+
+int SpriteDisplay::AddImage(const ResourceManager::TextureResource* resource) {
+    if (!resource || !resource->IsReady()) return -1;
+    if (resource->atlasRegion >= 0) return AddImage(&TextureAtlas::Shared(), resource->atlasRegion);
+    return AddImage(resource->texture);
+}
+
+void SpriteDisplay::RefreshAtlasImages() {
+    for (SpriteImage& img : images) {
+        if (!img.atlas || img.generation == img.atlas->GetGeneration()) continue;
+        TextureAtlas::Region r = img.atlas->GetRegion(img.region);
+        img.texture = r.texture;
+        img.source = r.source;      // same size, so sprite corners are unaffected
+        img.generation = img.atlas->GetGeneration();
+    }
+}
+
+void SpriteDisplay::SetImage(int index, Texture2D texture, Rectangle source) {
+    if (index < 0 || index >= (int)images.size()) return;
+    images[index] = SpriteImage{ texture, source, nullptr, -1, 0 };
+    for (int slot = 0; slot < (int)ids.size(); slot++) {
+        if (ids[slot] >= 0 && image[slot] == index) MarkChanged(slot);
+    }
+}
+
+//--------------------------------------------------------------------------------
+// Sprites
+
+int SpriteDisplay::AddSprite(int imageIndex, float spriteX, float spriteY) {
+    if (imageIndex < 0 || imageIndex >= (int)images.size()) return -1;
+
+    int id;
+    if (!freeIds.empty()) {
+        id = freeIds.back();
+        freeIds.pop_back();
+    } else {
+        id = (int)slotOfId.size();
+        slotOfId.push_back(-1);
+    }
+    int slot = (int)ids.size();
+    slotOfId[id] = slot;
+
+    ids.push_back(id);
+    x.push_back(spriteX);
+    y.push_back(spriteY);
+    scaleX.push_back(1.0f);
+    scaleY.push_back(1.0f);
+    rotation.push_back(0.0f);
+    cosR.push_back(1.0f);
+    sinR.push_back(0.0f);
+    tint.push_back(WHITE);
+    image.push_back(imageIndex);
+    changed.push_back(0);
+    corners.resize(corners.size() + 4);
+    minX.push_back(spriteX);
+    minY.push_back(spriteY);
+    maxX.push_back(spriteX);
+    maxY.push_back(spriteY);
+    MarkChanged(slot);
+    return id;
+}
+
+void SpriteDisplay::RemoveSprite(int id) {
+    int slot = SlotOf(id);
+    if (slot < 0) return;
+
+    // Leave a tombstone; the slot is dropped at the next compaction
+    ids[slot] = -1;
+    changed[slot] = 0;
+    slotOfId[id] = -1;
+    freeIds.push_back(id);
+    spatialHash.Remove(id);
+    removedCount++;
+
+    // Without frames (e.g. a script removing in a loop), still compact
+    // before tombstones outnumber live sprites
+    if (removedCount * 2 > (int)ids.size()) CompactSlots();
+}
+
+void SpriteDisplay::CompactSlots() {
+    if (removedCount == 0) return;
+    int count = (int)ids.size();
+    int to = 0;
+    for (int from = 0; from < count; from++) {
+        if (ids[from] < 0) continue;
+        if (to != from) {
+            ids[to] = ids[from];
+            x[to] = x[from];
+            y[to] = y[from];
+            scaleX[to] = scaleX[from];
+            scaleY[to] = scaleY[from];
+            rotation[to] = rotation[from];
+            cosR[to] = cosR[from];
+            sinR[to] = sinR[from];
+            tint[to] = tint[from];
+            image[to] = image[from];
+            changed[to] = changed[from];
+            for (int i = 0; i < 4; i++) corners[to * 4 + i] = corners[from * 4 + i];
+            minX[to] = minX[from];
+            minY[to] = minY[from];
+            maxX[to] = maxX[from];
+            maxY[to] = maxY[from];
+            slotOfId[ids[to]] = to;
+        }
+        to++;
+    }
+    ids.resize(to);
+    x.resize(to);
+    y.resize(to);
+    scaleX.resize(to);
+    scaleY.resize(to);
+    rotation.resize(to);
+    cosR.resize(to);
+    sinR.resize(to);
+    tint.resize(to);
+    image.resize(to);
+    changed.resize(to);
+    corners.resize((size_t)to * 4);
+    minX.resize(to);
+    minY.resize(to);
+    maxX.resize(to);
+    maxY.resize(to);
+    removedCount = 0;
+}
+
+void SpriteDisplay::SetPosition(int id, float spriteX, float spriteY) {
+    int slot = SlotOf(id);
+    if (slot < 0) return;
+    x[slot] = spriteX;
+    y[slot] = spriteY;
+    MarkChanged(slot);
+}
+
+void SpriteDisplay::SetPositions(const int* spriteIds, const float* xs, const float* ys, int count) {
+    for (int i = 0; i < count; i++) {
+        int slot = SlotOf(spriteIds[i]);
+        if (slot < 0) continue;
+        x[slot] = xs[i];
+        y[slot] = ys[i];
+        changed[slot] = 1;
+    }
+    if (count > 0) anyChanged = true;
+}
+
+void SpriteDisplay::SetScale(int id, float sx, float sy) {
+    int slot = SlotOf(id);
+    if (slot < 0) return;
+    scaleX[slot] = sx;
+    scaleY[slot] = sy;
+    MarkChanged(slot);
+}
+
+void SpriteDisplay::SetRotation(int id, float degrees) {
+    int slot = SlotOf(id);
+    if (slot < 0) return;
+    rotation[slot] = degrees;
+    float radians = degrees * (3.14159265f / 180.0f);
+    cosR[slot] = cosf(radians);
+    sinR[slot] = sinf(radians);
+    MarkChanged(slot);
+}
+
+void SpriteDisplay::SetTint(int id, Color color) {
+    int slot = SlotOf(id);
+    if (slot >= 0) tint[slot] = color;
+}
+
+void SpriteDisplay::SetSpriteImage(int id, int imageIndex) {
+    int slot = SlotOf(id);
+    if (slot < 0 || imageIndex < 0 || imageIndex >= (int)images.size()) return;
+    image[slot] = imageIndex;
+    MarkChanged(slot);
+}
+
+float SpriteDisplay::GetX(int id) const {
+    int slot = SlotOf(id);
+    return slot >= 0 ? x[slot] : 0.0f;
+}
+
+float SpriteDisplay::GetY(int id) const {
+    int slot = SlotOf(id);
+    return slot >= 0 ? y[slot] : 0.0f;
+}
+
+float SpriteDisplay::GetRotation(int id) const {
+    int slot = SlotOf(id);
+    return slot >= 0 ? rotation[slot] : 0.0f;
+}
+
+Rectangle SpriteDisplay::GetBounds(int id) {
+    int slot = SlotOf(id);
+    if (slot < 0) return Rectangle{ 0, 0, 0, 0 };
+    UpdateTransforms();
+    return Rectangle{ minX[slot], minY[slot], maxX[slot] - minX[slot], maxY[slot] - minY[slot] };
+}
+
+void SpriteDisplay::UpdateTransforms() {
+    if (!anyChanged) return;
+    int count = (int)ids.size();
+    for (int slot = 0; slot < count; slot++) {
+        if (!changed[slot]) continue;
+        changed[slot] = 0;
+
+        const Rectangle& source = images[image[slot]].source;
+        float hw = fabsf(source.width) * 0.5f * scaleX[slot];
+        float hh = fabsf(source.height) * 0.5f * scaleY[slot];
+        float c = cosR[slot], s = sinR[slot];
+        float cx = x[slot], cy = y[slot];
+
+        // Top-left, bottom-left, bottom-right, top-right (y up)
+        Vector2* q = &corners[slot * 4];
+        q[0] = Vector2{ cx - hw * c - hh * s, cy - hw * s + hh * c };
+        q[1] = Vector2{ cx - hw * c + hh * s, cy - hw * s - hh * c };
+        q[2] = Vector2{ cx + hw * c + hh * s, cy + hw * s - hh * c };
+        q[3] = Vector2{ cx + hw * c - hh * s, cy + hw * s + hh * c };
+
+        minX[slot] = std::min(std::min(q[0].x, q[1].x), std::min(q[2].x, q[3].x));
+        maxX[slot] = std::max(std::max(q[0].x, q[1].x), std::max(q[2].x, q[3].x));
+        minY[slot] = std::min(std::min(q[0].y, q[1].y), std::min(q[2].y, q[3].y));
+        maxY[slot] = std::max(std::max(q[0].y, q[1].y), std::max(q[2].y, q[3].y));
+        spatialHash.Update(ids[slot], minX[slot], minY[slot], maxX[slot], maxY[slot]);
+    }
+    anyChanged = false;
+}
+
+//--------------------------------------------------------------------------------
+// Collision queries
+
+bool SpriteDisplay::QuadsOverlap(int slotA, int slotB) const {
+    if (maxX[slotA] < minX[slotB] || maxX[slotB] < minX[slotA]
+        || maxY[slotA] < minY[slotB] || maxY[slotB] < minY[slotA]) return false;
+
+    // Separating axis test; each rectangle contributes two edge normals
+    const Vector2* quads[2] = { &corners[slotA * 4], &corners[slotB * 4] };
+    for (int q = 0; q < 2; q++) {
+        for (int edge = 0; edge < 2; edge++) {
+            Vector2 a = quads[q][edge], b = quads[q][edge + 1];
+            float axisX = a.y - b.y, axisY = b.x - a.x;
+            float min0 = 1e30f, max0 = -1e30f, min1 = 1e30f, max1 = -1e30f;
+            for (int i = 0; i < 4; i++) {
+                float p0 = quads[0][i].x * axisX + quads[0][i].y * axisY;
+                float p1 = quads[1][i].x * axisX + quads[1][i].y * axisY;
+                min0 = std::min(min0, p0);
+                max0 = std::max(max0, p0);
+                min1 = std::min(min1, p1);
+                max1 = std::max(max1, p1);
+            }
+            if (max0 < min1 || max1 < min0) return false;
+        }
+    }
+    return true;
+}
+
+bool SpriteDisplay::QuadContains(int slot, float px, float py) const {
+    // Inside a convex quad: on the same side of every edge
+    const Vector2* q = &corners[slot * 4];
+    bool anyPositive = false, anyNegative = false;
+    for (int i = 0; i < 4; i++) {
+        const Vector2& a = q[i];
+        const Vector2& b = q[(i + 1) & 3];
+        float cross = (b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x);
+        if (cross > 0) anyPositive = true;
+        if (cross < 0) anyNegative = true;
+    }
+    return !(anyPositive && anyNegative);
+}
+
+bool SpriteDisplay::Overlaps(int id, int otherId) {
+    int a = SlotOf(id), b = SlotOf(otherId);
+    if (a < 0 || b < 0 || a == b) return false;
+    UpdateTransforms();
+    return QuadsOverlap(a, b);
+}
+
+void SpriteDisplay::FindOverlapping(int id, std::vector<int>& out) {
+    int slot = SlotOf(id);
+    if (slot < 0) return;
+    UpdateTransforms();
+    candidates.clear();
+    spatialHash.Query(minX[slot], minY[slot], maxX[slot], maxY[slot], candidates);
+    for (int other : candidates) {
+        if (other != id && QuadsOverlap(slot, slotOfId[other])) out.push_back(other);
+    }
+}
+
+void SpriteDisplay::FindAt(float px, float py, std::vector<int>& out) {
+    UpdateTransforms();
+    candidates.clear();
+    spatialHash.QueryPoint(px, py, candidates);
+    for (int id : candidates) {
+        if (QuadContains(slotOfId[id], px, py)) out.push_back(id);
+    }
+}
+
+void SpriteDisplay::FindCollidingPairs(std::vector<std::pair<int, int>>& out) {
+    UpdateTransforms();
+    for (int slot = 0; slot < (int)ids.size(); slot++) {
+        int id = ids[slot];
+        if (id < 0) continue;
+        candidates.clear();
+        spatialHash.Query(minX[slot], minY[slot], maxX[slot], maxY[slot], candidates);
+        for (int other : candidates) {
+            // Each pair is reported once, from its lower id
+            if (other > id && QuadsOverlap(slot, slotOfId[other])) out.push_back(std::make_pair(id, other));
+        }
+    }
+}
+
+//--------------------------------------------------------------------------------
+// Draw order
+
+void SpriteDisplay::BeginOrder() {
+    order.clear();
+}
+
+void SpriteDisplay::AppendOrder(int id) {
+    order.push_back(id);
+}
+
+void SpriteDisplay::EndOrder() {
+    useOrder = true;
+}
+
+void SpriteDisplay::ResetOrder() {
+    order.clear();
+    useOrder = false;
+}
+
+//--------------------------------------------------------------------------------
+// Rendering
+
+void SpriteDisplay::Render() {
+    RenderRecorded();
+}
+
+bool SpriteDisplay::Record(RenderQueue& queue) {
+    if (!visible) return true;
+    RefreshAtlasImages();
+    CompactSlots();
+    UpdateTransforms();
+
+    // Collect the on-screen sprites, in draw order
+    Rectangle view = GetVisibleArea();
+    float viewRight = view.x + view.width, viewTop = view.y + view.height;
+    drawSlots.clear();
+    int count = useOrder ? (int)order.size() : (int)ids.size();
+    for (int i = 0; i < count; i++) {
+        int slot = useOrder ? SlotOf(order[i]) : i;
+        if (slot < 0) continue;
+        if (maxX[slot] < view.x || minX[slot] > viewRight || maxY[slot] < view.y || minY[slot] > viewTop) continue;
+        drawSlots.push_back(slot);
+    }
+
+    // Record the quads; a sortable layer lets the queue group them by
+    // texture, otherwise each change of texture starts a batch
+    queue.BeginLayer(sortByTexture);
+    const float top = kScreenBottom;
+    textureIds.clear();
+    unsigned int previousTexture = 0;
+    int batches = 0;
+    for (int slot : drawSlots) {
+        const SpriteImage& img = images[image[slot]];
+        if (!img.texture.id) continue;      // atlas page not uploaded yet
+        if (sortByTexture) {
+            textureIds.push_back(img.texture.id);
+        } else if (img.texture.id != previousTexture) {
+            batches++;
+        }
+        previousTexture = img.texture.id;
+
+        float u0 = img.source.x / img.texture.width;
+        float v0 = img.source.y / img.texture.height;
+        float u1 = (img.source.x + img.source.width) / img.texture.width;
+        float v1 = (img.source.y + img.source.height) / img.texture.height;
+        const Vector2* q = &corners[slot * 4];
+        Vector2 windowCorners[4];
+        for (int i = 0; i < 4; i++) windowCorners[i] = Vector2{ kScreenLeft + q[i].x, top - q[i].y };
+
+        RenderQueue::DrawState state = { Shader{ 0, nullptr }, img.texture.id, BLEND_ALPHA };
+        queue.AddQuad(state, windowCorners, u0, v0, u1, v1, tint[slot]);
+    }
+    if (sortByTexture) {
+        std::sort(textureIds.begin(), textureIds.end());
+        batches = (int)(std::unique(textureIds.begin(), textureIds.end()) - textureIds.begin());
+    }
+
+    lastDrawnCount = (int)drawSlots.size();
+    lastBatchCount = batches;
+    return true;
+}
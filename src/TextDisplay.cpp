@@ -1,5 +1,12 @@
 #include "TextDisplay.h"
+#include "RenderQueue.h"
 #include <algorithm>
+#include <cmath>
+
+namespace {
+    // Text starts a little below the top of the screen
+    const float kTextTop = Display::kScreenTop + 2.0f;
+}
 
 TextDisplay::TextDisplay()
     : cols(68), rows(26),
@@ -36,36 +43,58 @@ void TextDisplay::SetSize(int newCols, int newRows) {
 
 void TextDisplay::Render() {
     if (!visible) return;
+    if (screenFont.IsLoaded()) {
+        RenderRecorded();
+        return;
+    }
 
-    // Display offset from window edge
-    const float offsetX = 32.0f;
-    const float offsetY = 34.0f;
-
-    // Draw each cell (bottom-up: row 0 at bottom, row 25 at top)
+    // Fallback until the font is ready: draw background and text
     for (int row = 0; row < rows; row++) {
         for (int col = 0; col < cols; col++) {
             const Cell& cell = cells[row][col];
+            Vector2 position = GetCellPosition(row, col);
+            Color fore = cell.inverse ? cell.backColor : cell.foreColor;
+            Color back = cell.inverse ? cell.foreColor : cell.backColor;
+            DrawRectangle((int)position.x, (int)position.y, (int)colSpacing, (int)rowSpacing, back);
+            if (cell.character != ' ') {
+                char str[2] = { cell.character, '\0' };
+                DrawText(str, (int)position.x, (int)position.y, 16, fore);
+            }
+        }
+    }
+}
 
-            float x = offsetX + col * colSpacing;
-            float y = offsetY + (rows - 1 - row) * rowSpacing;
+bool TextDisplay::Record(RenderQueue& queue) {
+    if (!visible) return true;
+    if (!screenFont.IsLoaded()) return false;
+
+    // Cell positions never change; scale and scroll are applied by the
+    // layer transform, which only limits which cells are worth drawing
+    int row0 = 0, row1 = rows - 1, col0 = 0, col1 = cols - 1;
+    if (HasTransform()) {
+        Rectangle view = GetVisibleArea();
+        float firstRowBottom = kScreenBottom - (kTextTop + rows * rowSpacing);
+        row0 = std::max(row0, (int)floorf((view.y - firstRowBottom) / rowSpacing));
+        row1 = std::min(row1, (int)floorf((view.y + view.height - firstRowBottom) / rowSpacing));
+        col0 = std::max(col0, (int)floorf(view.x / colSpacing));
+        col1 = std::min(col1, (int)floorf((view.x + view.width) / colSpacing));
+    }
+
+    // Every cell uses the same state, so the layer is one batch; without the
+    // font shader, each cell's background must stay beneath its glyph
+    queue.BeginLayer(false);
+    for (int row = row0; row <= row1; row++) {
+        for (int col = col0; col <= col1; col++) {
+            const Cell& cell = cells[row][col];
+            Vector2 position = GetCellPosition(row, col);
 
             // Determine display colors (respecting inverse)
             Color fore = cell.inverse ? cell.backColor : cell.foreColor;
             Color back = cell.inverse ? cell.foreColor : cell.backColor;
-
-            // Draw character using ScreenFont
-            if (screenFont.IsLoaded()) {
-                screenFont.DrawChar(cell.character, x, y, fore, back);
-            } else {
-                // Fallback: draw background and text
-                DrawRectangle((int)x, (int)y, (int)colSpacing, (int)rowSpacing, back);
-                if (cell.character != ' ') {
-                    char str[2] = { cell.character, '\0' };
-                    DrawText(str, (int)x, (int)y, 16, fore);
-                }
-            }
+            screenFont.RecordChar(queue, cell.character, position.x, position.y, fore, back);
         }
     }
+    return true;
 }
 
 void TextDisplay::Clear() {
@@ -125,6 +154,15 @@ TextDisplay::Cell* TextDisplay::Get(int row, int col) {
     return &cells[row][col];
 }
 
+const TextDisplay::Cell* TextDisplay::Get(int row, int col) const {
+    if (row < 0 || row >= rows || col < 0 || col >= cols) return nullptr;
+    return &cells[row][col];
+}
+
+Vector2 TextDisplay::GetCellPosition(int row, int col) const {
+    return Vector2{ kScreenLeft + col * colSpacing, kTextTop + (rows - 1 - row) * rowSpacing };
+}
+
 void TextDisplay::Print(const std::string& text) {
     HideCursorVisual();
     for (char c : text) {
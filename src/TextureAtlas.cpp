@@ -0,0 +1,251 @@
+#include "TextureAtlas.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+TextureAtlas& TextureAtlas::Shared() {
+    static TextureAtlas atlas;
+    return atlas;
+}
+
+TextureAtlas::TextureAtlas() : liveCount(0), liveArea(0), generation(0) {
+}
+
+TextureAtlas::~TextureAtlas() {
+    FreePages();
+}
+
+void TextureAtlas::Clear() {
+    FreePages();
+    entries.clear();
+    freeEntries.clear();
+    liveCount = 0;
+    liveArea = 0;
+    generation++;
+}
+
+void TextureAtlas::FreePages() {
+    for (Page& page : pages) {
+        if (page.texture.id) UnloadTexture(page.texture);
+        UnloadImage(page.image);
+    }
+    pages.clear();
+}
+
+bool TextureAtlas::AddPage() {
+    if ((int)pages.size() >= kMaxPages) return false;
+    Page page;
+    page.image = GenImageColor(kPageSize, kPageSize, BLANK);
+    if (!page.image.data) return false;
+    page.texture = Texture2D{};     // created in Update
+    page.skyline.push_back(SkylineNode{ 0, 0, kPageSize });
+    page.dirtyTop = page.dirtyBottom = 0;
+    pages.push_back(page);
+    return true;
+}
+
+//--------------------------------------------------------------------------------
+// Packing
+
+bool TextureAtlas::Pack(Page& page, int width, int height, int& outX, int& outY) {
+    std::vector<SkylineNode>& sky = page.skyline;
+
+    // Bottom-left rule: lowest resulting top edge, then the narrowest node
+    int bestIndex = -1, bestY = INT_MAX, bestWidth = INT_MAX;
+    for (int i = 0; i < (int)sky.size(); i++) {
+        if (sky[i].x + width > kPageSize) break;
+        int y = 0;
+        bool fits = true;
+        for (int j = i, remaining = width; remaining > 0; j++) {
+            y = std::max(y, sky[j].y);
+            if (y + height > kPageSize) {
+                fits = false;
+                break;
+            }
+            remaining -= sky[j].width;
+        }
+        if (fits && (y < bestY || (y == bestY && sky[i].width < bestWidth))) {
+            bestIndex = i;
+            bestY = y;
+            bestWidth = sky[i].width;
+        }
+    }
+    if (bestIndex < 0) return false;
+
+    outX = sky[bestIndex].x;
+    outY = bestY;
+
+    // Raise the skyline over the new rectangle, trimming the nodes it covers
+    sky.insert(sky.begin() + bestIndex, SkylineNode{ outX, bestY + height, width });
+    for (int i = bestIndex + 1; i < (int)sky.size(); ) {
+        int coveredTo = sky[i - 1].x + sky[i - 1].width;
+        if (sky[i].x >= coveredTo) break;
+        int shrink = coveredTo - sky[i].x;
+        sky[i].x += shrink;
+        sky[i].width -= shrink;
+        if (sky[i].width > 0) break;
+        sky.erase(sky.begin() + i);
+    }
+    for (int i = 0; i + 1 < (int)sky.size(); ) {
+        if (sky[i].y == sky[i + 1].y) {
+            sky[i].width += sky[i + 1].width;
+            sky.erase(sky.begin() + i + 1);
+        } else {
+            i++;
+        }
+    }
+    return true;
+}
+
+void TextureAtlas::Blit(Page& page, const unsigned char* pixels, int stride, int x, int y, int width, int height) {
+    unsigned char* dest = (unsigned char*)page.image.data;
+    for (int row = 0; row < height; row++) {
+        memcpy(dest + ((size_t)(y + row) * kPageSize + x) * 4, pixels + (size_t)row * stride, (size_t)width * 4);
+    }
+    if (page.dirtyTop >= page.dirtyBottom) {
+        page.dirtyTop = y;
+        page.dirtyBottom = y + height;
+    } else {
+        page.dirtyTop = std::min(page.dirtyTop, y);
+        page.dirtyBottom = std::max(page.dirtyBottom, y + height);
+    }
+}
+
+bool TextureAtlas::Place(int index, const unsigned char* pixels, int stride) {
+    Entry& entry = entries[index];
+    for (int p = 0; ; p++) {
+        if (p == (int)pages.size() && !AddPage()) return false;
+        int x, y;
+        if (Pack(pages[p], entry.width + kPadding, entry.height + kPadding, x, y)) {
+            entry.page = p;
+            entry.x = x;
+            entry.y = y;
+            Blit(pages[p], pixels, stride, x, y, entry.width, entry.height);
+            return true;
+        }
+    }
+}
+
+int TextureAtlas::Add(const Image& image) {
+    if (!image.data || image.width <= 0 || image.height <= 0) return -1;
+    if (image.width + kPadding > kPageSize || image.height + kPadding > kPageSize) return -1;
+
+    Image rgba = image;
+    bool converted = (image.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    if (converted) {
+        rgba = ImageCopy(image);
+        ImageFormat(&rgba, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    }
+
+    int index;
+    if (!freeEntries.empty()) {
+        index = freeEntries.back();
+        freeEntries.pop_back();
+    } else {
+        index = (int)entries.size();
+        entries.push_back(Entry());
+    }
+    entries[index] = Entry{ false, -1, 0, 0, image.width, image.height };
+
+    const unsigned char* pixels = (const unsigned char*)rgba.data;
+    bool placed = Place(index, pixels, image.width * 4);
+    if (!placed && liveCount > 0 && liveArea * 2 < (long)pages.size() * kPageSize * kPageSize) {
+        // Full but sparse: defragment, then try again
+        if (Repack()) placed = Place(index, pixels, image.width * 4);
+    }
+    if (converted) UnloadImage(rgba);
+
+    if (!placed) {
+        freeEntries.push_back(index);
+        return -1;
+    }
+    entries[index].live = true;
+    liveCount++;
+    liveArea += (long)image.width * image.height;
+    return index;
+}
+
+void TextureAtlas::Remove(int region) {
+    if (!IsRegion(region)) return;
+    Entry& entry = entries[region];
+    entry.live = false;
+    liveCount--;
+    liveArea -= (long)entry.width * entry.height;
+    freeEntries.push_back(region);
+    // The space is reclaimed by the next Repack
+}
+
+bool TextureAtlas::IsRegion(int region) const {
+    return region >= 0 && region < (int)entries.size() && entries[region].live;
+}
+
+TextureAtlas::Region TextureAtlas::GetRegion(int region) const {
+    if (!IsRegion(region)) return Region{ Texture2D{}, Rectangle{ 0, 0, 0, 0 }, -1 };
+    const Entry& entry = entries[region];
+    return Region{ pages[entry.page].texture,
+                   Rectangle{ (float)entry.x, (float)entry.y, (float)entry.width, (float)entry.height },
+                   entry.page };
+}
+
+bool TextureAtlas::Repack() {
+    // Pack live regions tallest first into fresh pages, copying from the old
+    // ones; the old pages and positions are kept until every region fits
+    std::vector<Page> oldPages;
+    oldPages.swap(pages);
+    std::vector<Entry> oldEntries = entries;
+
+    std::vector<int> order;
+    for (int i = 0; i < (int)entries.size(); i++) {
+        if (entries[i].live) order.push_back(i);
+    }
+    std::sort(order.begin(), order.end(), [this](int a, int b) {
+        return entries[a].height > entries[b].height;
+    });
+
+    for (int index : order) {
+        Entry& entry = entries[index];
+        const Page& old = oldPages[entry.page];
+        const unsigned char* pixels = (const unsigned char*)old.image.data + ((size_t)entry.y * kPageSize + entry.x) * 4;
+        if (!Place(index, pixels, kPageSize * 4)) {
+            TraceLog(LOG_WARNING, "TextureAtlas: regions don't fit after repacking; layout kept");
+            FreePages();
+            pages.swap(oldPages);
+            entries.swap(oldEntries);
+            return false;
+        }
+    }
+
+    for (Page& page : oldPages) {
+        if (page.texture.id) UnloadTexture(page.texture);
+        UnloadImage(page.image);
+    }
+    generation++;
+    return true;
+}
+
+//--------------------------------------------------------------------------------
+// Upload
+
+void TextureAtlas::Update() {
+    for (Page& page : pages) {
+        if (!page.texture.id) {
+            page.texture = LoadTextureFromImage(page.image);
+            page.dirtyTop = page.dirtyBottom = 0;
+            generation++;
+            continue;
+        }
+        if (page.dirtyTop >= page.dirtyBottom) continue;
+
+        // Full-width rows are contiguous, so no staging copy is needed
+        const unsigned char* rows = (const unsigned char*)page.image.data + (size_t)page.dirtyTop * kPageSize * 4;
+        UpdateTextureRec(page.texture,
+                         Rectangle{ 0, (float)page.dirtyTop, (float)kPageSize, (float)(page.dirtyBottom - page.dirtyTop) },
+                         rows);
+        page.dirtyTop = page.dirtyBottom = 0;
+    }
+}
+
+float TextureAtlas::GetOccupancy() const {
+    if (pages.empty()) return 0;
+    return (float)((double)liveArea / ((double)pages.size() * kPageSize * kPageSize));
+}
@@ -0,0 +1,52 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int threadCount) : busyCount(0), quitting(false) {
+    if (threadCount <= 0) {
+        threadCount = (int)std::thread::hardware_concurrency() - 1;
+        if (threadCount < 1) threadCount = 1;
+    }
+    for (int i = 0; i < threadCount; i++) {
+        workers.push_back(std::thread(&ThreadPool::WorkerLoop, this));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quitting = true;
+    }
+    jobAvailable.notify_all();
+    for (std::thread& worker : workers) worker.join();
+}
+
+void ThreadPool::Submit(Job job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+    }
+    jobAvailable.notify_one();
+}
+
+void ThreadPool::WaitIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return jobs.empty() && busyCount == 0; });
+}
+
+void ThreadPool::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        jobAvailable.wait(lock, [this] { return quitting || !jobs.empty(); });
+        if (jobs.empty()) return;   // quitting, and nothing left to do
+
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        busyCount++;
+        lock.unlock();
+
+        job();
+
+        lock.lock();
+        busyCount--;
+        if (jobs.empty() && busyCount == 0) idle.notify_all();
+    }
+}
@@ -0,0 +1,371 @@
+#include "TileDisplay.h"
+#include "TextureAtlas.h"
+#include "rlgl.h"
+#include <cmath>
+#include <cstring>
+
+namespace {
+    const int kTilesPerChunk = TileDisplay::kChunkSize * TileDisplay::kChunkSize;
+
+    Matrix Translation(float x, float y) {
+        Matrix m = { 1, 0, 0, x,
+                     0, 1, 0, y,
+                     0, 0, 1, 0,
+                     0, 0, 0, 1 };
+        return m;
+    }
+}
+
+TileDisplay::TileDisplay()
+    : columns(0), rows(0), chunkColumns(0), chunkRows(0), cellWidth(64), cellHeight(64),
+      loadedChunks(0), frameCounter(0), tileSet(Texture2D{}), tileSetSource(Rectangle{ 0, 0, 0, 0 }),
+      atlas(nullptr), atlasRegion(-1), atlasGeneration(0), tileWidth(64), tileHeight(64),
+      material(Material{}), materialLoaded(false), animationTime(0),
+      lastDrawnChunks(0), lastRebuiltChunks(0) {
+    scratchVertices.resize(kTilesPerChunk * 4 * 3);
+    scratchTexcoords.resize(kTilesPerChunk * 4 * 2);
+    scratchColors.resize(kTilesPerChunk * 4 * 4);
+
+    // Every chunk uses the same two triangles per quad
+    scratchIndices.resize(kTilesPerChunk * 6);
+    for (int q = 0; q < kTilesPerChunk; q++) {
+        unsigned short v = (unsigned short)(q * 4);
+        unsigned short* idx = &scratchIndices[q * 6];
+        idx[0] = v;
+        idx[1] = v + 1;
+        idx[2] = v + 2;
+        idx[3] = v;
+        idx[4] = v + 2;
+        idx[5] = v + 3;
+    }
+
+    SetExtent(10, 10);
+}
+
+TileDisplay::~TileDisplay() {
+    for (Chunk& chunk : chunks) UnloadChunk(chunk);
+    if (materialLoaded) {
+        // The tile set isn't ours; keep UnloadMaterial from unloading it
+        material.maps[MATERIAL_MAP_DIFFUSE].texture.id = rlGetTextureIdDefault();
+        UnloadMaterial(material);
+    }
+}
+
+//--------------------------------------------------------------------------------
+// Map setup
+
+void TileDisplay::SetExtent(int columns, int rows) {
+    for (Chunk& chunk : chunks) UnloadChunk(chunk);
+    this->columns = columns > 0 ? columns : 1;
+    this->rows = rows > 0 ? rows : 1;
+    chunkColumns = (this->columns + kChunkSize - 1) / kChunkSize;
+    chunkRows = (this->rows + kChunkSize - 1) / kChunkSize;
+    tiles.assign((size_t)this->columns * this->rows, -1);
+    tints.assign((size_t)this->columns * this->rows, WHITE);
+    Chunk empty;
+    memset(&empty, 0, sizeof(empty));
+    chunks.assign((size_t)chunkColumns * chunkRows, empty);
+}
+
+void TileDisplay::SetCellSize(float width, float height) {
+    cellWidth = width;
+    cellHeight = height;
+    MarkAllChunksDirty();
+}
+
+void TileDisplay::SetTileSet(Texture2D texture, int tileWidth, int tileHeight) {
+    tileSet = texture;
+    tileSetSource = Rectangle{ 0, 0, (float)texture.width, (float)texture.height };
+    atlas = nullptr;
+    atlasRegion = -1;
+    this->tileWidth = tileWidth > 0 ? tileWidth : 1;
+    this->tileHeight = tileHeight > 0 ? tileHeight : 1;
+    MarkAllChunksDirty();
+}
+
+void TileDisplay::SetTileSet(const TextureAtlas* atlas, int region, int tileWidth, int tileHeight) {
+    this->atlas = atlas;
+    atlasRegion = region;
+    atlasGeneration = atlas ? atlas->GetGeneration() - 1 : 0;     // forces a refresh
+    this->tileWidth = tileWidth > 0 ? tileWidth : 1;
+    this->tileHeight = tileHeight > 0 ? tileHeight : 1;
+    RefreshTileSet();
+}
+
+void TileDisplay::SetTileSet(const ResourceManager::TextureResource* resource, int tileWidth, int tileHeight) {
+    if (!resource || !resource->IsReady()) return;
+    if (resource->atlasRegion >= 0) SetTileSet(&TextureAtlas::Shared(), resource->atlasRegion, tileWidth, tileHeight);
+    else SetTileSet(resource->texture, tileWidth, tileHeight);
+}
+
+void TileDisplay::RefreshTileSet() {
+    if (!atlas || atlas->GetGeneration() == atlasGeneration) return;
+    TextureAtlas::Region r = atlas->GetRegion(atlasRegion);
+    tileSet = r.texture;
+    tileSetSource = r.source;
+    atlasGeneration = atlas->GetGeneration();
+    MarkAllChunksDirty();
+}
+
+//--------------------------------------------------------------------------------
+// Cells
+
+void TileDisplay::Clear() {
+    for (int& tile : tiles) tile = -1;
+    for (Color& tint : tints) tint = WHITE;
+    MarkAllChunksDirty();
+}
+
+int TileDisplay::GetCell(int column, int row) const {
+    if (column < 0 || row < 0 || column >= columns || row >= rows) return -1;
+    return tiles[(size_t)row * columns + column];
+}
+
+void TileDisplay::SetCell(int column, int row, int tile) {
+    if (column < 0 || row < 0 || column >= columns || row >= rows) return;
+    int& cell = tiles[(size_t)row * columns + column];
+    if (cell == tile) return;
+    cell = tile;
+    MarkChunkDirty(column, row);
+}
+
+void TileDisplay::SetCellTint(int column, int row, Color tint) {
+    if (column < 0 || row < 0 || column >= columns || row >= rows) return;
+    tints[(size_t)row * columns + column] = tint;
+    MarkChunkDirty(column, row);
+}
+
+void TileDisplay::FillCells(int column, int row, int width, int height, int tile) {
+    int c0 = column < 0 ? 0 : column;
+    int r0 = row < 0 ? 0 : row;
+    int c1 = column + width > columns ? columns : column + width;
+    int r1 = row + height > rows ? rows : row + height;
+    if (c0 >= c1 || r0 >= r1) return;
+    for (int r = r0; r < r1; r++) {
+        for (int c = c0; c < c1; c++) tiles[(size_t)r * columns + c] = tile;
+    }
+    for (int cr = r0 / kChunkSize; cr <= (r1 - 1) / kChunkSize; cr++) {
+        for (int cc = c0 / kChunkSize; cc <= (c1 - 1) / kChunkSize; cc++) {
+            chunks[cr * chunkColumns + cc].dirty = true;
+        }
+    }
+}
+
+void TileDisplay::MarkChunkDirty(int column, int row) {
+    chunks[ChunkIndex(column, row)].dirty = true;
+}
+
+void TileDisplay::MarkAllChunksDirty() {
+    for (Chunk& chunk : chunks) chunk.dirty = true;
+}
+
+//--------------------------------------------------------------------------------
+// Animation
+
+void TileDisplay::SetTileAnimation(int tile, const int* frames, int frameCount, float frameTime) {
+    if (tile < 0 || frameCount <= 0) return;
+    if (frameCount > kMaxAnimationFrames) frameCount = kMaxAnimationFrames;
+    if (tile >= (int)animationOfTile.size()) animationOfTile.resize(tile + 1, -1);
+    if (animationOfTile[tile] < 0) {
+        animationOfTile[tile] = (int)animations.size();
+        animations.push_back(Animation());
+    }
+    Animation& anim = animations[animationOfTile[tile]];
+    anim.tile = tile;
+    memcpy(anim.frames, frames, frameCount * sizeof(int));
+    anim.frameCount = frameCount;
+    anim.frameTime = frameTime > 0 ? frameTime : 0.1f;
+    anim.currentFrame = 0;
+    MarkAllChunksDirty();       // recounts which chunks hold animated cells
+}
+
+void TileDisplay::ClearTileAnimations() {
+    animations.clear();
+    animationOfTile.clear();
+    MarkAllChunksDirty();
+}
+
+int TileDisplay::DisplayedTile(int tile) const {
+    if (tile < (int)animationOfTile.size() && animationOfTile[tile] >= 0) {
+        const Animation& anim = animations[animationOfTile[tile]];
+        return anim.frames[anim.currentFrame];
+    }
+    return tile;
+}
+
+void TileDisplay::Update(float deltaTime) {
+    if (animations.empty()) return;
+    animationTime += deltaTime;
+    bool advanced = false;
+    for (Animation& anim : animations) {
+        int frame = (int)(animationTime / anim.frameTime) % anim.frameCount;
+        if (frame != anim.currentFrame) {
+            anim.currentFrame = frame;
+            advanced = true;
+        }
+    }
+    if (!advanced) return;
+
+    // Only chunks showing an animated tile need new texture coordinates
+    for (Chunk& chunk : chunks) {
+        if (chunk.loaded && chunk.animatedCells > 0) chunk.dirty = true;
+    }
+}
+
+//--------------------------------------------------------------------------------
+// Chunk meshes
+
+void TileDisplay::BuildChunk(int index) {
+    Chunk& chunk = chunks[index];
+    int column0 = (index % chunkColumns) * kChunkSize;
+    int row0 = (index / chunkColumns) * kChunkSize;
+    int tilesPerRow = (int)(tileSetSource.width / tileWidth);
+    int tileCount = tilesPerRow * (int)(tileSetSource.height / tileHeight);
+    float texWidth = tileSet.width > 0 ? (float)tileSet.width : 1.0f;
+    float texHeight = tileSet.height > 0 ? (float)tileSet.height : 1.0f;
+
+    float* vertices = scratchVertices.data();
+    float* texcoords = scratchTexcoords.data();
+    unsigned char* colors = scratchColors.data();
+    memset(vertices, 0, scratchVertices.size() * sizeof(float));   // empty cells are degenerate quads
+    chunk.animatedCells = 0;
+
+    for (int localRow = 0; localRow < kChunkSize; localRow++) {
+        int row = row0 + localRow;
+        if (row >= rows) break;
+        for (int localColumn = 0; localColumn < kChunkSize; localColumn++) {
+            int column = column0 + localColumn;
+            if (column >= columns) break;
+            int tile = tiles[(size_t)row * columns + column];
+            if (tile < 0) continue;
+            if (tile < (int)animationOfTile.size() && animationOfTile[tile] >= 0) chunk.animatedCells++;
+            int shown = DisplayedTile(tile);
+            if (shown < 0 || shown >= tileCount) continue;
+
+            // Chunk-local pixels, y down from the chunk's top edge
+            int q = localRow * kChunkSize + localColumn;
+            float x0 = localColumn * cellWidth;
+            float y0 = (kChunkSize - 1 - localRow) * cellHeight;
+            float x1 = x0 + cellWidth, y1 = y0 + cellHeight;
+            float* v = vertices + q * 12;
+            v[0] = x0; v[1] = y0;       // top-left
+            v[3] = x0; v[4] = y1;       // bottom-left
+            v[6] = x1; v[7] = y1;       // bottom-right
+            v[9] = x1; v[10] = y0;      // top-right
+
+            float u0 = (tileSetSource.x + (shown % tilesPerRow) * tileWidth) / texWidth;
+            float v0 = (tileSetSource.y + (shown / tilesPerRow) * tileHeight) / texHeight;
+            float u1 = u0 + tileWidth / texWidth;
+            float v1 = v0 + tileHeight / texHeight;
+            float* t = texcoords + q * 8;
+            t[0] = u0; t[1] = v0;
+            t[2] = u0; t[3] = v1;
+            t[4] = u1; t[5] = v1;
+            t[6] = u1; t[7] = v0;
+
+            Color tint = tints[(size_t)row * columns + column];
+            unsigned char* c = colors + q * 16;
+            for (int i = 0; i < 4; i++) memcpy(c + i * 4, &tint, 4);
+        }
+    }
+
+    if (!chunk.loaded) {
+        Mesh mesh;
+        memset(&mesh, 0, sizeof(mesh));
+        mesh.vertexCount = kTilesPerChunk * 4;
+        mesh.triangleCount = kTilesPerChunk * 2;
+        mesh.vertices = vertices;
+        mesh.texcoords = texcoords;
+        mesh.colors = colors;
+        mesh.indices = scratchIndices.data();
+        UploadMesh(&mesh, true);
+
+        // Keep only GPU buffers; indices stay set since DrawMesh checks them
+        mesh.vertices = nullptr;
+        mesh.texcoords = nullptr;
+        mesh.colors = nullptr;
+        chunk.mesh = mesh;
+        chunk.loaded = true;
+        loadedChunks++;
+    } else {
+        UpdateMeshBuffer(chunk.mesh, 0, vertices, (int)(scratchVertices.size() * sizeof(float)), 0);
+        UpdateMeshBuffer(chunk.mesh, 1, texcoords, (int)(scratchTexcoords.size() * sizeof(float)), 0);
+        UpdateMeshBuffer(chunk.mesh, 3, colors, (int)scratchColors.size(), 0);
+    }
+    chunk.dirty = false;
+}
+
+void TileDisplay::UnloadChunk(Chunk& chunk) {
+    if (!chunk.loaded) return;
+    chunk.mesh.indices = nullptr;   // shared; UnloadMesh must not free it
+    UnloadMesh(chunk.mesh);
+    memset(&chunk.mesh, 0, sizeof(chunk.mesh));
+    chunk.loaded = false;
+    chunk.dirty = true;
+    loadedChunks--;
+}
+
+void TileDisplay::EvictChunks() {
+    while (loadedChunks > kMaxCachedChunks) {
+        Chunk* oldest = nullptr;
+        for (Chunk& chunk : chunks) {
+            if (chunk.loaded && chunk.lastUsed != frameCounter && (!oldest || chunk.lastUsed < oldest->lastUsed)) {
+                oldest = &chunk;
+            }
+        }
+        if (!oldest) break;     // everything cached is on screen
+        UnloadChunk(*oldest);
+    }
+}
+
+//--------------------------------------------------------------------------------
+// Rendering
+
+void TileDisplay::Render() {
+    lastDrawnChunks = 0;
+    lastRebuiltChunks = 0;
+    if (!visible) return;
+    RefreshTileSet();
+    if (!tileSet.id) return;
+
+    if (!materialLoaded) {
+        material = LoadMaterialDefault();
+        materialLoaded = true;
+    }
+    material.maps[MATERIAL_MAP_DIFFUSE].texture = tileSet;
+    frameCounter++;
+
+    // Meshes draw immediately, so flush what lower layers have batched
+    rlDrawRenderBatchActive();
+
+    // Chunks intersecting the view (map pixels, y up from the map's bottom)
+    Rectangle view = GetVisibleArea();
+    float chunkWidth = kChunkSize * cellWidth;
+    float chunkHeight = kChunkSize * cellHeight;
+    int cc0 = (int)floorf(view.x / chunkWidth);
+    int cc1 = (int)floorf((view.x + view.width) / chunkWidth);
+    int cr0 = (int)floorf(view.y / chunkHeight);
+    int cr1 = (int)floorf((view.y + view.height) / chunkHeight);
+    if (cc0 < 0) cc0 = 0;
+    if (cr0 < 0) cr0 = 0;
+    if (cc1 >= chunkColumns) cc1 = chunkColumns - 1;
+    if (cr1 >= chunkRows) cr1 = chunkRows - 1;
+
+    for (int cr = cr0; cr <= cr1; cr++) {
+        for (int cc = cc0; cc <= cc1; cc++) {
+            int index = cr * chunkColumns + cc;
+            Chunk& chunk = chunks[index];
+            if (chunk.dirty || !chunk.loaded) {
+                BuildChunk(index);
+                lastRebuiltChunks++;
+            }
+            chunk.lastUsed = frameCounter;
+
+            float left = kScreenLeft + cc * chunkWidth;
+            float top = kScreenBottom - (cr + 1) * chunkHeight;
+            DrawMesh(chunk.mesh, material, Translation(left, top));
+            lastDrawnChunks++;
+        }
+    }
+    EvictChunks();
+}
@@ -0,0 +1,112 @@
+#include "VideoDisplay.h"
+#include "MusicStream.h"
+#include <cmath>
+
+VideoDisplay::VideoDisplay()
+    : audio(nullptr), playing(false), ended(false), time(0), dueSequence(0),
+      front(0), texturesLoaded(false), uploadedSequence(-1), droppedFrames(0) {
+    textures[0] = textures[1] = Texture2D{};
+}
+
+VideoDisplay::~VideoDisplay() {
+    Close();
+}
+
+bool VideoDisplay::Open(const char* path) {
+    Close();
+    return stream.Open(path);
+}
+
+void VideoDisplay::Close() {
+    stream.Close();
+    UnloadTextures();
+    playing = false;
+    ended = false;
+    time = 0;
+    dueSequence = 0;        // show the first frame as soon as it's decoded
+    uploadedSequence = -1;
+    droppedFrames = 0;
+}
+
+void VideoDisplay::Clear() {
+    Close();
+}
+
+void VideoDisplay::UnloadTextures() {
+    if (!texturesLoaded) return;
+    UnloadTexture(textures[0]);
+    UnloadTexture(textures[1]);
+    textures[0] = textures[1] = Texture2D{};
+    texturesLoaded = false;
+}
+
+void VideoDisplay::Update(float deltaTime) {
+    if (!stream.IsOpen() || !playing) return;
+    if (audio) {
+        // The audio position gives a frame index within the file, and the
+        // audio may loop (or be sought) independently of the video, so the
+        // index is placed relative to the queued frame rather than counted
+        // from Open; a due index far behind it means the audio wrapped
+        time = audio->GetPosition();
+        int frameCount = stream.GetFrameCount();
+        int dueIndex = (int)floor(time * stream.GetFrameRate());
+        if (frameCount > 0 && dueIndex >= frameCount) dueIndex = frameCount - 1;
+        const VideoStream::Frame* current = stream.PeekFrame();
+        if (current) {
+            int ahead = dueIndex - current->index;
+            if (ahead < -frameCount / 2) ahead += frameCount;
+            else if (ahead > frameCount / 2) ahead -= frameCount;
+            dueSequence = current->sequence + ahead;
+        } else if (uploadedSequence < 0) {
+            dueSequence = dueIndex;
+        }
+    } else {
+        time += deltaTime;
+        dueSequence = (int64_t)floor(time * stream.GetFrameRate());
+    }
+
+    // Skip past frames that a later due frame replaces; never waits, so a
+    // slow decoder shows as held frames rather than a stalled main loop
+    for (;;) {
+        const VideoStream::Frame* next = stream.PeekFrame(1);
+        if (!next || next->sequence > dueSequence) break;
+        if (stream.PeekFrame()->sequence != uploadedSequence) droppedFrames++;
+        stream.PopFrame();
+    }
+
+    const VideoStream::Frame* current = stream.PeekFrame();
+    ended = stream.IsDecoderDone() && !stream.PeekFrame(1) && (!current || current->sequence < dueSequence);
+}
+
+void VideoDisplay::Render() {
+    if (!visible || !stream.IsOpen()) return;
+    int width = stream.GetWidth();
+    int height = stream.GetHeight();
+
+    if (!texturesLoaded) {
+        Image blank = GenImageColor(width, height, BLANK);
+        for (int i = 0; i < 2; i++) {
+            textures[i] = LoadTextureFromImage(blank);
+            SetTextureFilter(textures[i], TEXTURE_FILTER_BILINEAR);
+        }
+        UnloadImage(blank);
+        texturesLoaded = true;
+    }
+
+    // Upload a newly due frame into the texture not drawn last frame
+    const VideoStream::Frame* frame = stream.PeekFrame();
+    if (frame && frame->sequence <= dueSequence && frame->sequence != uploadedSequence) {
+        int back = 1 - front;
+        UpdateTexture(textures[back], frame->pixels.data());
+        front = back;
+        uploadedSequence = frame->sequence;
+    }
+    if (uploadedSequence < 0) return;
+
+    // Fit to the screen, keeping the aspect ratio
+    float scale = fminf((float)kScreenWidth / width, (float)kScreenHeight / height);
+    Rectangle source = { 0, 0, (float)width, (float)height };
+    Rectangle dest = { kScreenLeft + (kScreenWidth - width * scale) / 2, kScreenTop + (kScreenHeight - height * scale) / 2,
+                       width * scale, height * scale };
+    DrawTexturePro(textures[front], source, dest, Vector2{ 0, 0 }, 0.0f, WHITE);
+}
@@ -0,0 +1,171 @@
+#include "VideoStream.h"
+#include "Qoi.h"
+#include "raylib.h"
+#include <chrono>
+#include <cstring>
+
+namespace {
+    const int kHeaderSize = 28;
+    const uint32_t kVersion = 1;
+    const uint32_t kMaxDimension = 4096;
+    const uint32_t kMaxFrameBytes = 64 * 1024 * 1024;
+
+    uint32_t ReadU32(const unsigned char* p) {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    void Wait() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+}
+
+VideoStream::VideoStream()
+    : file(nullptr), quit(false), width(0), height(0), frameRate(0), frameCount(0),
+      firstFrameOffset(0), nextIndex(0), nextSequence(0), head(0), tail(0),
+      looping(false), finished(false), decodedFrames(0), decodeMicros(0) {
+}
+
+VideoStream::~VideoStream() {
+    Close();
+}
+
+bool VideoStream::Open(const char* path) {
+    Close();
+    file = fopen(path, "rb");
+    if (!file) {
+        TraceLog(LOG_WARNING, "VideoStream: could not open %s", path);
+        return false;
+    }
+    if (!ParseHeader()) {
+        TraceLog(LOG_WARNING, "VideoStream: %s is not a supported video file", path);
+        fclose(file);
+        file = nullptr;
+        return false;
+    }
+
+    // Every slot is sized once; decoding never allocates after this
+    for (Frame& slot : slots) slot.pixels.resize((size_t)width * height * 4);
+    head = 0;
+    tail = 0;
+    quit = false;
+    finished = false;
+    decodedFrames = 0;
+    decodeMicros = 0;
+    nextSequence = 0;
+    Rewind();
+    decoder = std::thread(&VideoStream::DecoderLoop, this);
+    return true;
+}
+
+void VideoStream::Close() {
+    if (decoder.joinable()) {
+        quit = true;
+        decoder.join();
+    }
+    if (file) fclose(file);
+    file = nullptr;
+    width = height = frameCount = 0;
+    frameRate = 0;
+}
+
+bool VideoStream::ParseHeader() {
+    unsigned char header[kHeaderSize];
+    if (fread(header, 1, kHeaderSize, file) != (size_t)kHeaderSize) return false;
+    if (memcmp(header, "QOIV", 4) != 0 || ReadU32(header + 4) != kVersion) return false;
+    uint32_t w = ReadU32(header + 8);
+    uint32_t h = ReadU32(header + 12);
+    uint32_t fpsNum = ReadU32(header + 16);
+    uint32_t fpsDen = ReadU32(header + 20);
+    uint32_t count = ReadU32(header + 24);
+    if (w == 0 || h == 0 || w > kMaxDimension || h > kMaxDimension) return false;
+    if (fpsNum == 0 || fpsDen == 0 || count == 0 || count > 0x7FFFFFFF) return false;
+    width = (int)w;
+    height = (int)h;
+    frameRate = (double)fpsNum / fpsDen;
+    frameCount = (int)count;
+    firstFrameOffset = kHeaderSize;
+    return true;
+}
+
+void VideoStream::Rewind() {
+    fseek(file, firstFrameOffset, SEEK_SET);
+    nextIndex = 0;
+}
+
+//--------------------------------------------------------------------------------
+// Decoder thread
+
+bool VideoStream::DecodeNext(Frame& frame) {
+    if (nextIndex >= frameCount) return false;
+    unsigned char sizeBytes[4];
+    if (fread(sizeBytes, 1, 4, file) != 4) return false;
+    uint32_t size = ReadU32(sizeBytes);
+    if (size == 0 || size > kMaxFrameBytes) return false;
+    if (compressed.size() < size) compressed.resize(size);
+    if (fread(compressed.data(), 1, size, file) != size) return false;
+
+    auto start = std::chrono::steady_clock::now();
+    if (!Qoi::Decode(compressed.data(), size, frame.pixels.data(), width, height)) return false;
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    decodeMicros += std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    decodedFrames++;
+
+    frame.index = nextIndex++;
+    frame.sequence = nextSequence++;
+    return true;
+}
+
+void VideoStream::DecoderLoop() {
+    while (!quit) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (finished || h - tail.load(std::memory_order_acquire) >= (size_t)kRingSlots) {
+            Wait();
+            continue;
+        }
+
+        if (nextIndex >= frameCount && looping) Rewind();
+        if (!DecodeNext(slots[h % kRingSlots])) {
+            if (nextIndex < frameCount) {
+                TraceLog(LOG_WARNING, "VideoStream: bad or truncated frame %d", nextIndex);
+            }
+            finished = true;
+            continue;
+        }
+        head.store(h + 1, std::memory_order_release);
+    }
+}
+
+//--------------------------------------------------------------------------------
+// Consumer side
+
+const VideoStream::Frame* VideoStream::PeekFrame(int ahead) const {
+    if (ahead < 0) return nullptr;
+    size_t t = tail.load(std::memory_order_relaxed);
+    size_t available = head.load(std::memory_order_acquire) - t;
+    if ((size_t)ahead >= available) return nullptr;
+    return &slots[(t + ahead) % kRingSlots];
+}
+
+void VideoStream::PopFrame() {
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire)) return;
+    tail.store(t + 1, std::memory_order_release);
+}
+
+bool VideoStream::IsFinished() const {
+    return finished && tail.load(std::memory_order_acquire) == head.load(std::memory_order_acquire);
+}
+
+double VideoStream::GetAverageDecodeMs() const {
+    int64_t count = decodedFrames;
+    return count > 0 ? decodeMicros / 1000.0 / count : 0;
+}
+
+uint64_t VideoStream::HashFrame(const Frame& frame) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char byte : frame.pixels) {
+        hash ^= byte;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
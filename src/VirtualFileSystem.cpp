@@ -0,0 +1,72 @@
+#include "VirtualFileSystem.h"
+
+namespace {
+    // "/usr/" -> "usr"
+    std::string MountName(const char* mountPoint) {
+        std::string name = mountPoint;
+        while (!name.empty() && name[0] == '/') name.erase(0, 1);
+        while (!name.empty() && name.back() == '/') name.pop_back();
+        return name;
+    }
+}
+
+VirtualFileSystem::VirtualFileSystem() {
+}
+
+VirtualFileSystem::~VirtualFileSystem() {
+    EjectAll();
+}
+
+bool VirtualFileSystem::Mount(const char* mountPoint, const char* diskPath, bool writable) {
+    MiniDisk* disk = new MiniDisk();
+    if (!disk->Mount(diskPath, writable) || !Eject(mountPoint)) {
+        delete disk;
+        return false;
+    }
+    MountPoint mount;
+    mount.name = MountName(mountPoint);
+    mount.disk = disk;
+    mounts.push_back(mount);
+    return true;
+}
+
+bool VirtualFileSystem::Eject(const char* mountPoint) {
+    std::string name = MountName(mountPoint);
+    for (size_t i = 0; i < mounts.size(); i++) {
+        if (mounts[i].name != name) continue;
+        if (!mounts[i].disk->Eject()) return false;     // changes not written; keep it
+        delete mounts[i].disk;
+        mounts.erase(mounts.begin() + i);
+        return true;
+    }
+    return true;
+}
+
+void VirtualFileSystem::EjectAll() {
+    // Shutting down: a disk whose changes can't be written loses them
+    for (MountPoint& mount : mounts) delete mount.disk;
+    mounts.clear();
+}
+
+MiniDisk* VirtualFileSystem::Resolve(const std::string& path, std::string& outDiskPath) {
+    // Split "/usr/a/b" into "usr" and "a/b", ignoring repeated slashes
+    size_t start = path.find_first_not_of('/');
+    if (start == std::string::npos) return nullptr;
+    size_t slash = path.find('/', start);
+    size_t nameLength = (slash == std::string::npos ? path.size() : slash) - start;
+    for (MountPoint& mount : mounts) {
+        if (mount.name.size() != nameLength || path.compare(start, nameLength, mount.name) != 0) continue;
+        outDiskPath.clear();
+        if (slash != std::string::npos) {
+            size_t rest = path.find_first_not_of('/', slash);
+            if (rest != std::string::npos) outDiskPath = path.substr(rest);
+            while (!outDiskPath.empty() && outDiskPath.back() == '/') outDiskPath.pop_back();
+        }
+        return mount.disk;
+    }
+    return nullptr;
+}
+
+void VirtualFileSystem::Update(float deltaTime) {
+    for (MountPoint& mount : mounts) mount.disk->Update(deltaTime);
+}
@@ -1,48 +1,257 @@
 #include "raylib.h"
 #include "ResourcePath.h"
+#include "ResourceManager.h"
+#include "ImageCache.h"
+#include "AudioMixer.h"
+#include "Benchmarks.h"
+#include <vector>
+#include <cstdio>
+#include <cstring>
 #include "Machine.h"
 #include "SolidColorDisplay.h"
+#include "GradientDisplay.h"
 #include "TextDisplay.h"
+#include "PixelDisplay.h"
+#include "TextureAtlas.h"
 #include "ScreenFont.h"
+#include "ScreenPresenter.h"
+#include "SoftwareRenderer.h"
 #include "Console.h"
+#include "CompletionIndex.h"
+#include "MachineIntrinsics.h"
+#include "InputLog.h"
+#include "FrameCapture.h"
+#include "VirtualFileSystem.h"
+#include <ctime>
+#include <string>
 
-// Window configuration and other constants
-const int windowWidth = 1024;
-const int windowHeight = 768;
+// Window configuration and other constants.  Everything draws into a
+// canvas of the original window size; the window itself can be any size.
+const int windowWidth = ScreenPresenter::kCanvasWidth;
+const int windowHeight = ScreenPresenter::kCanvasHeight;
 const Color bezelColor = { 218, 209, 185, 255 };
 
-Texture2D LoadTextureOrFail(const char* path) {
-	Texture2D tex = LoadTexture(path);
-	if (tex.id == 0) {
-		TraceLog(LOG_ERROR, "Failed to load %s", path);
+ResourceManager::TextureResource* bezelImage = nullptr;
+ResourceManager::TextureResource* stickerImage = nullptr;
+ResourceManager::TextureResource* loadingImage = nullptr;
+
+void drawBezel() {
+	if (bezelImage->IsReady()) DrawTexture(bezelImage->texture, 0, 0, bezelColor);
+	if (stickerImage->IsReady()) {
+		DrawTextureEx(stickerImage->texture,
+					  (Vector2){windowWidth - 56 - 32, windowHeight - 42 - 24},
+					  0,
+					  64.0f / stickerImage->texture.width,
+					  WHITE);
 	}
-	return tex;
 }
 
-void drawBezel() {
-	static bool initialized = false;
-	static Texture2D bezelTexture, stickerTexture;
-	if (!initialized) {
-		bezelTexture = LoadTextureOrFail(GetResourceFile("images/3DBezel.png").c_str());
-		stickerTexture = LoadTextureOrFail(GetResourceFile("images/MiniMicroSticker.png").c_str());
-		initialized = true;
-	}
-	DrawTexture(bezelTexture, 0, 0, bezelColor);
-	DrawTextureEx(stickerTexture,
-				  (Vector2){windowWidth - 56 - 32, windowHeight - 42 - 24},
-				  0,
-				  64.0f / stickerTexture.width,
-				  WHITE);
+void drawLoading() {
+	ClearBackground(bezelColor);
+	if (!loadingImage->IsReady()) return;
+	DrawTexture(loadingImage->texture,
+				(windowWidth - loadingImage->texture.width) / 2,
+				(windowHeight - loadingImage->texture.height) / 2,
+				WHITE);
+}
+
+// Play key click sounds through the mixer, so fast typing can overlap them
+void playKeyClicks(AudioMixer& mixer, const Console& console, int keyDownSample, int keyUpSample) {
+	// Key presses come from the console, which polls the keyboard each frame
+	static std::vector<int> keysDown;
+	int eventCount;
+	const InputEvent* events = console.GetFrameEvents(eventCount);
+	for (int i = 0; i < eventCount; i++) {
+		if (events[i].key == 0) continue;
+		mixer.PlaySample(keyDownSample, 0.5f);
+		keysDown.push_back(events[i].key);
+	}
+	for (size_t i = 0; i < keysDown.size(); ) {
+		if (IsKeyDown(keysDown[i])) {
+			i++;
+			continue;
+		}
+		mixer.PlaySample(keyUpSample, 0.5f);
+		keysDown.erase(keysDown.begin() + i);
+	}
 }
 
-int main() {
+// A file name for a capture taken now, e.g. "MiniMicro-20250101-120000.png"
+std::string captureFileName(const char* extension) {
+	char name[64];
+	time_t now = time(nullptr);
+	strftime(name, sizeof(name), "MiniMicro-%Y%m%d-%H%M%S", localtime(&now));
+	return std::string(name) + extension;
+}
+
+// Render the current machine state with GL and with the software renderer,
+// and report any pixel differences (plus software timings); returns the
+// process exit code
+int compareRenderers(Machine& machine, ScreenPresenter& presenter) {
+	presenter.BeginCanvas();
+	machine.Render();
+	presenter.EndCanvas();
+	Image canvas = LoadImageFromTexture(presenter.GetCanvasTexture());
+	ImageFlipVertical(&canvas);
+	ImageFormat(&canvas, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+	SoftwareRenderer single(1);
+	SoftwareRenderer parallel;
+	for (int i = 0; i < 10; i++) {
+		if (!single.Rasterize(machine) || !parallel.Rasterize(machine)) {
+			UnloadImage(canvas);
+			printf("Software renderer: these layers are not supported\n");
+			return 1;
+		}
+	}
+	int maxDifference = 0;
+	int mismatches = parallel.CountMismatches(canvas, 0, &maxDifference);
+	UnloadImage(canvas);
+
+	printf("Software vs GL: %d mismatched pixels (max channel difference %d)\n", mismatches, maxDifference);
+	printf("Software rasterize: %.2f ms on 1 thread, %.2f ms on %d threads\n",
+		   single.GetLastRasterizeMs(), parallel.GetLastRasterizeMs(), parallel.GetThreadCount());
+	return mismatches == 0 ? 0 : 1;
+}
+
+// FNV-1a over the canvas pixels, to spot rendering differences between runs
+uint64_t hashPixels(const unsigned char* pixels, size_t size) {
+	uint64_t hash = 14695981039346656037ull;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= pixels[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+// Feed a recorded input log back through the console as fast as frames can
+// be rendered, writing "frame,ms,hash" lines to the report (stdout if no
+// path); returns the process exit code
+int replayInput(const char* logPath, const char* reportPath, Machine& machine, Console& console,
+				ScreenPresenter& presenter) {
+	InputLog log;
+	if (!log.Load(logPath)) return 2;
+	FILE* report = reportPath ? fopen(reportPath, "w") : stdout;
+	if (!report) {
+		TraceLog(LOG_WARNING, "Cannot write replay report %s", reportPath);
+		return 2;
+	}
+	fprintf(report, "frame,ms,hash\n");
+
+	std::vector<InputLog::Event> events;
+	std::string keys;
+	float deltaTime;
+	double totalMs = 0, worstMs = 0;
+	long long commands = 0, batches = 0, stateChanges = 0;
+	int worstBatches = 0;
+	uint64_t sessionHash = 14695981039346656037ull;
+	int frame = 0;
+	while (log.ReadFrame(deltaTime, events)) {
+		double start = GetTime();
+		machine.Update(deltaTime);
+		keys.clear();
+		for (const InputLog::Event& event : events) {
+			if (event.type == InputLog::kKey) keys += (char)event.a;
+		}
+		console.TypeInput(keys, start);
+
+		TextureAtlas::Shared().Update();
+		presenter.BeginCanvas();
+		machine.Render();
+		presenter.EndCanvas();
+
+		const RenderQueue& queue = machine.GetRenderQueue();
+		commands += queue.GetCommandCount();
+		batches += queue.GetBatchCount();
+		stateChanges += queue.GetStateChangeCount();
+		if (queue.GetBatchCount() > worstBatches) worstBatches = queue.GetBatchCount();
+
+		// Reading the canvas back waits for the GPU, so the time includes it
+		Image canvas = LoadImageFromTexture(presenter.GetCanvasTexture());
+		double ms = (GetTime() - start) * 1000.0;
+		console.NoteFramePresented(GetTime());
+		uint64_t hash = hashPixels((const unsigned char*)canvas.data, (size_t)canvas.width * canvas.height * 4);
+		UnloadImage(canvas);
+
+		fprintf(report, "%d,%.3f,%016llx\n", frame, ms, (unsigned long long)hash);
+		sessionHash = (sessionHash ^ hash) * 1099511628211ull;
+		totalMs += ms;
+		if (ms > worstMs) worstMs = ms;
+		frame++;
+	}
+	if (report != stdout) fclose(report);
+
+	printf("Replayed %d of %d frames: %.2f ms average, %.2f ms worst, session hash %016llx\n",
+		   frame, log.GetFrameCount(), frame ? totalMs / frame : 0.0, worstMs, (unsigned long long)sessionHash);
+	if (frame) {
+		printf("Render queue per frame: %.1f commands, %.1f batches (%d worst), %.1f state changes\n",
+			   (double)commands / frame, (double)batches / frame, worstBatches, (double)stateChanges / frame);
+	}
+	if (console.GetEchoSampleCount() > 0) {
+		printf("Key-to-glyph latency: %.2f ms average, %.2f ms worst over %d frames\n",
+			   console.GetAverageEchoLatencyMs(), console.GetMaxEchoLatencyMs(), console.GetEchoSampleCount());
+	}
+	return frame == log.GetFrameCount() ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+	// --software-render: draw layers on the CPU (for machines without a usable GPU)
+	// --compare-renderers: check the software renderer against GL, then exit
+	// --record <log>: save all input, frame by frame, when the window closes
+	// --replay <log> [--replay-report <csv>]: replay a log headless and
+	//   uncapped, report per-frame timings and canvas hashes, then exit
+	// --bench <name>: run a benchmark headless, then exit ("list" names them)
+	bool softwareRender = false;
+	bool compareMode = false;
+	const char* recordPath = nullptr;
+	const char* replayPath = nullptr;
+	const char* replayReportPath = nullptr;
+	const char* benchName = nullptr;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--software-render") == 0) softwareRender = true;
+		else if (strcmp(argv[i], "--compare-renderers") == 0) compareMode = true;
+		else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) recordPath = argv[++i];
+		else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) replayPath = argv[++i];
+		else if (strcmp(argv[i], "--replay-report") == 0 && i + 1 < argc) replayReportPath = argv[++i];
+		else if (strcmp(argv[i], "--bench") == 0 && i + 1 < argc) benchName = argv[++i];
+	}
+	bool headless = compareMode || replayPath || benchName;
+
     // Initialize window and other Raylib systems
+	SetConfigFlags(FLAG_WINDOW_RESIZABLE | FLAG_WINDOW_HIGHDPI | (headless ? FLAG_WINDOW_HIDDEN : 0));
     InitWindow(windowWidth, windowHeight, "Mini Micro 2");
-    SetTargetFPS(60);
+    SetTargetFPS(replayPath || benchName ? 0 : 60);
 	InitAudioDevice();
+	if (benchName) {
+		int benchResult = RunBenchmark(benchName);
+		CloseAudioDevice();
+		CloseWindow();
+		return benchResult;
+	}
+
+	AudioMixer mixer;
+	mixer.Start();
+	int keyDownSample = mixer.LoadSample("sounds/key-down.wav");
+	int keyUpSample = mixer.LoadSample("sounds/key-up.wav");
+	int diskInsertedSample = mixer.LoadSample("sounds/disk-inserted.wav");
 
-	Sound bootupSound = LoadSound(GetResourceFile("sounds/startup-chime.wav").c_str());
-	PlaySound(bootupSound);
+	// The user disk, if there is one next to the app, is mounted at /usr;
+	// its changes are written back when idle and when ejected on exit
+	VirtualFileSystem fileSystem;
+	if (FileExists("user.minidisk") && fileSystem.Mount("/usr", "user.minidisk", true)) {
+		mixer.PlaySample(diskInsertedSample, 0.5f);
+	}
+
+	// Start loading resources in the background; only the loading image
+	// is waited for, so it can be shown while everything else streams in
+	ResourceManager& resources = ResourceManager::Shared();
+	loadingImage = resources.AcquireTexture("images/LoadingPleaseWait.png");
+	resources.Finish(loadingImage);
+	bezelImage = resources.AcquireTexture("images/3DBezel.png");
+	stickerImage = resources.AcquireTexture("images/MiniMicroSticker.png");
+	ResourceManager::SoundResource* bootupSound = resources.AcquireSound("sounds/startup-chime.wav");
+	bool bootupPlayed = false;
+	bool startupDone = false;	// the startup resources have loaded (later loads don't show the loading screen)
 
 	// Load the screen font shader
 	ScreenFont::LoadShader(
@@ -50,23 +259,56 @@ int main() {
 		GetResourceFile("shaders/screenfont.fs").c_str()
 	);
 
+	// Load the gradient display shader (default vertex shader)
+	GradientDisplay::LoadShader(nullptr, GetResourceFile("shaders/gradient.fs").c_str());
+
+	// Canvas scaling, bezel, and CRT effects are applied when presenting
+	ScreenPresenter presenter;
+	presenter.LoadShader(GetResourceFile("shaders/present.fs").c_str());
+
+	// F12 saves a screenshot; Ctrl+F12 starts/stops recording a video of
+	// the screen area (bottom-up in the canvas)
+	FrameCapture capture;
+	capture.SetRegion(Display::kScreenLeft, ScreenPresenter::kCanvasHeight - Display::kScreenBottom,
+					  Display::kScreenWidth, Display::kScreenHeight);
+
 	// Create the machine
 	Machine machine;
+	machine.SetSoftwareRendering(softwareRender);
+	int exitCode = 0;
+
+	// Layers not set up below are off; the Machine's default opaque black
+	// ones would hide everything beneath them
+	for (int i = 0; i < Machine::kDisplayCount; i++) machine.SetDisplay(i, nullptr);
 
-	// Set display 1 to a nice blue color for testing
-	SolidColorDisplay* display1 = new SolidColorDisplay();
-	display1->SetColor((Color){33, 33, 99, 255});
-	machine.SetDisplay(1, display1);
+	// Solid blue background in the bottom layer (7), as in Mini Micro
+	SolidColorDisplay* background = new SolidColorDisplay();
+	background->SetColor((Color){33, 33, 99, 255});
+	machine.SetDisplay(7, background);
+
+	// Pixel graphics in layer 5, as in Mini Micro
+	machine.SetDisplay(5, new PixelDisplay());
 	
 	// Create a TextDisplay for layer 0
 	TextDisplay* textDisplay = new TextDisplay();
-	textDisplay->LoadFont(GetResourceFile("images/ScreenFont.png").c_str());
+	textDisplay->LoadFont("images/ScreenFont.png");
 	textDisplay->SetTextColor(GREEN);
 	machine.SetDisplay(0, textDisplay);
 
+	// Autocomplete knows the machine intrinsics by name
+	CompletionIndex completion;
+	int intrinsicCount;
+	const IntrinsicDef* intrinsics = GetMachineIntrinsics(intrinsicCount);
+	for (int i = 0; i < intrinsicCount; i++) completion.Add(intrinsics[i].name);
+
 	// Create console
 	Console console(textDisplay);
+	console.SetCompletionIndex(&completion);
 	console.InitKeyboardMapping();  // Initialize keyboard layout mapping
+	// Command history persists across sessions, except when recording or
+	// replaying input, where up-arrow must recall the same things each run
+	std::string dataFolder = GetDataFolder();
+	if (!recordPath && !replayPath && !dataFolder.empty()) console.OpenHistory((dataFolder + "/history.txt").c_str());
 	console.SetOnInputDone([&](const std::string& input) {
 		textDisplay->Print("You said: ");
 		textDisplay->Print(input);
@@ -80,24 +322,94 @@ int main() {
 	textDisplay->Print("]");
 	console.StartInput();
 
+	// Recording starts once loading is done, which is where replay starts
+	InputLog inputLog;
+	console.SetOnKey([&](char key) { inputLog.RecordKey(key); });
+	if (replayPath) {
+		while (resources.PendingCount() > 0) {
+			resources.Update();
+			WaitTime(0.001);
+		}
+		exitCode = replayInput(replayPath, replayReportPath, machine, console, presenter);
+	}
+
     // Main game loop
-    while (!WindowShouldClose()) {
+    while (!replayPath && !WindowShouldClose()) {
         // Update
 		float deltaTime = GetFrameTime();
-        machine.Update();
+		resources.Update();
+		if (!startupDone && resources.PendingCount() == 0) {
+			TraceLog(LOG_INFO, "Startup resources loaded in %.1f ms; image cache: %d hits, %d misses, saved %.1f ms",
+					 GetTime() * 1000.0, ImageCache::GetHitCount(), ImageCache::GetMissCount(),
+					 ImageCache::GetSecondsSaved() * 1000.0);
+			startupDone = true;
+		}
+		if (recordPath && !inputLog.IsRecording() && startupDone) inputLog.StartRecording();
+		inputLog.BeginFrame(deltaTime);
+		inputLog.CaptureDevices();
+		if (!bootupPlayed && bootupSound->state != ResourceManager::kPending) {
+			if (bootupSound->IsReady()) PlaySound(bootupSound->sound);
+			bootupPlayed = true;
+		}
+        machine.Update(deltaTime);
 		console.Update(deltaTime);
+		playKeyClicks(mixer, console, keyDownSample, keyUpSample);
+		fileSystem.Update(deltaTime);
+		if (IsKeyPressed(KEY_F11)) ToggleBorderlessWindowed();
+		if (IsKeyPressed(KEY_F12)) {
+			if (!IsKeyDown(KEY_LEFT_CONTROL) && !IsKeyDown(KEY_RIGHT_CONTROL)) capture.RequestScreenshot(captureFileName(".png").c_str());
+			else if (capture.IsRecording()) capture.StopRecording();
+			else capture.StartRecording(captureFileName(".qov").c_str(), 60);
+		}
 
         // Draw
+		TextureAtlas::Shared().Update();
+		bool loading = !startupDone;
+		if (compareMode && !loading) {
+			exitCode = compareRenderers(machine, presenter);
+			break;
+		}
+		if (!loading && !presenter.HasOverlay()) {
+			presenter.BeginOverlay();
+			drawBezel();
+			presenter.EndOverlay();
+		}
+		presenter.BeginCanvas();
+		if (loading) drawLoading();
+		else machine.Render();
+		presenter.EndCanvas();
+		capture.CaptureFrame(presenter.GetCanvasFramebuffer());
+
         BeginDrawing();
-		machine.Render();
-		drawBezel();
+		presenter.Present(!loading, bezelColor);
         EndDrawing();
+		console.NoteFramePresented(GetTime());
     }
 
     // Cleanup
-	UnloadSound(bootupSound);
+	capture.Unload();
+	fileSystem.EjectAll();
+	if (console.GetEchoSampleCount() > 0) {
+		TraceLog(LOG_INFO, "Console: key-to-glyph latency %.2f ms average, %.2f ms max over %d frames",
+				 console.GetAverageEchoLatencyMs(), console.GetMaxEchoLatencyMs(), console.GetEchoSampleCount());
+	}
+	if (inputLog.IsRecording() && inputLog.Save(recordPath)) {
+		TraceLog(LOG_INFO, "Recorded %d frames of input to %s", inputLog.GetFrameCount(), recordPath);
+	}
+	resources.Release(bootupSound);
+	resources.Release(bezelImage);
+	resources.Release(stickerImage);
+	resources.Release(loadingImage);
+	for (int i = 0; i < Machine::kDisplayCount; i++) {
+		machine.SetDisplay(i, nullptr);	// releases fonts and textures while the GL context exists
+	}
+	resources.Shutdown();
+	TextureAtlas::Shared().Clear();	// after Shutdown, which removes packed images
 	ScreenFont::UnloadShader();
+	GradientDisplay::UnloadShader();
+	mixer.Stop();
+	CloseAudioDevice();
 	CloseWindow();
 
-    return 0;
+    return exitCode;
 }
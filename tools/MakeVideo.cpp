@@ -0,0 +1,169 @@
+// MakeVideo: builds a QOI-frame video (see VideoStream.h) from a folder of
+// PNG frames, or checks one by decoding it headless.
+//
+// Usage: MakeVideo <framesDir> <output.qov> [fps]
+//        MakeVideo --check <video.qov> [expected.txt]
+//
+// Frames are taken in file name order and must all be the same size.
+// --check prints a hash of every decoded frame and the decode throughput,
+// so a video (or a decoder change) can be verified without a window.  Given
+// an expected-hash file (e.g. the saved output of an earlier --check), it
+// compares every frame against it and exits nonzero on any difference.
+
+#include "raylib.h"
+#include "Qoi.h"
+#include "VideoStream.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <unordered_map>
+
+static void WriteU32(std::vector<unsigned char>& out, uint32_t value) {
+    for (int i = 0; i < 4; i++) out.push_back((unsigned char)(value >> (i * 8)));
+}
+
+// Read "<index> <16 hex digits>" lines, as --check prints them; other
+// lines are skipped
+static bool ReadExpectedHashes(const char* path, std::unordered_map<int, uint64_t>& hashes) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "Could not read %s\n", path);
+        return false;
+    }
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        int index;
+        char hex[32];
+        if (sscanf(line, "%d %31s", &index, hex) != 2 || strlen(hex) != 16) continue;
+        if (strspn(hex, "0123456789abcdefABCDEF") != 16) continue;
+        hashes[index] = strtoull(hex, nullptr, 16);
+    }
+    fclose(f);
+    return true;
+}
+
+static int CheckVideo(const char* path, const char* expectedPath) {
+    std::unordered_map<int, uint64_t> expected;
+    if (expectedPath && !ReadExpectedHashes(expectedPath, expected)) return 1;
+
+    VideoStream stream;
+    if (!stream.Open(path)) return 1;
+    printf("%dx%d, %.3f fps, %d frames\n", stream.GetWidth(), stream.GetHeight(),
+           stream.GetFrameRate(), stream.GetFrameCount());
+
+    auto start = std::chrono::steady_clock::now();
+    int frames = 0, matched = 0, differing = 0, unexpected = 0;
+    while (!stream.IsFinished()) {
+        const VideoStream::Frame* frame = stream.PeekFrame();
+        if (!frame) {
+            std::this_thread::yield();
+            continue;
+        }
+        uint64_t hash = VideoStream::HashFrame(*frame);
+        const char* note = "";
+        if (expectedPath) {
+            auto it = expected.find(frame->index);
+            if (it == expected.end()) {
+                unexpected++;
+                note = "  (not in expected hashes)";
+            } else if (it->second == hash) {
+                matched++;
+            } else {
+                differing++;
+                note = "  MISMATCH";
+            }
+        }
+        printf("%6d  %016llx%s\n", frame->index, (unsigned long long)hash, note);
+        stream.PopFrame();
+        frames++;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("%d frames in %.3f s (%.1f fps); %.3f ms per frame decode\n",
+           frames, seconds, seconds > 0 ? frames / seconds : 0, stream.GetAverageDecodeMs());
+    if (frames != stream.GetFrameCount()) return 1;
+    if (!expectedPath) return 0;
+
+    int missing = (int)expected.size() - matched - differing;
+    printf("%d of %d expected hashes matched; %d differ, %d frames unexpected, %d expected frames not decoded\n",
+           matched, (int)expected.size(), differing, unexpected, missing);
+    return (differing == 0 && unexpected == 0 && missing == 0) ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <framesDir> <output.qov> [fps]\n", argv[0]);
+        fprintf(stderr, "       %s --check <video.qov> [expected.txt]\n", argv[0]);
+        return 1;
+    }
+    SetTraceLogLevel(LOG_WARNING);
+    if (strcmp(argv[1], "--check") == 0) return CheckVideo(argv[2], argc > 3 ? argv[3] : nullptr);
+
+    const char* framesDir = argv[1];
+    const char* outPath = argv[2];
+    int fps = argc > 3 ? atoi(argv[3]) : 30;
+    if (fps <= 0) fps = 30;
+
+    std::vector<std::string> paths;
+    FilePathList files = LoadDirectoryFiles(framesDir);
+    for (unsigned int i = 0; i < files.count; i++) {
+        if (IsFileExtension(files.paths[i], ".png")) paths.push_back(files.paths[i]);
+    }
+    UnloadDirectoryFiles(files);
+    std::sort(paths.begin(), paths.end());
+    if (paths.empty()) {
+        fprintf(stderr, "No PNG frames in %s\n", framesDir);
+        return 1;
+    }
+
+    FILE* f = fopen(outPath, "wb");
+    if (!f) {
+        fprintf(stderr, "Could not write %s\n", outPath);
+        return 1;
+    }
+
+    std::vector<unsigned char> buffer;
+    int width = 0, height = 0;
+    for (size_t i = 0; i < paths.size(); i++) {
+        Image image = LoadImage(paths[i].c_str());
+        if (!image.data) {
+            fprintf(stderr, "Could not read %s\n", paths[i].c_str());
+            fclose(f);
+            return 1;
+        }
+        ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        if (i == 0) {
+            width = image.width;
+            height = image.height;
+            buffer.insert(buffer.end(), { 'Q', 'O', 'I', 'V' });
+            WriteU32(buffer, 1);
+            WriteU32(buffer, (uint32_t)width);
+            WriteU32(buffer, (uint32_t)height);
+            WriteU32(buffer, (uint32_t)fps);
+            WriteU32(buffer, 1);
+            WriteU32(buffer, (uint32_t)paths.size());
+        } else if (image.width != width || image.height != height) {
+            fprintf(stderr, "%s is %dx%d; expected %dx%d\n", paths[i].c_str(), image.width, image.height, width, height);
+            UnloadImage(image);
+            fclose(f);
+            return 1;
+        }
+
+        size_t sizeAt = buffer.size();
+        WriteU32(buffer, 0);
+        Qoi::Encode((const unsigned char*)image.data, width, height, buffer);
+        uint32_t size = (uint32_t)(buffer.size() - sizeAt - 4);
+        for (int b = 0; b < 4; b++) buffer[sizeAt + b] = (unsigned char)(size >> (b * 8));
+        UnloadImage(image);
+
+        fwrite(buffer.data(), 1, buffer.size(), f);
+        buffer.clear();
+    }
+    fclose(f);
+    printf("Wrote %zu frames (%dx%d, %d fps) to %s\n", paths.size(), width, height, fps, outPath);
+    return 0;
+}
@@ -0,0 +1,159 @@
+// PackResources: packs the resources folder into a single indexed archive
+// (resources.pak) that MiniMicro2 memory-maps at startup.
+//
+// Usage: PackResources <resourcesDir> <output.pak> [--decode-images]
+//
+// With --decode-images, PNG files also get a pre-decoded RGBA8 payload,
+// so they can be uploaded to the GPU without decoding at all.
+
+#include "raylib.h"
+#include "ResourceArchive.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+using namespace ResourceArchiveFormat;
+
+struct PackItem {
+    std::string path;           // relative to the resources folder, with '/'
+    std::vector<unsigned char> data;
+    std::vector<unsigned char> pixels;
+    int width;
+    int height;
+    ArchiveEntry entry;
+};
+
+static uint64_t Align(uint64_t offset) {
+    return (offset + kAlignment - 1) & ~(uint64_t)(kAlignment - 1);
+}
+
+static bool ReadFile(const char* path, std::vector<unsigned char>& outData) {
+    int size = 0;
+    unsigned char* data = LoadFileData(path, &size);
+    if (!data) return false;
+    outData.assign(data, data + size);
+    UnloadFileData(data);
+    return true;
+}
+
+static void WritePadding(FILE* f, uint64_t& offset, uint64_t target) {
+    static const unsigned char zeros[kAlignment] = { 0 };
+    while (offset < target) {
+        size_t n = (size_t)std::min<uint64_t>(target - offset, kAlignment);
+        fwrite(zeros, 1, n, f);
+        offset += n;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <resourcesDir> <output.pak> [--decode-images]\n", argv[0]);
+        return 1;
+    }
+    const char* baseDir = argv[1];
+    const char* outPath = argv[2];
+    bool decodeImages = (argc > 3 && strcmp(argv[3], "--decode-images") == 0);
+    SetTraceLogLevel(LOG_WARNING);
+
+    // Gather files
+    std::vector<PackItem> items;
+    size_t baseLen = strlen(baseDir);
+    FilePathList files = LoadDirectoryFilesEx(baseDir, nullptr, true);
+    for (unsigned int i = 0; i < files.count; i++) {
+        const char* fullPath = files.paths[i];
+        const char* fileName = GetFileName(fullPath);
+        if (fileName[0] == '.') continue;   // .gitkeep, .DS_Store, etc.
+
+        PackItem item;
+        item.path = fullPath + baseLen;
+        while (!item.path.empty() && (item.path[0] == '/' || item.path[0] == '\\')) item.path.erase(0, 1);
+        std::replace(item.path.begin(), item.path.end(), '\\', '/');
+        item.width = item.height = 0;
+        if (!ReadFile(fullPath, item.data)) {
+            fprintf(stderr, "Could not read %s\n", fullPath);
+            UnloadDirectoryFiles(files);
+            return 1;
+        }
+
+        if (decodeImages && IsFileExtension(fullPath, ".png")) {
+            Image image = LoadImageFromMemory(".png", item.data.data(), (int)item.data.size());
+            if (image.data) {
+                ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+                const unsigned char* pixels = (const unsigned char*)image.data;
+                item.pixels.assign(pixels, pixels + (size_t)image.width * image.height * 4);
+                item.width = image.width;
+                item.height = image.height;
+                UnloadImage(image);
+            }
+        }
+        items.push_back(item);
+    }
+    UnloadDirectoryFiles(files);
+
+    // Sort by path hash (then path), as the reader's binary search expects
+    for (PackItem& item : items) {
+        memset(&item.entry, 0, sizeof(item.entry));
+        item.entry.pathHash = HashPath(item.path.c_str(), item.path.length());
+    }
+    std::sort(items.begin(), items.end(), [](const PackItem& a, const PackItem& b) {
+        if (a.entry.pathHash != b.entry.pathHash) return a.entry.pathHash < b.entry.pathHash;
+        return a.path < b.path;
+    });
+
+    // Lay out the file: header, entries, path strings, then aligned data
+    uint64_t offset = sizeof(ArchiveHeader) + items.size() * sizeof(ArchiveEntry);
+    for (PackItem& item : items) {
+        item.entry.pathOffset = offset;
+        item.entry.pathLength = (uint32_t)item.path.length();
+        offset += item.path.length();
+    }
+    for (PackItem& item : items) {
+        offset = Align(offset);
+        item.entry.dataOffset = offset;
+        item.entry.dataSize = item.data.size();
+        offset += item.data.size();
+        if (!item.pixels.empty()) {
+            offset = Align(offset);
+            item.entry.pixelsOffset = offset;
+            item.entry.width = (uint32_t)item.width;
+            item.entry.height = (uint32_t)item.height;
+            offset += item.pixels.size();
+        }
+    }
+
+    // Write it out
+    FILE* f = fopen(outPath, "wb");
+    if (!f) {
+        fprintf(stderr, "Could not write %s\n", outPath);
+        return 1;
+    }
+    ArchiveHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.entryCount = (uint32_t)items.size();
+    fwrite(&header, sizeof(header), 1, f);
+    for (const PackItem& item : items) fwrite(&item.entry, sizeof(ArchiveEntry), 1, f);
+
+    offset = sizeof(ArchiveHeader) + items.size() * sizeof(ArchiveEntry);
+    for (const PackItem& item : items) {
+        fwrite(item.path.data(), 1, item.path.length(), f);
+        offset += item.path.length();
+    }
+    for (const PackItem& item : items) {
+        WritePadding(f, offset, item.entry.dataOffset);
+        fwrite(item.data.data(), 1, item.data.size(), f);
+        offset += item.data.size();
+        if (!item.pixels.empty()) {
+            WritePadding(f, offset, item.entry.pixelsOffset);
+            fwrite(item.pixels.data(), 1, item.pixels.size(), f);
+            offset += item.pixels.size();
+        }
+    }
+    fclose(f);
+
+    printf("Packed %d resources into %s (%.1f KB)\n", (int)items.size(), outPath, offset / 1024.0);
+    return 0;
+}